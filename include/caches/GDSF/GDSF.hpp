@@ -0,0 +1,512 @@
+#pragma once
+#include "caches/cache_utils.hpp"
+#include "caches/cache_index.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <mutex>
+#include <type_traits>
+#include <vector>
+
+namespace cache
+{
+	// GreedyDual-Size-Frequency: every entry is worth
+	//     clock + frequency * cost / size
+	// where cost is what a miss on it takes to recompute and size is its share
+	// of the capacity. The entry worth least is evicted and the clock rises to
+	// its value, so entries nobody touches age out however expensive they were.
+	// Entries sit in a binary min-heap that knows each node's position: eviction
+	// is O(log N) and a hit re-sifts just the entry it touched. Equal values are
+	// broken by recency, so with unit costs and sizes it behaves like LFU with aging.
+	template<typename Key, typename Value, class LockT = NullLock,
+			 class Hash = std::hash<Key>, class KeyEqual = std::equal_to<Key>, class Compare = std::less<Key>>
+	class GDSF
+	{
+		static_assert(
+			has_hash<Key, Hash>::value || has_less_comp<Key>::value,
+			"Key must be hashable (unordered_map) or less-comparable (map)"
+		);
+
+	private:
+		struct Node;
+		using indexT = select_index_t<Node, Key, Hash, KeyEqual, Compare>;
+
+		struct Node : indexT::hook
+		{
+			Key key;
+			Value value;
+			double priority = 0;
+			double cost = 0;
+			std::size_t size = 0;
+			std::size_t frequency = 0;
+			std::uint64_t stamp = 0;
+			std::size_t heapPos = 0;
+
+			template<class K, class... Args>
+			Node(K&& key, Args&&... args)
+				: key(std::forward<K>(key)),
+				  value(std::forward<Args>(args)...)
+			{ }
+		};
+
+		// Frees what it holds once the Guard declared after it has unlocked
+		struct Graveyard : std::vector<Node*>
+		{
+			~Graveyard()
+			{
+				for (Node* node : *this)
+					delete node;
+			}
+		};
+
+		static bool before(const Node* a, const Node* b);
+		void heapSet(std::size_t pos, Node* node);
+		void siftUp(std::size_t pos);
+		void siftDown(std::size_t pos);
+		void heapPush(Node* node);
+		void heapRemove(Node* node);
+
+		void place(Node* node);
+		void touch(Node* node);
+		void evictOne(Graveyard& dead);
+		void evictOne(Graveyard& dead, typename indexT::hint_type& hint);
+		void removeNode(Node* node, Graveyard& dead);
+
+		template<class K, class... Args>
+		void insertImpl(miss_cost cost, K&& key, Args&&... args);
+
+		using Guard = std::lock_guard<LockT>;
+	public:
+		// Capacity is in the units of miss_cost::size; with the default size of 1 it counts entries
+		GDSF(std::size_t capacity_);
+		~GDSF();
+
+		// An entry larger than the whole capacity is not cached (a stale copy is dropped)
+		void insert(const Key& key, const Value& value, miss_cost cost = miss_cost());
+		void insert(const Key& key, Value&& value, miss_cost cost = miss_cost());
+		void insert(Key&& key, const Value& value, miss_cost cost = miss_cost());
+		void insert(Key&& key, Value&& value, miss_cost cost = miss_cost());
+		template<class... Args>
+		void emplace(miss_cost cost, const Key& key, Args&&... args);
+		template<class... Args>
+		void emplace(miss_cost cost, Key&& key, Args&&... args);
+
+		// A hit raises the entry's frequency and so its value
+		Value& get(const Key& key);
+		const Value& peek(const Key& key) const;
+
+		bool erase(const Key& key);
+		void clear();
+		void set_capacity(std::size_t newCap);
+
+		bool contains(const Key& key) const;
+		bool empty() const;
+		std::size_t size() const;
+		// Sum of the sizes of the cached entries
+		std::size_t weight() const;
+		std::size_t capacity() const;
+		bool full() const;
+
+		cache_stats stats() const;
+
+		memory_stats memory_usage() const;
+		template<class ValueHeapBytes>
+		memory_stats memory_usage(ValueHeapBytes valueHeapBytes) const;
+
+		Value& operator[](const Key& key);
+		const Value& operator[](const Key& key) const;
+
+	private:
+		GDSF(const GDSF&) = delete;
+		GDSF& operator=(const GDSF&) = delete;
+
+		mutable LockT lock_;
+		indexT cache_;
+		std::vector<Node*> heap_;
+
+		std::size_t capacity_;
+		std::size_t weight_ = 0;
+		double clock_ = 0;
+		std::uint64_t tick_ = 0;
+
+		cache_stats stats_;
+	};
+
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual, class Compare>
+	bool GDSF<Key, Value, LockT, Hash, KeyEqual, Compare>::before(const Node* a, const Node* b)
+	{
+		return a->priority < b->priority || (a->priority == b->priority && a->stamp < b->stamp);
+	}
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual, class Compare>
+	void GDSF<Key, Value, LockT, Hash, KeyEqual, Compare>::heapSet(std::size_t pos, Node* node)
+	{
+		heap_[pos] = node;
+		node->heapPos = pos;
+	}
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual, class Compare>
+	void GDSF<Key, Value, LockT, Hash, KeyEqual, Compare>::siftUp(std::size_t pos)
+	{
+		Node* node = heap_[pos];
+		while (pos > 0)
+		{
+			std::size_t parent = (pos - 1) / 2;
+			if (!before(node, heap_[parent]))
+				break;
+
+			heapSet(pos, heap_[parent]);
+			pos = parent;
+		}
+		heapSet(pos, node);
+	}
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual, class Compare>
+	void GDSF<Key, Value, LockT, Hash, KeyEqual, Compare>::siftDown(std::size_t pos)
+	{
+		Node* node = heap_[pos];
+		for (;;)
+		{
+			std::size_t child = 2 * pos + 1;
+			if (child >= heap_.size())
+				break;
+			if (child + 1 < heap_.size() && before(heap_[child + 1], heap_[child]))
+				++child;
+			if (!before(heap_[child], node))
+				break;
+
+			heapSet(pos, heap_[child]);
+			pos = child;
+		}
+		heapSet(pos, node);
+	}
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual, class Compare>
+	void GDSF<Key, Value, LockT, Hash, KeyEqual, Compare>::heapPush(Node* node)
+	{
+		heap_.push_back(node);
+		siftUp(heap_.size() - 1);
+	}
+
+	// Fills the hole with the last node and lets it settle either way
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual, class Compare>
+	void GDSF<Key, Value, LockT, Hash, KeyEqual, Compare>::heapRemove(Node* node)
+	{
+		std::size_t pos = node->heapPos;
+		Node* last = heap_.back();
+		heap_.pop_back();
+		if (last == node)
+			return;
+
+		heapSet(pos, last);
+		siftUp(pos);
+		siftDown(last->heapPos);
+	}
+
+	// Values the node from its current frequency and puts it in the heap
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual, class Compare>
+	void GDSF<Key, Value, LockT, Hash, KeyEqual, Compare>::place(Node* node)
+	{
+		node->priority = clock_ + node->frequency * node->cost / node->size;
+		node->stamp = ++tick_;
+		heapPush(node);
+		weight_ += node->size;
+	}
+
+	// The value only grows on a hit, so the node can only sink
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual, class Compare>
+	void GDSF<Key, Value, LockT, Hash, KeyEqual, Compare>::touch(Node* node)
+	{
+		++node->frequency;
+		node->priority = clock_ + node->frequency * node->cost / node->size;
+		node->stamp = ++tick_;
+		siftDown(node->heapPos);
+	}
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual, class Compare>
+	void GDSF<Key, Value, LockT, Hash, KeyEqual, Compare>::evictOne(Graveyard& dead)
+	{
+		Node* node = heap_.front();
+		clock_ = node->priority;
+		cache_.erase(node);
+		removeNode(node, dead);
+		++stats_.evictions;
+	}
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual, class Compare>
+	void GDSF<Key, Value, LockT, Hash, KeyEqual, Compare>::evictOne(Graveyard& dead, typename indexT::hint_type& hint)
+	{
+		Node* node = heap_.front();
+		clock_ = node->priority;
+		cache_.erase(node, hint);
+		removeNode(node, dead);
+		++stats_.evictions;
+	}
+
+	// Everything but the index: callers erase with or without a hint
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual, class Compare>
+	void GDSF<Key, Value, LockT, Hash, KeyEqual, Compare>::removeNode(Node* node, Graveyard& dead)
+	{
+		heapRemove(node);
+		weight_ -= node->size;
+		dead.push_back(node);
+	}
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual, class Compare>
+	template<class K, class... Args>
+	void GDSF<Key, Value, LockT, Hash, KeyEqual, Compare>::insertImpl(miss_cost cost, K&& key, Args&&... args)
+	{
+		Graveyard dead;
+		Guard g(lock_);
+
+		std::size_t size = std::max<std::size_t>(1, cost.size);
+		typename indexT::hint_type hint;
+		Node* found = cache_.probe(key, hint);
+
+		if (size > capacity_)
+		{
+			if (found)
+			{
+				cache_.erase(found, hint);
+				removeNode(found, dead);
+			}
+			return;
+		}
+
+		if (found)
+		{
+			// A rewrite counts as a use; the node is out of the heap while room is made
+			assign_value(found->value, std::forward<Args>(args)...);
+			heapRemove(found);
+			weight_ -= found->size;
+			found->cost = cost.cost;
+			found->size = size;
+			++found->frequency;
+
+			while (weight_ + size > capacity_)
+				evictOne(dead);
+			place(found);
+			return;
+		}
+
+		while (weight_ + size > capacity_)
+			evictOne(dead, hint);
+
+		Node* node = new Node(std::forward<K>(key), std::forward<Args>(args)...);
+		node->cost = cost.cost;
+		node->size = size;
+		node->frequency = 1;
+		place(node);
+		cache_.insert(node, hint);
+	}
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual, class Compare>
+	GDSF<Key, Value, LockT, Hash, KeyEqual, Compare>::GDSF(std::size_t capacity)
+		: capacity_(capacity)
+	{ }
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual, class Compare>
+	GDSF<Key, Value, LockT, Hash, KeyEqual, Compare>::~GDSF()
+	{
+		for (Node* node : heap_)
+			delete node;
+	}
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual, class Compare>
+	void GDSF<Key, Value, LockT, Hash, KeyEqual, Compare>::insert(const Key& key, const Value& value, miss_cost cost)
+	{
+		insertImpl(cost, key, value);
+	}
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual, class Compare>
+	void GDSF<Key, Value, LockT, Hash, KeyEqual, Compare>::insert(const Key& key, Value&& value, miss_cost cost)
+	{
+		insertImpl(cost, key, std::move(value));
+	}
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual, class Compare>
+	void GDSF<Key, Value, LockT, Hash, KeyEqual, Compare>::insert(Key&& key, const Value& value, miss_cost cost)
+	{
+		insertImpl(cost, std::move(key), value);
+	}
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual, class Compare>
+	void GDSF<Key, Value, LockT, Hash, KeyEqual, Compare>::insert(Key&& key, Value&& value, miss_cost cost)
+	{
+		insertImpl(cost, std::move(key), std::move(value));
+	}
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual, class Compare>
+	template<class... Args>
+	void GDSF<Key, Value, LockT, Hash, KeyEqual, Compare>::emplace(miss_cost cost, const Key& key, Args&&... args)
+	{
+		insertImpl(cost, key, std::forward<Args>(args)...);
+	}
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual, class Compare>
+	template<class... Args>
+	void GDSF<Key, Value, LockT, Hash, KeyEqual, Compare>::emplace(miss_cost cost, Key&& key, Args&&... args)
+	{
+		insertImpl(cost, std::move(key), std::forward<Args>(args)...);
+	}
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual, class Compare>
+	Value& GDSF<Key, Value, LockT, Hash, KeyEqual, Compare>::get(const Key& key)
+	{
+		Guard g(lock_);
+		Node* node = cache_.find(key);
+		if (node == nullptr)
+		{
+			++stats_.misses;
+			throw KeyNotFound();
+		}
+		++stats_.hits;
+
+		touch(node);
+		return node->value;
+	}
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual, class Compare>
+	const Value& GDSF<Key, Value, LockT, Hash, KeyEqual, Compare>::peek(const Key& key) const
+	{
+		Guard g(lock_);
+		Node* node = cache_.find(key);
+		if (node == nullptr)
+			throw KeyNotFound();
+
+		return node->value;
+	}
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual, class Compare>
+	bool GDSF<Key, Value, LockT, Hash, KeyEqual, Compare>::erase(const Key& key)
+	{
+		Graveyard dead;
+		Guard g(lock_);
+		Node* node = cache_.find(key);
+		if (node == nullptr)
+			return false;
+
+		cache_.erase(node);
+		removeNode(node, dead);
+		return true;
+	}
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual, class Compare>
+	void GDSF<Key, Value, LockT, Hash, KeyEqual, Compare>::clear()
+	{
+		Graveyard dead;
+		Guard g(lock_);
+		dead.swap(heap_);
+		cache_.clear();
+		weight_ = 0;
+		clock_ = 0;
+	}
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual, class Compare>
+	void GDSF<Key, Value, LockT, Hash, KeyEqual, Compare>::set_capacity(std::size_t newCap)
+	{
+		{
+			Guard g(lock_);
+			capacity_ = newCap;
+		}
+
+		// In bounded steps so other threads get the lock in between
+		bool shrinking = true;
+		while (shrinking)
+		{
+			Graveyard dead;
+			Guard g(lock_);
+
+			for (std::size_t i = 0; i < shrink_step && weight_ > capacity_; ++i)
+				evictOne(dead);
+
+			shrinking = weight_ > capacity_;
+		}
+	}
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual, class Compare>
+	bool GDSF<Key, Value, LockT, Hash, KeyEqual, Compare>::contains(const Key& key) const
+	{
+		Guard g(lock_);
+		return cache_.find(key) != nullptr;
+	}
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual, class Compare>
+	bool GDSF<Key, Value, LockT, Hash, KeyEqual, Compare>::empty() const
+	{
+		Guard g(lock_);
+		return cache_.empty();
+	}
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual, class Compare>
+	std::size_t GDSF<Key, Value, LockT, Hash, KeyEqual, Compare>::size() const
+	{
+		Guard g(lock_);
+		return cache_.size();
+	}
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual, class Compare>
+	std::size_t GDSF<Key, Value, LockT, Hash, KeyEqual, Compare>::weight() const
+	{
+		Guard g(lock_);
+		return weight_;
+	}
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual, class Compare>
+	std::size_t GDSF<Key, Value, LockT, Hash, KeyEqual, Compare>::capacity() const
+	{
+		Guard g(lock_);
+		return capacity_;
+	}
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual, class Compare>
+	bool GDSF<Key, Value, LockT, Hash, KeyEqual, Compare>::full() const
+	{
+		Guard g(lock_);
+		return weight_ >= capacity_;
+	}
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual, class Compare>
+	cache_stats GDSF<Key, Value, LockT, Hash, KeyEqual, Compare>::stats() const
+	{
+		Guard g(lock_);
+		return stats_;
+	}
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual, class Compare>
+	memory_stats GDSF<Key, Value, LockT, Hash, KeyEqual, Compare>::memory_usage() const
+	{
+		Guard g(lock_);
+		memory_stats stats;
+		stats.index_bytes = cache_.memory_usage() + heap_.capacity() * sizeof(Node*);
+		stats.node_bytes  = cache_.size() * sizeof(Node);
+		return stats;
+	}
+
+	// Walks every entry under the lock - meant for diagnostics, not hot paths
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual, class Compare>
+	template<class ValueHeapBytes>
+	memory_stats GDSF<Key, Value, LockT, Hash, KeyEqual, Compare>::memory_usage(ValueHeapBytes valueHeapBytes) const
+	{
+		Guard g(lock_);
+		memory_stats stats;
+		stats.index_bytes = cache_.memory_usage() + heap_.capacity() * sizeof(Node*);
+		stats.node_bytes  = cache_.size() * sizeof(Node);
+
+		for (const Node* node : heap_)
+			stats.value_heap_bytes += valueHeapBytes(node->value);
+		return stats;
+	}
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual, class Compare>
+	Value& GDSF<Key, Value, LockT, Hash, KeyEqual, Compare>::operator[](const Key& key)
+	{
+		return get(key);
+	}
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual, class Compare>
+	const Value& GDSF<Key, Value, LockT, Hash, KeyEqual, Compare>::operator[](const Key& key) const
+	{
+		return peek(key);
+	}
+}
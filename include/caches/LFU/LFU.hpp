@@ -1,338 +1,198 @@
 #pragma once
-#include "caches/cache_utils.hpp"
-#include <list>
-#include <unordered_map>
+#include "caches/basic_cache.hpp"
 
 namespace cache
 {
-	template<typename Key, typename Value, class LockT = NullLock>
-	class LFU
+	// Frequency order: each segment is a list of buckets, one per use count,
+	// the least frequent first. The victim is the least recent entry of a
+	// segment's first bucket.
+	struct lfu_policy
 	{
-		static_assert(
-			has_hash<Key>::value || has_less_comp<Key>::value,
-			"Key must be hashable (unordered_map) or less-comparable (map)"
-		);
+		static constexpr bool counts_uses = true;
 
-	private:
-		struct data
+		// All entries sharing one frequency, most recent at the front
+		template<class Node>
+		struct FreqBucket : ListHook
 		{
-			Value value;
 			std::size_t freqS;
-			typename std::list<Key>::iterator iter;
-		};
-		
-		using Guard = std::lock_guard<LockT>;
-		using mapKeyData = std::conditional_t<has_hash<Key>::value,
-								std::unordered_map<Key, data>,
-								std::map<Key, data>>;
-		
-		using mapFreqList = std::conditional_t<has_hash<Key>::value,
-								std::unordered_map<std::size_t, std::list<Key>>,
-								std::map<std::size_t, std::list<Key>>>;
-
-		void updateLevel(typename mapKeyData::iterator mpIter);
-	public:
-		LFU(std::size_t capacity);
-
-		void insert(const Key& key, const Value& value);
-		void insert(const Key& key, Value&& value);
-		template<class... Args>
-		void emplace(const Key& key, Args&& ... args);
-
-		Value& get(const Key& key);
-		const Value& peek(const Key& key) const;
-
-		bool erase(const Key& key);
-		void clear();
-		void set_capacity(std::size_t newCap);
-
-		bool contains(const Key& key) const;
-		bool empty() const;
-		std::size_t size() const;
-		std::size_t capacity() const;
-		bool full() const;
+			IntrusiveList<Node> nodes;
 
-		Value& operator[](const Key& key);
-		const Value& operator[](const Key& key) const;
-
-	private:
-		std::size_t capacity_;
-		std::size_t minFreq;
-		mutable LockT lock_;
-		mapKeyData mp;
-		mapFreqList freq;
-	};
-
-
-	template<typename Key, typename Value, class lock>
-	void LFU<Key, Value, lock>::updateLevel(typename mapKeyData::iterator mpIter)
-	{
-		// Update level
-		std::size_t oldFreq = mpIter->second.freqS;
-		std::list<Key>& oldList = freq[oldFreq];
-
-		++mpIter->second.freqS;
-		std::list<Key>& newList = freq[mpIter->second.freqS];
-
-		newList.splice(newList.begin(), oldList, mpIter->second.iter);
+			explicit FreqBucket(std::size_t freqS)
+				: freqS(freqS)
+			{ }
+		};
 
-		if (oldFreq == minFreq && oldList.empty())
+		template<class Node>
+		struct hook
 		{
-			++minFreq;
-			freq.erase(oldFreq);
-		}
-	}
-
-	template<typename Key, typename Value, class lock>
-	LFU<Key, Value, lock>::LFU(std::size_t capacity)
-		: capacity_(capacity), minFreq(0)
-	{ }
-
-	template<typename Key, typename Value, class lock>
-	void LFU<Key, Value, lock>::insert(const Key& key, const Value& value)
-	{
-		Guard g(lock_);
-		if (capacity_ == 0)
-			return;
+			FreqBucket<Node>* bucket = nullptr;
+		};
 
-		auto mpIter = mp.find(key);
-		if (mpIter != mp.end())
-		{
-			mpIter->second.value = value;
-			updateLevel(mpIter);
-		}
-		else
+		template<class Node>
+		class order
 		{
-			if (capacity_ == mp.size())
-			{
-				// Remove element with min level
-				std::list<Key>& ListW = freq[minFreq];
-				mp.erase(ListW.back());
-				ListW.pop_back();
+			using Bucket = FreqBucket<Node>;
 
-				if (ListW.empty())
-					freq.erase(minFreq);
-			}
+		public:
+			order() = default;
 
-			minFreq = 0;
-			std::list<Key>& ListW = freq[minFreq];
-			ListW.push_front(key);
-			mp[key] = data{value, minFreq, ListW.begin()};
-		}
-	}
-
-	template<typename Key, typename Value, class lock>
-	void LFU<Key, Value, lock>::insert(const Key& key, Value&& value)
-	{
-		Guard g(lock_);
-		if (capacity_ == 0)
-			return;
-
-		auto mpIter = mp.find(key);
-		if (mpIter != mp.end())
-		{
-			mpIter->second.value = std::move(value);
-			updateLevel(mpIter);
-		}
-		else
-		{
-			if (capacity_ == mp.size())
+			~order()
 			{
-				// Remove element with min level
-				auto& ListW = freq[minFreq];
-				mp.erase(ListW.back());
-				ListW.pop_back();
-
-				if (ListW.empty())
-					freq.erase(minFreq);
+				for (IntrusiveList<Bucket>& segment : segments_)
+					segment.clear_and_dispose([](Bucket* bucket) { delete bucket; });
 			}
 
-			minFreq = 0;
-			auto& ListW = freq[minFreq];
-			ListW.push_front(key);
-			mp[key] = data{std::move(value), minFreq, ListW.begin()};
-		}
-	}
-
-	template<typename Key, typename Value, class lock>
-	template<class... Args>
-	void LFU<Key, Value, lock>::emplace(const Key& key, Args&& ... args)
-	{
-		Guard g(lock_);
-		if (capacity_ == 0)
-			return;
-
-		auto mpIter = mp.find(key);
-		if (mpIter != mp.end())
-		{
-			mpIter->second.value = Value(std::forward<Args>(args)...);
-			updateLevel(mpIter);
-		}
-		else
-		{
-			if (capacity_ == mp.size())
+			void push(Node* node, std::size_t segment)
 			{
-				// Remove element with min level
-				std::list<Key>& ListW = freq[minFreq];
-				mp.erase(ListW.back());
-				ListW.pop_back();
+				Bucket* first = segments_[segment].front();
+				if (first == nullptr || first->freqS != 0)
+				{
+					first = new Bucket(0);
+					segments_[segment].push_front(first);
+					++bucketCount_;
+				}
 
-				if (ListW.empty())
-					freq.erase(minFreq);
+				first->nodes.push_front(node);
+				node->bucket = first;
 			}
 
-			minFreq = 0;
-			std::list<Key>& ListW = freq[minFreq];
-			ListW.push_front(key);
-			mp[key] = data{Value(std::forward<Args>(args)...), minFreq, ListW.begin()};
-		}
-	}
-
-	template<typename Key, typename Value, class lock>
-	Value& LFU<Key, Value, lock>::get(const Key& key)
-	{
-		Guard g(lock_);
-		auto mpIter = mp.find(key);
-		if (mpIter == mp.end())
-			throw KeyNotFound();
-
-		updateLevel(mpIter);
-
-		return mpIter->second.value;
-	}
-
-	template<typename Key, typename Value, class lock>
-	const Value& LFU<Key, Value, lock>::peek(const Key& key) const
-	{
-		Guard g(lock_);
-		auto mpIter = mp.find(key);
-		if (mpIter == mp.end())
-			throw KeyNotFound();
-
-		return mpIter->second.value;
-	}
-
-	template<typename Key, typename Value, class lock>
-	bool LFU<Key, Value, lock>::erase(const Key& key)
-	{
-		Guard g(lock_);
-		auto mpIter = mp.find(key);
-		if (mpIter == mp.end())
-			return false;
-
-		std::size_t     oldFreq = mpIter->second.freqS;
-		std::list<Key>& oldList = freq[oldFreq];
+			void touch(Node* node, std::size_t segment)
+			{
+				Bucket* oldBucket = node->bucket;
+				Bucket* newBucket = segments_[segment].next(oldBucket);
 
-		oldList.erase(mpIter->second.iter);
-		mp.erase(mpIter);
+				if (newBucket == nullptr || newBucket->freqS != oldBucket->freqS + 1)
+				{
+					newBucket = new Bucket(oldBucket->freqS + 1);
+					segments_[segment].insert_after(oldBucket, newBucket);
+					++bucketCount_;
+				}
 
-		// update lvl if needed
-		if (oldFreq == minFreq && freq[oldFreq].empty())
-		{
-			freq.erase(oldFreq);
+				remove(node);
+				newBucket->nodes.push_front(node);
+				node->bucket = newBucket;
+			}
 
-			if (!mp.empty())
+			// Takes the node out of its bucket, dropping the bucket once empty
+			void remove(Node* node)
 			{
-				minFreq = freq.begin()->first;
-				for (auto& p : freq)
+				Bucket* bucket = node->bucket;
+				bucket->nodes.unlink(node);
+				if (bucket->nodes.empty())
 				{
-					std::size_t f = p.first;
-					if (f < minFreq) minFreq = f;
+					IntrusiveList<Bucket>::unlink(bucket);
+					delete bucket;
+					--bucketCount_;
 				}
 			}
-		}
 
-		return true;
-	}
+			// Moves the node to the bucket of the same frequency in another segment.
+			// Finding that bucket walks the segment, which is fine for pin/unpin and
+			// class changes but is kept off the get/insert path.
+			void move(Node* node, std::size_t from, std::size_t to)
+			{
+				if (from == to)
+					return;
 
-	template<typename Key, typename Value, class lock>
-	void LFU<Key, Value, lock>::clear()
-	{
-		Guard g(lock_);
-		mp.clear();
-		freq.clear();
-		minFreq = 0;
-	}
+				std::size_t freqS = node->bucket->freqS;
+				remove(node);
 
-	template<typename Key, typename Value, class lock>
-	void LFU<Key, Value, lock>::set_capacity(std::size_t newCap)
-	{
-		Guard g(lock_);
-		capacity_ = newCap;
+				IntrusiveList<Bucket>& segment = segments_[to];
+				Bucket* before = nullptr;
+				Bucket* bucket = segment.front();
+				while (bucket && bucket->freqS < freqS)
+				{
+					before = bucket;
+					bucket = segment.next(bucket);
+				}
 
-		// Remove element if actual capacity less previous
-		while (mp.size() > capacity_)
-		{
-			std::list<Key>& ListW = freq[minFreq];
+				if (bucket == nullptr || bucket->freqS != freqS)
+				{
+					bucket = new Bucket(freqS);
+					if (before)
+						segment.insert_after(before, bucket);
+					else
+						segment.push_front(bucket);
+					++bucketCount_;
+				}
 
-			while (!ListW.empty() && mp.size() > capacity_)
+				bucket->nodes.push_front(node);
+				node->bucket = bucket;
+			}
+
+			Node* victim(std::size_t segment) const
 			{
-				mp.erase(ListW.back());
-				ListW.pop_back();
+				Bucket* bucket = segments_[segment].front();
+				return bucket ? bucket->nodes.back() : nullptr;
 			}
 
-			if (ListW.empty())
+			void take_all(IntrusiveList<Node>& out)
 			{
-				freq.erase(minFreq);
+				for (IntrusiveList<Bucket>& segment : segments_)
+				{
+					segment.clear_and_dispose([&out](Bucket* bucket)
+					{
+						out.splice_back(bucket->nodes);
+						delete bucket;
+					});
+				}
+				bucketCount_ = 0;
+			}
 
-				if (!mp.empty())
+			template<class Fn>
+			void for_each(Fn fn) const
+			{
+				for (const IntrusiveList<Bucket>& segment : segments_)
 				{
-					minFreq = freq.begin()->first;
-					for (auto& p : freq)
+					for (Bucket* bucket = segment.front(); bucket; bucket = segment.next(bucket))
 					{
-						std::size_t f = p.first;
-						if (f < minFreq) minFreq = f;
+						for (Node* node = bucket->nodes.front(); node; node = bucket->nodes.next(node))
+							fn(node);
 					}
 				}
 			}
 
-		}
-	}
-
-	template<typename Key, typename Value, class lock>
-	bool LFU<Key, Value, lock>::contains(const Key &key) const
-	{
-		Guard g(lock_);
-		return mp.find(key) != mp.end();
-	}
+			std::size_t memory_usage() const
+			{
+				return bucketCount_ * sizeof(Bucket);
+			}
 
-	template<typename Key, typename Value, class lock>
-	bool LFU<Key, Value, lock>::empty() const
-	{
-		Guard g(lock_);
-		return mp.empty();
-	}
+			// Merges the segments, most frequent bucket first
+			template<class Key>
+			void top_k(std::size_t k, std::vector<hot_key<Key>>& top) const
+			{
+				Bucket* cursor[cache_segments];
+				for (std::size_t i = 0; i < cache_segments; ++i)
+					cursor[i] = segments_[i].back();
 
-	template<typename Key, typename Value, class lock>
-	std::size_t LFU<Key, Value, lock>::size() const
-	{
-		Guard g(lock_);
-		return mp.size();
-	}
+				while (top.size() < k)
+				{
+					std::size_t best = cache_segments;
+					for (std::size_t i = 0; i < cache_segments; ++i)
+					{
+						if (cursor[i] && (best == cache_segments || cursor[i]->freqS > cursor[best]->freqS))
+							best = i;
+					}
+					if (best == cache_segments)
+						break;
 
-	template<typename Key, typename Value, class lock>
-	std::size_t LFU<Key, Value, lock>::capacity() const
-	{
-		Guard g(lock_);
-		return capacity_;
-	}
+					Bucket* bucket = cursor[best];
+					for (Node* node = bucket->nodes.front(); node && top.size() < k; node = bucket->nodes.next(node))
+						top.push_back(hot_key<Key>{ node->key, bucket->freqS });
+					cursor[best] = segments_[best].prev(bucket);
+				}
+			}
 
-	template<typename Key, typename Value, class lock>
-	bool LFU<Key, Value, lock>::full() const
-	{
-		Guard g(lock_);
-		return capacity_ == mp.size();
-	}
+		private:
+			order(const order&) = delete;
+			order& operator=(const order&) = delete;
 
-	template<typename Key, typename Value, class lock>
-	Value& LFU<Key, Value, lock>::operator[](const Key &key)
-	{
-		return get(key);
-	}
+			IntrusiveList<Bucket> segments_[cache_segments];
+			std::size_t bucketCount_ = 0;
+		};
+	};
 
-	template<typename Key, typename Value, class lock>
-	const Value& LFU<Key, Value, lock>::operator[](const Key &key) const
-	{
-		return peek(key);
-	}
+	template<typename Key, typename Value, class LockT = NullLock,
+			 class Hash = std::hash<Key>, class KeyEqual = std::equal_to<Key>, class Compare = std::less<Key>>
+	using LFU = basic_cache<Key, Value, lfu_policy, auto_index, LockT, Hash, KeyEqual, Compare>;
 }
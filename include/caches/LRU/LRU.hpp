@@ -1,343 +1,76 @@
 #pragma once
-#include "caches/cache_utils.hpp"
-#include <unordered_map>
-#include <map>
-#include <mutex>
-#include <type_traits>
+#include "caches/basic_cache.hpp"
 
 namespace cache
 {
-	template<typename Key, typename Value, class LockT = NullLock>
-	class LRU
+	// Recency order: each segment is a list, the most recently used entry at
+	// the front and the victim at the back. Entries carry no policy state.
+	struct lru_policy
 	{
-		static_assert(
-			has_hash<Key>::value || has_less_comp<Key>::value,
-			"Key must be hashable (unordered_map) or less-comparable (map)"
-		);
+		static constexpr bool counts_uses = false;
 
-	private: // List
-		struct Node
-		{
-			std::pair<Key, Value> val;
-			Node* next;
-			Node* prev;
-
-			Node()
-				: prev(nullptr), next(nullptr)
-			{ }
+		template<class Node>
+		struct hook
+		{ };
 
-			template<class... Args>
-			Node(Key key, Args&&... args)
-				: val(key, Value(std::forward<Args>(args)...)),
-			      prev(nullptr),
-				  next(nullptr)
-			{ }
+		template<class Node>
+		class order
+		{
+		public:
+			void push(Node* node, std::size_t segment)
+			{
+				segments_[segment].push_front(node);
+			}
+
+			void touch(Node* node, std::size_t segment)
+			{
+				segments_[segment].move_to_front(node);
+			}
+
+			void remove(Node* node)
+			{
+				IntrusiveList<Node>::unlink(node);
+			}
+
+			// The entry becomes the most recent of its new segment
+			void move(Node* node, std::size_t, std::size_t to)
+			{
+				IntrusiveList<Node>::unlink(node);
+				segments_[to].push_front(node);
+			}
+
+			Node* victim(std::size_t segment) const
+			{
+				return segments_[segment].back();
+			}
+
+			void take_all(IntrusiveList<Node>& out)
+			{
+				for (IntrusiveList<Node>& segment : segments_)
+					out.splice_back(segment);
+			}
+
+			template<class Fn>
+			void for_each(Fn fn) const
+			{
+				for (const IntrusiveList<Node>& segment : segments_)
+				{
+					for (Node* node = segment.front(); node; node = segment.next(node))
+						fn(node);
+				}
+			}
+
+			std::size_t memory_usage() const
+			{
+				return 0;
+			}
+
+		private:
+			IntrusiveList<Node> segments_[cache_segments];
 		};
-
-		void moveNodeToFront(Node *temp);
-		void insertNode(Node* newNode);
-		void deleteNode(Node* nodeToRemove);
-
-		void eraseFullNode(Node* temp);
-
-		using Guard = std::lock_guard<LockT>;
-		using mapT  = std::conditional_t<has_hash<Key>::value,
-						std::unordered_map<Key, Node*>,
-						std::map<Key, Node*>>;
-	public:
-		LRU(std::size_t capacity_);
-		~LRU();
-
-		void insert(const Key& key, const Value& value);
-		void insert(const Key& key, Value&& value);
-		template<class... Args>
-		void emplace(const Key& key, Args&&... args);
-
-		Value& get(const Key& key);
-		const Value& peek(const Key& key) const;
-
-		bool erase(const Key& key);
-		void clear();
-		void set_capacity(std::size_t newCap);
-
-		bool contains(const Key& key) const;
-		bool empty() const;
-		std::size_t size() const;
-		std::size_t capacity() const;
-		bool full() const;
-
-		Value& operator[](const Key& key);
-		const Value& operator[](const Key& key) const;
-
-	private:
-		LRU(const LRU&) = delete;
-		LRU& operator=(const LRU&) = delete;
-
-		mutable LockT lock_;
-		mapT cache_;
-		Node* begin = new Node();
-		Node* end   = new Node();
-		std::size_t capacity_;
 	};
 
-
-	template<typename Key, typename Value, class lock>
-	void LRU<Key, Value, lock>::moveNodeToFront(Node *temp)
-	{
-		if (temp->prev == begin)
-			return;
-
-		Node* nextNode = temp->next;
-		Node* prevNode = temp->prev;
-
-		prevNode->next = nextNode;
-		nextNode->prev = prevNode;
-
-		temp->next  = begin->next;
-		begin->next->prev = temp;
-		temp->prev  = begin;
-		begin->next = temp;
-	}
-
-	template<typename Key, typename Value, class lock>
-	void LRU<Key, Value, lock>::insertNode(Node *newNode)
-	{
-		newNode->prev = begin;
-		newNode->next = begin->next;
-
-		begin->next->prev = newNode;
-		begin->next		  = newNode;
-	}
-
-	template<typename Key, typename Value, class lock>
-	void LRU<Key, Value, lock>::deleteNode(Node* nodeToRemove)
-	{
-		nodeToRemove->prev->next = nodeToRemove->next;
-		nodeToRemove->next->prev = nodeToRemove->prev;
-
-		delete(nodeToRemove);
-	}
-
-	template<typename Key, typename Value, class LockT>
-	void LRU<Key, Value, LockT>::eraseFullNode(Node *temp)
-	{
-		cache_.erase(temp->val.first);
-		deleteNode(temp);
-	}
-
-	template<typename Key, typename Value, class lock>
-	LRU<Key, Value, lock>::LRU(std::size_t capacity_)
-		: capacity_(capacity_)
-	{
-		begin->next = end;
-		end->prev   = begin;
-	}
-
-	template<typename Key, typename Value, class lock>
-	LRU<Key, Value, lock>::~LRU()
-	{
-		Node* cur = begin;
-
-		while (cur)
-		{
-			Node* temp = cur;
-			cur = cur->next;
-			delete temp;
-		}
-	}
-
-	template<typename Key, typename Value, class lock>
-	void LRU<Key, Value, lock>::insert(const Key& key, const Value& value)
-	{
-		Guard g(lock_);
-		if (capacity_ == 0)
-			return;
-
-		auto iter = cache_.find(key);
-
-		if (iter != cache_.end())
-		{
-			moveNodeToFront(iter->second);
-			iter->second->val.second = value;
-		}
-		else
-		{
-			if (cache_.size() == capacity_)
-				eraseFullNode(end->prev);
-
-			Node* node = new Node(key, value);
-			insertNode(node);
-			cache_[key] = node;
-		}
-	}
-
-	template<typename Key, typename Value, class lock>
-	void LRU<Key, Value, lock>::insert(const Key& key, Value&& value)
-	{
-		Guard g(lock_);
-		if (capacity_ == 0)
-			return;
-
-		auto iter = cache_.find(key);
-
-		if (iter != cache_.end())
-		{
-			moveNodeToFront(iter->second);
-			iter->second->val.second = std::move(value);
-		}
-		else
-		{
-			if (cache_.size() == capacity_)
-				eraseFullNode(end->prev);
-
-			Node* node = new Node(key, std::move(value));
-			insertNode(node);
-			cache_[key] = node;
-		}
-	}
-
-	template<typename Key, typename Value, class lock>
-	template<class... Args>
-	void LRU<Key, Value, lock>::emplace(const Key &key, Args&&... args)
-	{
-		Guard g(lock_);
-		if (capacity_ == 0)
-			return;
-
-		auto iter = cache_.find(key);
-
-		if (iter != cache_.end())
-		{
-			moveNodeToFront(iter->second);
-			iter->second->val.second = Value(std::forward<Args>(args)...);
-		}
-		else
-		{
-			if (cache_.size() == capacity_)
-				eraseFullNode(end->prev);
-
-			Node* node = new Node(key, std::forward<Args>(args)...);
-			insertNode(node);
-			cache_[key] = node;
-		}
-	}
-
-	template<typename Key, typename Value, class lock>
-	Value& LRU<Key, Value, lock>::get(const Key &key)
-	{
-		Guard g(lock_);
-
-		auto findIter = cache_.find(key);
-		if (findIter == cache_.end())
-			throw KeyNotFound();
-
-		Node* nodeTmp = findIter->second;
-
-		moveNodeToFront(nodeTmp);
-		return nodeTmp->val.second;
-	}
-
-	template<typename Key, typename Value, class lock>
-	const Value& LRU<Key, Value, lock>::peek(const Key& key) const
-	{
-		Guard g(lock_);
-		auto findIter = cache_.find(key);
-		if (findIter == cache_.end())
-			throw KeyNotFound();
-
-		Node* nodeTmp = findIter->second;
-
-		return nodeTmp->val.second;
-	}
-
-	template<typename Key, typename Value, class lock>
-	bool LRU<Key, Value, lock>::erase(const Key &key)
-	{
-		Guard g(lock_);
-		auto findIter = cache_.find(key);
-		if (findIter == cache_.end())
-			return false;
-
-		eraseFullNode(findIter->second);
-		return true;
-	}
-
-	template<typename Key, typename Value, class lock>
-	void LRU<Key, Value, lock>::clear()
-	{
-		Guard g(lock_);
-		Node* cur = begin->next;
-
-		while (cur != end)
-		{
-			Node* temp = cur;
-			cur = cur->next;
-			delete temp;
-		}
-		begin->next = end;
-		end->prev = begin;
-
-		cache_.clear();
-	}
-
-	template<typename Key, typename Value, class lock>
-	void LRU<Key, Value, lock>::set_capacity(std::size_t newCap)
-	{
-		Guard g(lock_);
-		capacity_ = newCap;
-
-		while (cache_.size() > capacity_)
-		{
-			Node* node = end->prev;
-			cache_.erase(node->val.first);
-			deleteNode(node);
-		}
-	}
-
-	template<typename Key, typename Value, class lock>
-	bool LRU<Key, Value, lock>::contains(const Key &key) const
-	{
-		Guard g(lock_);
-		return cache_.find(key) != cache_.end();
-	}
-
-	template<typename Key, typename Value, class lock>
-	bool LRU<Key, Value, lock>::empty() const
-	{
-		Guard g(lock_);
-		return cache_.empty();
-	}
-
-	template<typename Key, typename Value, class lock>
-	std::size_t LRU<Key, Value, lock>::size() const
-	{
-		Guard g(lock_);
-		return cache_.size();
-	}
-
-	template<typename Key, typename Value, class lock>
-	std::size_t LRU<Key, Value, lock>::capacity() const
-	{
-		Guard g(lock_);
-		return capacity_;
-	}
-
-	template<typename Key, typename Value, class lock>
-	bool LRU<Key, Value, lock>::full() const
-	{
-		Guard g(lock_);
-		return cache_.size() == capacity_;
-	}
-
-	template<typename Key, typename Value, class lock>
-	Value& LRU<Key, Value, lock>::operator[](const Key& key)
-	{
-		return get(key);
-	}
-
-	template<typename Key, typename Value, class lock>
-	const Value & LRU<Key, Value, lock>::operator[](const Key& key) const
-	{
-		return peek(key);
-	}
+	template<typename Key, typename Value, class LockT = NullLock,
+			 class Hash = std::hash<Key>, class KeyEqual = std::equal_to<Key>, class Compare = std::less<Key>>
+	using LRU = basic_cache<Key, Value, lru_policy, auto_index, LockT, Hash, KeyEqual, Compare>;
 }
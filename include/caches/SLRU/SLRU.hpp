@@ -0,0 +1,434 @@
+#pragma once
+#include "caches/cache_utils.hpp"
+#include "caches/cache_index.hpp"
+#include "caches/intrusive_list.hpp"
+#include <algorithm>
+#include <mutex>
+#include <type_traits>
+
+namespace cache
+{
+	// Segmented LRU: a new entry starts in the probationary segment and only a
+	// second use moves it to the protected one. Eviction takes the oldest
+	// probationary entry first, so a one-off scan churns through probation and
+	// leaves the protected entries alone. When the protected segment outgrows
+	// its share, its oldest entry drops back to the front of probation.
+	// Both segments are the same intrusive lists as LRU; every step is O(1).
+	template<typename Key, typename Value, class LockT = NullLock,
+			 class Hash = std::hash<Key>, class KeyEqual = std::equal_to<Key>, class Compare = std::less<Key>>
+	class SLRU
+	{
+		static_assert(
+			has_hash<Key, Hash>::value || has_less_comp<Key>::value,
+			"Key must be hashable (unordered_map) or less-comparable (map)"
+		);
+
+	private:
+		struct Node;
+		using indexT = select_index_t<Node, Key, Hash, KeyEqual, Compare>;
+
+		struct Node : ListHook, indexT::hook
+		{
+			Key key;
+			Value value;
+			bool hot = false;  // in the protected segment
+
+			template<class K, class... Args>
+			Node(K&& key, Args&&... args)
+				: key(std::forward<K>(key)),
+				  value(std::forward<Args>(args)...)
+			{ }
+		};
+
+		// Frees what it holds once the Guard declared after it has unlocked
+		struct Graveyard : IntrusiveList<Node>
+		{
+			~Graveyard()
+			{
+				this->clear_and_dispose([](Node* node) { delete node; });
+			}
+		};
+
+		static std::size_t protectedShare(std::size_t capacity, double share);
+
+		Node* victim() const;
+		void touch(Node* node);
+		void demoteOverflow();
+		void unlinkNode(Node* node, Graveyard& dead);
+		void evictOne(Graveyard& dead);
+		void evictOne(Graveyard& dead, typename indexT::hint_type& hint);
+
+		template<class K, class... Args>
+		void insertImpl(K&& key, Args&&... args);
+
+		using Guard = std::lock_guard<LockT>;
+	public:
+		// protected_share of the capacity is kept for entries used at least twice
+		SLRU(std::size_t capacity_, double protected_share = 0.8);
+		~SLRU();
+
+		void insert(const Key& key, const Value& value);
+		void insert(const Key& key, Value&& value);
+		void insert(Key&& key, const Value& value);
+		void insert(Key&& key, Value&& value);
+		template<class... Args>
+		void emplace(const Key& key, Args&&... args);
+		template<class... Args>
+		void emplace(Key&& key, Args&&... args);
+
+		// A hit on a probationary entry promotes it
+		Value& get(const Key& key);
+		const Value& peek(const Key& key) const;
+
+		bool erase(const Key& key);
+		void clear();
+		// Keeps the protected share; the segments are trimmed to fit
+		void set_capacity(std::size_t newCap);
+
+		bool contains(const Key& key) const;
+		bool empty() const;
+		std::size_t size() const;
+		// Entries currently in the protected segment
+		std::size_t protected_size() const;
+		std::size_t capacity() const;
+		bool full() const;
+
+		cache_stats stats() const;
+
+		memory_stats memory_usage() const;
+		template<class ValueHeapBytes>
+		memory_stats memory_usage(ValueHeapBytes valueHeapBytes) const;
+
+		Value& operator[](const Key& key);
+		const Value& operator[](const Key& key) const;
+
+	private:
+		SLRU(const SLRU&) = delete;
+		SLRU& operator=(const SLRU&) = delete;
+
+		mutable LockT lock_;
+		indexT cache_;
+		IntrusiveList<Node> probation_;
+		IntrusiveList<Node> protected_;
+
+		std::size_t capacity_;
+		double share_;
+		std::size_t protectedCap_;
+		std::size_t protectedCount_ = 0;
+
+		cache_stats stats_;
+	};
+
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual, class Compare>
+	std::size_t SLRU<Key, Value, LockT, Hash, KeyEqual, Compare>::protectedShare(std::size_t capacity, double share)
+	{
+		share = std::min(1.0, std::max(0.0, share));
+		return static_cast<std::size_t>(capacity * share);
+	}
+
+	// Probation is drained first; protected entries go only once it is empty
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual, class Compare>
+	typename SLRU<Key, Value, LockT, Hash, KeyEqual, Compare>::Node* SLRU<Key, Value, LockT, Hash, KeyEqual, Compare>::victim() const
+	{
+		return probation_.empty() ? protected_.back() : probation_.back();
+	}
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual, class Compare>
+	void SLRU<Key, Value, LockT, Hash, KeyEqual, Compare>::touch(Node* node)
+	{
+		if (node->hot)
+		{
+			protected_.move_to_front(node);
+			return;
+		}
+
+		probation_.unlink(node);
+		protected_.push_front(node);
+		node->hot = true;
+		++protectedCount_;
+		demoteOverflow();
+	}
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual, class Compare>
+	void SLRU<Key, Value, LockT, Hash, KeyEqual, Compare>::demoteOverflow()
+	{
+		while (protectedCount_ > protectedCap_)
+		{
+			Node* node = protected_.back();
+			protected_.unlink(node);
+			probation_.push_front(node);
+			node->hot = false;
+			--protectedCount_;
+		}
+	}
+
+	// Everything but the index: callers erase with or without a hint
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual, class Compare>
+	void SLRU<Key, Value, LockT, Hash, KeyEqual, Compare>::unlinkNode(Node* node, Graveyard& dead)
+	{
+		IntrusiveList<Node>::unlink(node);
+		if (node->hot)
+			--protectedCount_;
+		dead.push_front(node);
+	}
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual, class Compare>
+	void SLRU<Key, Value, LockT, Hash, KeyEqual, Compare>::evictOne(Graveyard& dead)
+	{
+		Node* node = victim();
+		cache_.erase(node);
+		unlinkNode(node, dead);
+		++stats_.evictions;
+	}
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual, class Compare>
+	void SLRU<Key, Value, LockT, Hash, KeyEqual, Compare>::evictOne(Graveyard& dead, typename indexT::hint_type& hint)
+	{
+		Node* node = victim();
+		cache_.erase(node, hint);
+		unlinkNode(node, dead);
+		++stats_.evictions;
+	}
+
+	// Rewriting an entry counts as a use, as in LRU
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual, class Compare>
+	template<class K, class... Args>
+	void SLRU<Key, Value, LockT, Hash, KeyEqual, Compare>::insertImpl(K&& key, Args&&... args)
+	{
+		Graveyard dead;
+		Guard g(lock_);
+		if (capacity_ == 0)
+			return;
+
+		typename indexT::hint_type hint;
+		Node* found = cache_.probe(key, hint);
+		if (found)
+		{
+			assign_value(found->value, std::forward<Args>(args)...);
+			touch(found);
+			return;
+		}
+
+		// >= rather than ==: a concurrent set_capacity may still be shrinking
+		if (cache_.size() >= capacity_)
+			evictOne(dead, hint);
+
+		Node* node = new Node(std::forward<K>(key), std::forward<Args>(args)...);
+		probation_.push_front(node);
+		cache_.insert(node, hint);
+	}
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual, class Compare>
+	SLRU<Key, Value, LockT, Hash, KeyEqual, Compare>::SLRU(std::size_t capacity, double protected_share)
+		: capacity_(capacity), share_(protected_share), protectedCap_(protectedShare(capacity, protected_share))
+	{ }
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual, class Compare>
+	SLRU<Key, Value, LockT, Hash, KeyEqual, Compare>::~SLRU()
+	{
+		probation_.clear_and_dispose([](Node* node) { delete node; });
+		protected_.clear_and_dispose([](Node* node) { delete node; });
+	}
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual, class Compare>
+	void SLRU<Key, Value, LockT, Hash, KeyEqual, Compare>::insert(const Key& key, const Value& value)
+	{
+		insertImpl(key, value);
+	}
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual, class Compare>
+	void SLRU<Key, Value, LockT, Hash, KeyEqual, Compare>::insert(const Key& key, Value&& value)
+	{
+		insertImpl(key, std::move(value));
+	}
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual, class Compare>
+	void SLRU<Key, Value, LockT, Hash, KeyEqual, Compare>::insert(Key&& key, const Value& value)
+	{
+		insertImpl(std::move(key), value);
+	}
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual, class Compare>
+	void SLRU<Key, Value, LockT, Hash, KeyEqual, Compare>::insert(Key&& key, Value&& value)
+	{
+		insertImpl(std::move(key), std::move(value));
+	}
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual, class Compare>
+	template<class... Args>
+	void SLRU<Key, Value, LockT, Hash, KeyEqual, Compare>::emplace(const Key& key, Args&&... args)
+	{
+		insertImpl(key, std::forward<Args>(args)...);
+	}
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual, class Compare>
+	template<class... Args>
+	void SLRU<Key, Value, LockT, Hash, KeyEqual, Compare>::emplace(Key&& key, Args&&... args)
+	{
+		insertImpl(std::move(key), std::forward<Args>(args)...);
+	}
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual, class Compare>
+	Value& SLRU<Key, Value, LockT, Hash, KeyEqual, Compare>::get(const Key& key)
+	{
+		Guard g(lock_);
+		Node* node = cache_.find(key);
+		if (node == nullptr)
+		{
+			++stats_.misses;
+			throw KeyNotFound();
+		}
+		++stats_.hits;
+
+		touch(node);
+		return node->value;
+	}
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual, class Compare>
+	const Value& SLRU<Key, Value, LockT, Hash, KeyEqual, Compare>::peek(const Key& key) const
+	{
+		Guard g(lock_);
+		Node* node = cache_.find(key);
+		if (node == nullptr)
+			throw KeyNotFound();
+
+		return node->value;
+	}
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual, class Compare>
+	bool SLRU<Key, Value, LockT, Hash, KeyEqual, Compare>::erase(const Key& key)
+	{
+		Graveyard dead;
+		Guard g(lock_);
+		Node* node = cache_.find(key);
+		if (node == nullptr)
+			return false;
+
+		cache_.erase(node);
+		unlinkNode(node, dead);
+		return true;
+	}
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual, class Compare>
+	void SLRU<Key, Value, LockT, Hash, KeyEqual, Compare>::clear()
+	{
+		Graveyard dead;
+		Guard g(lock_);
+		dead.splice_back(probation_);
+		dead.splice_back(protected_);
+		cache_.clear();
+		protectedCount_ = 0;
+	}
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual, class Compare>
+	void SLRU<Key, Value, LockT, Hash, KeyEqual, Compare>::set_capacity(std::size_t newCap)
+	{
+		{
+			Guard g(lock_);
+			capacity_ = newCap;
+			protectedCap_ = protectedShare(newCap, share_);
+			demoteOverflow();
+		}
+
+		// In bounded steps so other threads get the lock in between
+		bool shrinking = true;
+		while (shrinking)
+		{
+			Graveyard dead;
+			Guard g(lock_);
+
+			for (std::size_t i = 0; i < shrink_step && cache_.size() > capacity_; ++i)
+				evictOne(dead);
+
+			shrinking = cache_.size() > capacity_;
+		}
+	}
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual, class Compare>
+	bool SLRU<Key, Value, LockT, Hash, KeyEqual, Compare>::contains(const Key& key) const
+	{
+		Guard g(lock_);
+		return cache_.find(key) != nullptr;
+	}
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual, class Compare>
+	bool SLRU<Key, Value, LockT, Hash, KeyEqual, Compare>::empty() const
+	{
+		Guard g(lock_);
+		return cache_.empty();
+	}
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual, class Compare>
+	std::size_t SLRU<Key, Value, LockT, Hash, KeyEqual, Compare>::size() const
+	{
+		Guard g(lock_);
+		return cache_.size();
+	}
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual, class Compare>
+	std::size_t SLRU<Key, Value, LockT, Hash, KeyEqual, Compare>::protected_size() const
+	{
+		Guard g(lock_);
+		return protectedCount_;
+	}
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual, class Compare>
+	std::size_t SLRU<Key, Value, LockT, Hash, KeyEqual, Compare>::capacity() const
+	{
+		Guard g(lock_);
+		return capacity_;
+	}
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual, class Compare>
+	bool SLRU<Key, Value, LockT, Hash, KeyEqual, Compare>::full() const
+	{
+		Guard g(lock_);
+		return cache_.size() >= capacity_;
+	}
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual, class Compare>
+	cache_stats SLRU<Key, Value, LockT, Hash, KeyEqual, Compare>::stats() const
+	{
+		Guard g(lock_);
+		return stats_;
+	}
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual, class Compare>
+	memory_stats SLRU<Key, Value, LockT, Hash, KeyEqual, Compare>::memory_usage() const
+	{
+		Guard g(lock_);
+		memory_stats stats;
+		stats.index_bytes = cache_.memory_usage();
+		stats.node_bytes  = cache_.size() * sizeof(Node);
+		return stats;
+	}
+
+	// Walks every entry under the lock - meant for diagnostics, not hot paths
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual, class Compare>
+	template<class ValueHeapBytes>
+	memory_stats SLRU<Key, Value, LockT, Hash, KeyEqual, Compare>::memory_usage(ValueHeapBytes valueHeapBytes) const
+	{
+		Guard g(lock_);
+		memory_stats stats;
+		stats.index_bytes = cache_.memory_usage();
+		stats.node_bytes  = cache_.size() * sizeof(Node);
+
+		for (const IntrusiveList<Node>* segment : { &probation_, &protected_ })
+			for (const Node* node = segment->front(); node; node = segment->next(node))
+				stats.value_heap_bytes += valueHeapBytes(node->value);
+		return stats;
+	}
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual, class Compare>
+	Value& SLRU<Key, Value, LockT, Hash, KeyEqual, Compare>::operator[](const Key& key)
+	{
+		return get(key);
+	}
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual, class Compare>
+	const Value& SLRU<Key, Value, LockT, Hash, KeyEqual, Compare>::operator[](const Key& key) const
+	{
+		return peek(key);
+	}
+}
@@ -0,0 +1,789 @@
+#pragma once
+#include "caches/cache_utils.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <mutex>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace cache
+{
+	// Approximated LRU in the style of Redis: entries live in one dense array
+	// with a 32-bit access stamp each, and a hit only rewrites that stamp.
+	// Eviction samples a few random slots and drops the oldest of them,
+	// keeping a small pool of old candidates between evictions so the choice
+	// gets closer to exact LRU than a single sample would.
+	// Slots are moved when entries are removed, so references returned by
+	// get() or peek() are only valid until the next mutating call.
+	template<typename Key, typename Value, class LockT = NullLock,
+			 class Hash = std::hash<Key>, class KeyEqual = std::equal_to<Key>>
+	class SampledLRU
+	{
+		static_assert(has_hash<Key, Hash>::value, "SampledLRU needs a hashable Key");
+
+	private:
+		using slot_index = std::uint32_t;
+		static constexpr slot_index npos = std::numeric_limits<slot_index>::max();
+		static constexpr std::size_t poolSize = 16;
+
+		struct Slot
+		{
+			Key key;
+			Value value;
+			std::uint32_t stamp;
+			slot_index hnext;
+
+			template<class K, class... Args>
+			Slot(K&& key, Args&&... args)
+				: key(std::forward<K>(key)),
+				  value(std::forward<Args>(args)...),
+				  stamp(0),
+				  hnext(npos)
+			{ }
+		};
+
+		struct Candidate
+		{
+			slot_index slot;
+			std::uint32_t stamp;
+		};
+
+		// Removed slots are moved here under the lock and destroyed once the Guard is gone
+		using Graveyard = std::vector<Slot>;
+
+		template<class K>
+		slot_index findSlot(const K& key, std::size_t hash) const;
+		void linkSlot(slot_index slot, std::size_t hash);
+		void unlinkSlot(slot_index slot);
+		void removeSlot(slot_index slot);
+		void grow();
+		std::size_t bucket(std::size_t hash) const;
+
+		std::uint64_t nextRandom();
+		std::uint32_t age(std::uint32_t stamp) const;
+		void samplePool();
+		void evictOne();
+		void touch(Slot& slot);
+
+		void takeRetired(Graveyard& dead, std::size_t maxSlots);
+		void collectRetired(Graveyard& dead);
+
+		template<class K, class... Args>
+		bool insertProbed(K&& key, std::size_t hash, Args&&... args);
+		template<class K, class... Args>
+		bool tryEmplace(K&& key, std::size_t hash, Args&&... args);
+
+		template<class K>
+		using enable_lookup_t = std::enable_if_t<is_transparent<Hash>::value && is_transparent<KeyEqual>::value, K>;
+		template<class K>
+		using enable_hashed_t = std::enable_if_t<std::is_same<K, Key>::value
+								|| (is_transparent<Hash>::value && is_transparent<KeyEqual>::value), K>;
+
+		using Guard = std::lock_guard<LockT>;
+	public:
+		// `samples` random slots are looked at per eviction; more is closer to exact LRU
+		SampledLRU(std::size_t capacity_, std::size_t samples = 5);
+		~SampledLRU();
+
+		void insert(const Key& key, const Value& value);
+		void insert(const Key& key, Value&& value);
+		void insert(Key&& key, const Value& value);
+		void insert(Key&& key, Value&& value);
+		void insert(const Key& key, std::size_t hash, const Value& value);
+		void insert(const Key& key, std::size_t hash, Value&& value);
+		template<class... Args>
+		void emplace(const Key& key, Args&&... args);
+		template<class... Args>
+		void emplace(Key&& key, Args&&... args);
+
+		template<class... Args>
+		bool try_emplace(const Key& key, Args&&... args);
+		template<class... Args>
+		bool try_emplace(Key&& key, Args&&... args);
+
+		template<class V>
+		bool insert_or_assign(const Key& key, V&& value);
+		template<class V>
+		bool insert_or_assign(Key&& key, V&& value);
+
+		Value& get(const Key& key);
+		template<class K, class = enable_lookup_t<K>>
+		Value& get(const K& key);
+		template<class K, class = enable_hashed_t<K>>
+		Value& get(const K& key, std::size_t hash);
+
+		const Value& peek(const Key& key) const;
+		template<class K, class = enable_lookup_t<K>>
+		const Value& peek(const K& key) const;
+		template<class K, class = enable_hashed_t<K>>
+		const Value& peek(const K& key, std::size_t hash) const;
+
+		bool erase(const Key& key);
+		template<class K, class = enable_lookup_t<K>>
+		bool erase(const K& key);
+		template<class K, class = enable_hashed_t<K>>
+		bool erase(const K& key, std::size_t hash);
+
+		void clear();
+		void set_capacity(std::size_t newCap);
+
+		void set_reclaim_mode(reclaim_mode mode);
+		std::size_t reclaim(std::size_t maxSlots = std::numeric_limits<std::size_t>::max());
+		std::size_t pending_reclaim() const;
+
+		bool contains(const Key& key) const;
+		template<class K, class = enable_lookup_t<K>>
+		bool contains(const K& key) const;
+		template<class K, class = enable_hashed_t<K>>
+		bool contains(const K& key, std::size_t hash) const;
+
+		bool empty() const;
+		std::size_t size() const;
+		std::size_t capacity() const;
+		bool full() const;
+
+		Hash hash_function() const;
+		cache_stats stats() const;
+
+		memory_stats memory_usage() const;
+		template<class ValueHeapBytes>
+		memory_stats memory_usage(ValueHeapBytes valueHeapBytes) const;
+
+		Value& operator[](const Key& key);
+		const Value& operator[](const Key& key) const;
+
+	private:
+		SampledLRU(const SampledLRU&) = delete;
+		SampledLRU& operator=(const SampledLRU&) = delete;
+
+		mutable LockT lock_;
+		std::vector<Slot> slots_;
+		slot_index* buckets_ = nullptr;
+		std::size_t bucketCount_ = 0;
+		unsigned shift_ = 64;
+		Hash hash_;
+		KeyEqual eq_;
+
+		std::size_t capacity_;
+		std::size_t samples_;
+		std::uint32_t clock_ = 0;
+		std::uint64_t rng_ = 0x9E3779B97F4A7C15ull;
+
+		// Oldest candidate last
+		Candidate pool_[poolSize];
+		std::size_t poolCount_ = 0;
+
+		Graveyard retired_;
+		reclaim_mode reclaimMode_ = reclaim_mode::immediate;
+
+		cache_stats stats_;
+	};
+
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual>
+	std::size_t SampledLRU<Key, Value, LockT, Hash, KeyEqual>::bucket(std::size_t hash) const
+	{
+		return static_cast<std::size_t>((static_cast<std::uint64_t>(hash) * 0x9E3779B97F4A7C15ull) >> shift_);
+	}
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual>
+	template<class K>
+	typename SampledLRU<Key, Value, LockT, Hash, KeyEqual>::slot_index
+	SampledLRU<Key, Value, LockT, Hash, KeyEqual>::findSlot(const K& key, std::size_t hash) const
+	{
+		if (slots_.empty())
+			return npos;
+
+		for (slot_index i = buckets_[bucket(hash)]; i != npos; i = slots_[i].hnext)
+		{
+			if (eq_(slots_[i].key, key))
+				return i;
+		}
+		return npos;
+	}
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual>
+	void SampledLRU<Key, Value, LockT, Hash, KeyEqual>::linkSlot(slot_index slot, std::size_t hash)
+	{
+		slot_index& head = buckets_[bucket(hash)];
+		slots_[slot].hnext = head;
+		head = slot;
+	}
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual>
+	void SampledLRU<Key, Value, LockT, Hash, KeyEqual>::unlinkSlot(slot_index slot)
+	{
+		slot_index* link = &buckets_[bucket(hash_(slots_[slot].key))];
+		while (*link != slot)
+			link = &slots_[*link].hnext;
+
+		*link = slots_[slot].hnext;
+	}
+
+	// Fills the hole with the last slot; only values that need destroying go to retired_
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual>
+	void SampledLRU<Key, Value, LockT, Hash, KeyEqual>::removeSlot(slot_index slot)
+	{
+		unlinkSlot(slot);
+		if (!std::is_trivially_destructible<Slot>::value)
+			retired_.push_back(std::move(slots_[slot]));
+
+		slot_index last = static_cast<slot_index>(slots_.size() - 1);
+		if (slot != last)
+		{
+			slot_index* link = &buckets_[bucket(hash_(slots_[last].key))];
+			while (*link != last)
+				link = &slots_[*link].hnext;
+			*link = slot;
+
+			slots_[slot] = std::move(slots_[last]);
+		}
+		slots_.pop_back();
+	}
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual>
+	void SampledLRU<Key, Value, LockT, Hash, KeyEqual>::grow()
+	{
+		std::size_t newCount = bucketCount_ == 0 ? 8 : bucketCount_ * 2;
+		slot_index* newBuckets = new slot_index[newCount];
+		std::fill(newBuckets, newBuckets + newCount, npos);
+
+		delete[] buckets_;
+		buckets_ = newBuckets;
+		bucketCount_ = newCount;
+		shift_ = shift_ == 64 ? 61 : shift_ - 1;
+
+		for (slot_index i = 0; i < slots_.size(); ++i)
+		{
+			slot_index& head = buckets_[bucket(hash_(slots_[i].key))];
+			slots_[i].hnext = head;
+			head = i;
+		}
+	}
+
+	// xorshift64: cheap and good enough to pick sample slots
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual>
+	std::uint64_t SampledLRU<Key, Value, LockT, Hash, KeyEqual>::nextRandom()
+	{
+		rng_ ^= rng_ << 13;
+		rng_ ^= rng_ >> 7;
+		rng_ ^= rng_ << 17;
+		return rng_;
+	}
+
+	// Unsigned difference keeps working across clock wrap-around
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual>
+	std::uint32_t SampledLRU<Key, Value, LockT, Hash, KeyEqual>::age(std::uint32_t stamp) const
+	{
+		return clock_ - stamp;
+	}
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual>
+	void SampledLRU<Key, Value, LockT, Hash, KeyEqual>::touch(Slot& slot)
+	{
+		slot.stamp = ++clock_;
+	}
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual>
+	void SampledLRU<Key, Value, LockT, Hash, KeyEqual>::samplePool()
+	{
+		for (std::size_t s = 0; s < samples_; ++s)
+		{
+			slot_index slot = static_cast<slot_index>(nextRandom() % slots_.size());
+			Candidate c{ slot, slots_[slot].stamp };
+			std::uint32_t a = age(c.stamp);
+
+			// Stamps are unique per access, so an equal one is the same entry
+			std::size_t pos = 0;
+			while (pos < poolCount_ && age(pool_[pos].stamp) < a)
+				++pos;
+			if (pos < poolCount_ && pool_[pos].stamp == c.stamp)
+				continue;
+
+			if (poolCount_ < poolSize)
+			{
+				std::copy_backward(pool_ + pos, pool_ + poolCount_, pool_ + poolCount_ + 1);
+				++poolCount_;
+			}
+			else
+			{
+				// Full: the youngest candidate at the front makes room
+				if (pos == 0)
+					continue;
+				--pos;
+				std::copy(pool_ + 1, pool_ + pos + 1, pool_);
+			}
+			pool_[pos] = c;
+		}
+	}
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual>
+	void SampledLRU<Key, Value, LockT, Hash, KeyEqual>::evictOne()
+	{
+		for (;;)
+		{
+			samplePool();
+			while (poolCount_ > 0)
+			{
+				Candidate c = pool_[--poolCount_];
+				// The slot may have been touched, moved or reused since it was sampled
+				if (c.slot < slots_.size() && slots_[c.slot].stamp == c.stamp)
+				{
+					removeSlot(c.slot);
+					return;
+				}
+			}
+		}
+	}
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual>
+	void SampledLRU<Key, Value, LockT, Hash, KeyEqual>::takeRetired(Graveyard& dead, std::size_t maxSlots)
+	{
+		if (maxSlots >= retired_.size())
+		{
+			dead.swap(retired_);
+			return;
+		}
+
+		dead.reserve(maxSlots);
+		for (std::size_t i = 0; i < maxSlots; ++i)
+		{
+			dead.push_back(std::move(retired_.back()));
+			retired_.pop_back();
+		}
+	}
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual>
+	void SampledLRU<Key, Value, LockT, Hash, KeyEqual>::collectRetired(Graveyard& dead)
+	{
+		takeRetired(dead, reclaimMode_ == reclaim_mode::immediate
+							? retired_.size()
+							: reclaim_chunk);
+	}
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual>
+	template<class K, class... Args>
+	bool SampledLRU<Key, Value, LockT, Hash, KeyEqual>::insertProbed(K&& key, std::size_t hash, Args&&... args)
+	{
+		slot_index found = findSlot(key, hash);
+		if (found != npos)
+		{
+			touch(slots_[found]);
+			assign_value(slots_[found].value, std::forward<Args>(args)...);
+			return false;
+		}
+
+		if (slots_.size() >= capacity_)
+		{
+			evictOne();
+			++stats_.evictions;
+		}
+		if (slots_.size() >= bucketCount_)
+			grow();
+
+		slots_.emplace_back(std::forward<K>(key), std::forward<Args>(args)...);
+		slot_index slot = static_cast<slot_index>(slots_.size() - 1);
+		touch(slots_[slot]);
+		linkSlot(slot, hash);
+		return true;
+	}
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual>
+	template<class K, class... Args>
+	bool SampledLRU<Key, Value, LockT, Hash, KeyEqual>::tryEmplace(K&& key, std::size_t hash, Args&&... args)
+	{
+		Graveyard dead;
+		Guard g(lock_);
+		if (capacity_ == 0 || findSlot(key, hash) != npos)
+			return false;
+
+		bool inserted = insertProbed(std::forward<K>(key), hash, std::forward<Args>(args)...);
+		collectRetired(dead);
+		return inserted;
+	}
+
+	// Slot indices are 32-bit, which bounds the capacity to ~4G entries
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual>
+	SampledLRU<Key, Value, LockT, Hash, KeyEqual>::SampledLRU(std::size_t capacity_, std::size_t samples)
+		: capacity_(std::min<std::size_t>(capacity_, npos - 1)),
+		  samples_(std::max<std::size_t>(1, samples))
+	{ }
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual>
+	SampledLRU<Key, Value, LockT, Hash, KeyEqual>::~SampledLRU()
+	{
+		delete[] buckets_;
+	}
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual>
+	void SampledLRU<Key, Value, LockT, Hash, KeyEqual>::insert(const Key& key, const Value& value)
+	{
+		insert(key, hash_(key), value);
+	}
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual>
+	void SampledLRU<Key, Value, LockT, Hash, KeyEqual>::insert(const Key& key, Value&& value)
+	{
+		insert(key, hash_(key), std::move(value));
+	}
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual>
+	void SampledLRU<Key, Value, LockT, Hash, KeyEqual>::insert(Key&& key, const Value& value)
+	{
+		insert_or_assign(std::move(key), value);
+	}
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual>
+	void SampledLRU<Key, Value, LockT, Hash, KeyEqual>::insert(Key&& key, Value&& value)
+	{
+		insert_or_assign(std::move(key), std::move(value));
+	}
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual>
+	void SampledLRU<Key, Value, LockT, Hash, KeyEqual>::insert(const Key& key, std::size_t hash, const Value& value)
+	{
+		Graveyard dead;
+		Guard g(lock_);
+		if (capacity_ == 0)
+			return;
+
+		insertProbed(key, hash, value);
+		collectRetired(dead);
+	}
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual>
+	void SampledLRU<Key, Value, LockT, Hash, KeyEqual>::insert(const Key& key, std::size_t hash, Value&& value)
+	{
+		Graveyard dead;
+		Guard g(lock_);
+		if (capacity_ == 0)
+			return;
+
+		insertProbed(key, hash, std::move(value));
+		collectRetired(dead);
+	}
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual>
+	template<class... Args>
+	void SampledLRU<Key, Value, LockT, Hash, KeyEqual>::emplace(const Key& key, Args&&... args)
+	{
+		Graveyard dead;
+		Guard g(lock_);
+		if (capacity_ == 0)
+			return;
+
+		insertProbed(key, hash_(key), std::forward<Args>(args)...);
+		collectRetired(dead);
+	}
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual>
+	template<class... Args>
+	void SampledLRU<Key, Value, LockT, Hash, KeyEqual>::emplace(Key&& key, Args&&... args)
+	{
+		Graveyard dead;
+		Guard g(lock_);
+		if (capacity_ == 0)
+			return;
+
+		std::size_t hash = hash_(key);
+		insertProbed(std::move(key), hash, std::forward<Args>(args)...);
+		collectRetired(dead);
+	}
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual>
+	template<class... Args>
+	bool SampledLRU<Key, Value, LockT, Hash, KeyEqual>::try_emplace(const Key& key, Args&&... args)
+	{
+		return tryEmplace(key, hash_(key), std::forward<Args>(args)...);
+	}
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual>
+	template<class... Args>
+	bool SampledLRU<Key, Value, LockT, Hash, KeyEqual>::try_emplace(Key&& key, Args&&... args)
+	{
+		std::size_t hash = hash_(key);
+		return tryEmplace(std::move(key), hash, std::forward<Args>(args)...);
+	}
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual>
+	template<class V>
+	bool SampledLRU<Key, Value, LockT, Hash, KeyEqual>::insert_or_assign(const Key& key, V&& value)
+	{
+		Graveyard dead;
+		Guard g(lock_);
+		if (capacity_ == 0)
+			return false;
+
+		bool inserted = insertProbed(key, hash_(key), std::forward<V>(value));
+		collectRetired(dead);
+		return inserted;
+	}
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual>
+	template<class V>
+	bool SampledLRU<Key, Value, LockT, Hash, KeyEqual>::insert_or_assign(Key&& key, V&& value)
+	{
+		Graveyard dead;
+		Guard g(lock_);
+		if (capacity_ == 0)
+			return false;
+
+		std::size_t hash = hash_(key);
+		bool inserted = insertProbed(std::move(key), hash, std::forward<V>(value));
+		collectRetired(dead);
+		return inserted;
+	}
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual>
+	Value& SampledLRU<Key, Value, LockT, Hash, KeyEqual>::get(const Key& key)
+	{
+		return get<Key, Key>(key, hash_(key));
+	}
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual>
+	template<class K, class>
+	Value& SampledLRU<Key, Value, LockT, Hash, KeyEqual>::get(const K& key)
+	{
+		return get<K, K>(key, hash_(key));
+	}
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual>
+	template<class K, class>
+	Value& SampledLRU<Key, Value, LockT, Hash, KeyEqual>::get(const K& key, std::size_t hash)
+	{
+		Guard g(lock_);
+
+		slot_index slot = findSlot(key, hash);
+		if (slot == npos)
+		{
+			++stats_.misses;
+			throw KeyNotFound();
+		}
+		++stats_.hits;
+
+		touch(slots_[slot]);
+		return slots_[slot].value;
+	}
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual>
+	const Value& SampledLRU<Key, Value, LockT, Hash, KeyEqual>::peek(const Key& key) const
+	{
+		return peek<Key, Key>(key, hash_(key));
+	}
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual>
+	template<class K, class>
+	const Value& SampledLRU<Key, Value, LockT, Hash, KeyEqual>::peek(const K& key) const
+	{
+		return peek<K, K>(key, hash_(key));
+	}
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual>
+	template<class K, class>
+	const Value& SampledLRU<Key, Value, LockT, Hash, KeyEqual>::peek(const K& key, std::size_t hash) const
+	{
+		Guard g(lock_);
+		slot_index slot = findSlot(key, hash);
+		if (slot == npos)
+			throw KeyNotFound();
+
+		return slots_[slot].value;
+	}
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual>
+	bool SampledLRU<Key, Value, LockT, Hash, KeyEqual>::erase(const Key& key)
+	{
+		return erase<Key, Key>(key, hash_(key));
+	}
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual>
+	template<class K, class>
+	bool SampledLRU<Key, Value, LockT, Hash, KeyEqual>::erase(const K& key)
+	{
+		return erase<K, K>(key, hash_(key));
+	}
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual>
+	template<class K, class>
+	bool SampledLRU<Key, Value, LockT, Hash, KeyEqual>::erase(const K& key, std::size_t hash)
+	{
+		Graveyard dead;
+		Guard g(lock_);
+		slot_index slot = findSlot(key, hash);
+		if (slot == npos)
+			return false;
+
+		removeSlot(slot);
+		collectRetired(dead);
+		return true;
+	}
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual>
+	void SampledLRU<Key, Value, LockT, Hash, KeyEqual>::clear()
+	{
+		Graveyard dead;
+		Guard g(lock_);
+
+		if (std::is_trivially_destructible<Slot>::value)
+			slots_.clear();
+		else if (retired_.empty())
+			retired_.swap(slots_);
+		else
+		{
+			std::move(slots_.begin(), slots_.end(), std::back_inserter(retired_));
+			slots_.clear();
+		}
+
+		std::fill(buckets_, buckets_ + bucketCount_, npos);
+		poolCount_ = 0;
+		collectRetired(dead);
+	}
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual>
+	void SampledLRU<Key, Value, LockT, Hash, KeyEqual>::set_capacity(std::size_t newCap)
+	{
+		{
+			Guard g(lock_);
+			capacity_ = std::min<std::size_t>(newCap, npos - 1);
+		}
+
+		bool shrinking = true;
+		while (shrinking)
+		{
+			Graveyard dead;
+			Guard g(lock_);
+
+			for (std::size_t i = 0; i < shrink_step && slots_.size() > capacity_; ++i)
+				evictOne();
+
+			shrinking = slots_.size() > capacity_;
+			collectRetired(dead);
+		}
+	}
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual>
+	void SampledLRU<Key, Value, LockT, Hash, KeyEqual>::set_reclaim_mode(reclaim_mode mode)
+	{
+		Guard g(lock_);
+		reclaimMode_ = mode;
+	}
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual>
+	std::size_t SampledLRU<Key, Value, LockT, Hash, KeyEqual>::reclaim(std::size_t maxSlots)
+	{
+		Graveyard dead;
+		Guard g(lock_);
+		std::size_t count = std::min(maxSlots, retired_.size());
+		takeRetired(dead, count);
+		return count;
+	}
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual>
+	std::size_t SampledLRU<Key, Value, LockT, Hash, KeyEqual>::pending_reclaim() const
+	{
+		Guard g(lock_);
+		return retired_.size();
+	}
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual>
+	bool SampledLRU<Key, Value, LockT, Hash, KeyEqual>::contains(const Key& key) const
+	{
+		return contains<Key, Key>(key, hash_(key));
+	}
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual>
+	template<class K, class>
+	bool SampledLRU<Key, Value, LockT, Hash, KeyEqual>::contains(const K& key) const
+	{
+		return contains<K, K>(key, hash_(key));
+	}
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual>
+	template<class K, class>
+	bool SampledLRU<Key, Value, LockT, Hash, KeyEqual>::contains(const K& key, std::size_t hash) const
+	{
+		Guard g(lock_);
+		return findSlot(key, hash) != npos;
+	}
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual>
+	bool SampledLRU<Key, Value, LockT, Hash, KeyEqual>::empty() const
+	{
+		Guard g(lock_);
+		return slots_.empty();
+	}
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual>
+	std::size_t SampledLRU<Key, Value, LockT, Hash, KeyEqual>::size() const
+	{
+		Guard g(lock_);
+		return slots_.size();
+	}
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual>
+	std::size_t SampledLRU<Key, Value, LockT, Hash, KeyEqual>::capacity() const
+	{
+		Guard g(lock_);
+		return capacity_;
+	}
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual>
+	bool SampledLRU<Key, Value, LockT, Hash, KeyEqual>::full() const
+	{
+		Guard g(lock_);
+		return slots_.size() >= capacity_;
+	}
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual>
+	Hash SampledLRU<Key, Value, LockT, Hash, KeyEqual>::hash_function() const
+	{
+		return hash_;
+	}
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual>
+	cache_stats SampledLRU<Key, Value, LockT, Hash, KeyEqual>::stats() const
+	{
+		Guard g(lock_);
+		return stats_;
+	}
+
+	// Counts reserved slots too: the dense array is what the cache really holds on to
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual>
+	memory_stats SampledLRU<Key, Value, LockT, Hash, KeyEqual>::memory_usage() const
+	{
+		Guard g(lock_);
+		memory_stats stats;
+		stats.index_bytes = bucketCount_ * sizeof(slot_index);
+		stats.node_bytes  = (slots_.capacity() + retired_.capacity()) * sizeof(Slot);
+		return stats;
+	}
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual>
+	template<class ValueHeapBytes>
+	memory_stats SampledLRU<Key, Value, LockT, Hash, KeyEqual>::memory_usage(ValueHeapBytes valueHeapBytes) const
+	{
+		Guard g(lock_);
+		memory_stats stats;
+		stats.index_bytes = bucketCount_ * sizeof(slot_index);
+		stats.node_bytes  = (slots_.capacity() + retired_.capacity()) * sizeof(Slot);
+
+		for (const Slot& slot : slots_)
+			stats.value_heap_bytes += valueHeapBytes(slot.value);
+		return stats;
+	}
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual>
+	Value& SampledLRU<Key, Value, LockT, Hash, KeyEqual>::operator[](const Key& key)
+	{
+		return get(key);
+	}
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual>
+	const Value& SampledLRU<Key, Value, LockT, Hash, KeyEqual>::operator[](const Key& key) const
+	{
+		return peek(key);
+	}
+}
@@ -0,0 +1,671 @@
+#pragma once
+#include "caches/cache_utils.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace cache
+{
+	// LRU cache living in a named POSIX shared-memory segment, so every
+	// process on the host that opens the same name shares one copy.
+	// The segment is a fixed slab: a header, per-shard state, per-shard
+	// bucket arrays and one array of slots. Links are 32-bit slot indices,
+	// never pointers, so each process may map the segment anywhere.
+	// Every shard has its own robust, process-shared mutex; if a process dies
+	// holding it, the next locker resets that shard (its entries are lost,
+	// the rest of the cache is untouched) and carries on.
+	//
+	// Key and Value must be trivially copyable, and Hash must give the same
+	// result in every process (e.g. the same binary after fork()).
+	template<typename Key, typename Value,
+			 class Hash = std::hash<Key>, class KeyEqual = std::equal_to<Key>>
+	class SharedLRU
+	{
+		static_assert(std::is_trivially_copyable<Key>::value, "SharedLRU needs a trivially copyable Key");
+		static_assert(std::is_trivially_copyable<Value>::value, "SharedLRU needs a trivially copyable Value");
+		static_assert(has_hash<Key, Hash>::value, "SharedLRU needs a hashable Key");
+
+	private:
+		using slot_index = std::uint32_t;
+		static constexpr slot_index npos = std::numeric_limits<slot_index>::max();
+		static constexpr std::uint64_t magic = 0x4341434845534852ull; // "CACHESHR"
+
+		struct Slot
+		{
+			Key key;
+			Value value;
+			slot_index prev;
+			slot_index next;
+			slot_index hnext;
+		};
+
+		struct Shard
+		{
+			pthread_mutex_t mutex;
+			slot_index head;      // most recently used
+			slot_index tail;
+			slot_index freeHead;
+			std::uint32_t size;
+			std::uint32_t capacity;
+			std::uint32_t firstSlot;
+			std::uint64_t hits;
+			std::uint64_t misses;
+			std::uint64_t evictions;
+			std::uint64_t recoveries;
+		};
+
+		struct Header
+		{
+			std::uint64_t magic;
+			std::uint64_t layout;
+			std::uint64_t bytes;
+			std::uint32_t shardCount;
+			std::uint32_t slotsPerShard;
+			std::uint32_t bucketsPerShard;
+			std::uint32_t bucketShift;
+			std::uint64_t capacity;
+			std::atomic<std::uint32_t> ready;
+		};
+
+		// Locks one shard; a dead owner's shard is reset before use
+		class ShardGuard
+		{
+		public:
+			ShardGuard(const SharedLRU& cache, Shard& shard);
+			~ShardGuard();
+
+		private:
+			ShardGuard(const ShardGuard&) = delete;
+			ShardGuard& operator=(const ShardGuard&) = delete;
+
+			Shard& shard_;
+		};
+
+		// Byte offsets of the segment parts, in mapping order
+		struct Offsets
+		{
+			std::size_t shards;
+			std::size_t buckets;
+			std::size_t slots;
+			std::size_t end;
+		};
+
+		static std::uint64_t layoutOf();
+		static std::size_t alignUp(std::size_t n, std::size_t align);
+		static Offsets offsetsOf(std::size_t shards, std::size_t buckets, std::size_t perShard);
+
+		void createSegment(int fd, std::size_t capacity, std::size_t shards);
+		void openSegment(int fd);
+		void bindLayout();
+
+		std::size_t shardOf(std::size_t hash) const;
+		slot_index& bucketOf(std::size_t shard, std::size_t hash) const;
+		Slot& slot(slot_index i) const;
+
+		void resetShard(std::size_t shard) const;
+		slot_index find(std::size_t shard, std::size_t hash, const Key& key) const;
+		void unlinkList(Shard& shard, slot_index i) const;
+		void pushFront(Shard& shard, slot_index i) const;
+		void unlinkBucket(std::size_t shard, slot_index i) const;
+		void release(std::size_t shard, slot_index i) const;
+
+	public:
+		// Creates the segment, or attaches to an existing one and adopts its
+		// capacity and shard count
+		SharedLRU(const std::string& name, std::size_t capacity, std::size_t shards = 16);
+		~SharedLRU();
+
+		// Unlinks the name; processes that have it mapped keep working
+		static bool remove(const std::string& name);
+
+		void insert(const Key& key, const Value& value);
+
+		// Values are copied out: a reference into the segment would outlive the lock
+		Value get(const Key& key);
+		Value peek(const Key& key) const;
+
+		// Runs fn(Value&) on the entry under its shard lock; false if absent
+		template<class Fn>
+		bool update(const Key& key, Fn fn);
+
+		bool erase(const Key& key);
+		bool contains(const Key& key) const;
+		void clear();
+
+		bool empty() const;
+		std::size_t size() const;
+		std::size_t capacity() const;
+
+		cache_stats stats() const;
+		// Shards reset because their owner died holding the lock
+		std::size_t recoveries() const;
+		bool created() const;
+
+	private:
+		SharedLRU(const SharedLRU&) = delete;
+		SharedLRU& operator=(const SharedLRU&) = delete;
+
+		void* base_ = nullptr;
+		std::size_t bytes_ = 0;
+		bool created_ = false;
+
+		Header* header_ = nullptr;
+		Shard* shards_ = nullptr;
+		slot_index* buckets_ = nullptr;
+		Slot* slots_ = nullptr;
+
+		Hash hash_;
+		KeyEqual eq_;
+	};
+
+
+	template<typename Key, typename Value, class Hash, class KeyEqual>
+	SharedLRU<Key, Value, Hash, KeyEqual>::ShardGuard::ShardGuard(const SharedLRU& cache, Shard& shard)
+		: shard_(shard)
+	{
+		int rc = pthread_mutex_lock(&shard.mutex);
+		if (rc == EOWNERDEAD)
+		{
+			cache.resetShard(static_cast<std::size_t>(&shard - cache.shards_));
+			++shard.recoveries;
+			pthread_mutex_consistent(&shard.mutex);
+		}
+		else if (rc != 0)
+			throw std::system_error(rc, std::generic_category(), "SharedLRU: shard lock");
+	}
+
+	template<typename Key, typename Value, class Hash, class KeyEqual>
+	SharedLRU<Key, Value, Hash, KeyEqual>::ShardGuard::~ShardGuard()
+	{
+		pthread_mutex_unlock(&shard_.mutex);
+	}
+
+	// Two processes only share a segment if they agree on the slot layout
+	template<typename Key, typename Value, class Hash, class KeyEqual>
+	std::uint64_t SharedLRU<Key, Value, Hash, KeyEqual>::layoutOf()
+	{
+		return (static_cast<std::uint64_t>(sizeof(Key)) << 48)
+			 ^ (static_cast<std::uint64_t>(sizeof(Value)) << 16)
+			 ^ (static_cast<std::uint64_t>(alignof(Slot)) << 8)
+			 ^ static_cast<std::uint64_t>(sizeof(Shard))
+			 ^ 1; // format version
+	}
+
+	template<typename Key, typename Value, class Hash, class KeyEqual>
+	std::size_t SharedLRU<Key, Value, Hash, KeyEqual>::alignUp(std::size_t n, std::size_t align)
+	{
+		return (n + align - 1) / align * align;
+	}
+
+	template<typename Key, typename Value, class Hash, class KeyEqual>
+	SharedLRU<Key, Value, Hash, KeyEqual>::SharedLRU(const std::string& name, std::size_t capacity, std::size_t shards)
+	{
+		int fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+		if (fd >= 0)
+			created_ = true;
+		else if (errno == EEXIST)
+			fd = shm_open(name.c_str(), O_RDWR, 0600);
+
+		if (fd < 0)
+			throw std::system_error(errno, std::generic_category(), "SharedLRU: shm_open " + name);
+
+		try
+		{
+			if (created_)
+				createSegment(fd, capacity, shards);
+			else
+				openSegment(fd);
+		}
+		catch (...)
+		{
+			close(fd);
+			if (base_)
+				munmap(base_, bytes_);
+			if (created_)
+				shm_unlink(name.c_str());
+			throw;
+		}
+		close(fd);
+	}
+
+	template<typename Key, typename Value, class Hash, class KeyEqual>
+	SharedLRU<Key, Value, Hash, KeyEqual>::~SharedLRU()
+	{
+		munmap(base_, bytes_);
+	}
+
+	template<typename Key, typename Value, class Hash, class KeyEqual>
+	bool SharedLRU<Key, Value, Hash, KeyEqual>::remove(const std::string& name)
+	{
+		return shm_unlink(name.c_str()) == 0;
+	}
+
+	template<typename Key, typename Value, class Hash, class KeyEqual>
+	void SharedLRU<Key, Value, Hash, KeyEqual>::createSegment(int fd, std::size_t capacity, std::size_t shards)
+	{
+		if (shards == 0)
+			shards = 1;
+		std::size_t perShard = (capacity + shards - 1) / shards;
+		if (perShard * shards >= npos)
+			throw std::length_error("SharedLRU: capacity too large");
+
+		std::size_t buckets = 1;
+		std::uint32_t shift = 64;
+		while (buckets < perShard)
+		{
+			buckets *= 2;
+			--shift;
+		}
+
+		Offsets at = offsetsOf(shards, buckets, perShard);
+		bytes_ = at.end;
+		if (ftruncate(fd, static_cast<off_t>(bytes_)) != 0)
+			throw std::system_error(errno, std::generic_category(), "SharedLRU: ftruncate");
+
+		base_ = mmap(nullptr, bytes_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+		if (base_ == MAP_FAILED)
+		{
+			base_ = nullptr;
+			throw std::system_error(errno, std::generic_category(), "SharedLRU: mmap");
+		}
+
+		header_ = new (base_) Header;
+		header_->ready.store(0, std::memory_order_relaxed);
+		header_->magic = magic;
+		header_->layout = layoutOf();
+		header_->bytes = bytes_;
+		header_->shardCount = static_cast<std::uint32_t>(shards);
+		header_->slotsPerShard = static_cast<std::uint32_t>(perShard);
+		header_->bucketsPerShard = static_cast<std::uint32_t>(buckets);
+		header_->bucketShift = shift;
+		header_->capacity = capacity;
+		bindLayout();
+
+		pthread_mutexattr_t attr;
+		pthread_mutexattr_init(&attr);
+		pthread_mutexattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+		pthread_mutexattr_setrobust(&attr, PTHREAD_MUTEX_ROBUST);
+
+		for (std::size_t s = 0; s < shards; ++s)
+		{
+			Shard& shard = shards_[s];
+			pthread_mutex_init(&shard.mutex, &attr);
+
+			// The last shards take up the rounding slack
+			std::size_t begin = s * capacity / shards;
+			std::size_t end = (s + 1) * capacity / shards;
+			shard.capacity = static_cast<std::uint32_t>(end - begin);
+			shard.firstSlot = static_cast<std::uint32_t>(s * perShard);
+			shard.hits = shard.misses = shard.evictions = shard.recoveries = 0;
+			resetShard(s);
+		}
+		pthread_mutexattr_destroy(&attr);
+
+		header_->ready.store(1, std::memory_order_release);
+	}
+
+	template<typename Key, typename Value, class Hash, class KeyEqual>
+	void SharedLRU<Key, Value, Hash, KeyEqual>::openSegment(int fd)
+	{
+		// The creator sizes the segment first and flips `ready` last
+		const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+		struct stat st;
+		for (;;)
+		{
+			if (fstat(fd, &st) != 0)
+				throw std::system_error(errno, std::generic_category(), "SharedLRU: fstat");
+			if (static_cast<std::size_t>(st.st_size) >= sizeof(Header))
+				break;
+			if (std::chrono::steady_clock::now() > deadline)
+				throw std::runtime_error("SharedLRU: segment was never initialized");
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+
+		bytes_ = static_cast<std::size_t>(st.st_size);
+		base_ = mmap(nullptr, bytes_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+		if (base_ == MAP_FAILED)
+		{
+			base_ = nullptr;
+			throw std::system_error(errno, std::generic_category(), "SharedLRU: mmap");
+		}
+
+		header_ = static_cast<Header*>(base_);
+		while (header_->ready.load(std::memory_order_acquire) == 0)
+		{
+			if (std::chrono::steady_clock::now() > deadline)
+				throw std::runtime_error("SharedLRU: segment was never initialized");
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+
+		if (header_->magic != magic || header_->layout != layoutOf() || header_->bytes != bytes_)
+			throw std::runtime_error("SharedLRU: segment holds a different key/value layout");
+		bindLayout();
+	}
+
+	template<typename Key, typename Value, class Hash, class KeyEqual>
+	typename SharedLRU<Key, Value, Hash, KeyEqual>::Offsets
+	SharedLRU<Key, Value, Hash, KeyEqual>::offsetsOf(std::size_t shards, std::size_t buckets, std::size_t perShard)
+	{
+		Offsets at;
+		at.shards  = alignUp(sizeof(Header), alignof(Shard));
+		at.buckets = alignUp(at.shards + shards * sizeof(Shard), alignof(slot_index));
+		at.slots   = alignUp(at.buckets + shards * buckets * sizeof(slot_index), alignof(Slot));
+		at.end     = at.slots + shards * perShard * sizeof(Slot);
+		return at;
+	}
+
+	template<typename Key, typename Value, class Hash, class KeyEqual>
+	void SharedLRU<Key, Value, Hash, KeyEqual>::bindLayout()
+	{
+		Offsets at = offsetsOf(header_->shardCount, header_->bucketsPerShard, header_->slotsPerShard);
+
+		char* base = static_cast<char*>(base_);
+		shards_  = reinterpret_cast<Shard*>(base + at.shards);
+		buckets_ = reinterpret_cast<slot_index*>(base + at.buckets);
+		slots_   = reinterpret_cast<Slot*>(base + at.slots);
+	}
+
+	template<typename Key, typename Value, class Hash, class KeyEqual>
+	std::size_t SharedLRU<Key, Value, Hash, KeyEqual>::shardOf(std::size_t hash) const
+	{
+		std::uint64_t h = static_cast<std::uint64_t>(hash);
+		h = (h ^ (h >> 33)) * 0xC2B2AE3D27D4EB4Full;
+		return static_cast<std::size_t>((h >> 32) % header_->shardCount);
+	}
+
+	template<typename Key, typename Value, class Hash, class KeyEqual>
+	typename SharedLRU<Key, Value, Hash, KeyEqual>::slot_index&
+	SharedLRU<Key, Value, Hash, KeyEqual>::bucketOf(std::size_t shard, std::size_t hash) const
+	{
+		std::size_t b = header_->bucketShift == 64 ? 0
+			: static_cast<std::size_t>((static_cast<std::uint64_t>(hash) * 0x9E3779B97F4A7C15ull) >> header_->bucketShift);
+		return buckets_[shard * header_->bucketsPerShard + b];
+	}
+
+	template<typename Key, typename Value, class Hash, class KeyEqual>
+	typename SharedLRU<Key, Value, Hash, KeyEqual>::Slot&
+	SharedLRU<Key, Value, Hash, KeyEqual>::slot(slot_index i) const
+	{
+		return slots_[i];
+	}
+
+	// Empties the shard: all buckets cleared, every slot back on the free list
+	template<typename Key, typename Value, class Hash, class KeyEqual>
+	void SharedLRU<Key, Value, Hash, KeyEqual>::resetShard(std::size_t s) const
+	{
+		Shard& shard = shards_[s];
+		slot_index* buckets = buckets_ + s * header_->bucketsPerShard;
+		std::fill(buckets, buckets + header_->bucketsPerShard, npos);
+
+		shard.head = shard.tail = npos;
+		shard.size = 0;
+		shard.freeHead = shard.capacity == 0 ? npos : shard.firstSlot;
+		for (std::uint32_t i = 0; i < shard.capacity; ++i)
+			slot(shard.firstSlot + i).next = i + 1 < shard.capacity ? shard.firstSlot + i + 1 : npos;
+	}
+
+	template<typename Key, typename Value, class Hash, class KeyEqual>
+	typename SharedLRU<Key, Value, Hash, KeyEqual>::slot_index
+	SharedLRU<Key, Value, Hash, KeyEqual>::find(std::size_t shard, std::size_t hash, const Key& key) const
+	{
+		for (slot_index i = bucketOf(shard, hash); i != npos; i = slot(i).hnext)
+		{
+			if (eq_(slot(i).key, key))
+				return i;
+		}
+		return npos;
+	}
+
+	template<typename Key, typename Value, class Hash, class KeyEqual>
+	void SharedLRU<Key, Value, Hash, KeyEqual>::unlinkList(Shard& shard, slot_index i) const
+	{
+		Slot& s = slot(i);
+		if (s.prev != npos)
+			slot(s.prev).next = s.next;
+		else
+			shard.head = s.next;
+
+		if (s.next != npos)
+			slot(s.next).prev = s.prev;
+		else
+			shard.tail = s.prev;
+	}
+
+	template<typename Key, typename Value, class Hash, class KeyEqual>
+	void SharedLRU<Key, Value, Hash, KeyEqual>::pushFront(Shard& shard, slot_index i) const
+	{
+		Slot& s = slot(i);
+		s.prev = npos;
+		s.next = shard.head;
+		if (shard.head != npos)
+			slot(shard.head).prev = i;
+		else
+			shard.tail = i;
+		shard.head = i;
+	}
+
+	template<typename Key, typename Value, class Hash, class KeyEqual>
+	void SharedLRU<Key, Value, Hash, KeyEqual>::unlinkBucket(std::size_t shard, slot_index i) const
+	{
+		slot_index* link = &bucketOf(shard, hash_(slot(i).key));
+		while (*link != i)
+			link = &slot(*link).hnext;
+		*link = slot(i).hnext;
+	}
+
+	// Values are trivially destructible, so a removed slot just goes back on the free list
+	template<typename Key, typename Value, class Hash, class KeyEqual>
+	void SharedLRU<Key, Value, Hash, KeyEqual>::release(std::size_t shard, slot_index i) const
+	{
+		Shard& sh = shards_[shard];
+		unlinkBucket(shard, i);
+		unlinkList(sh, i);
+		slot(i).next = sh.freeHead;
+		sh.freeHead = i;
+		--sh.size;
+	}
+
+	template<typename Key, typename Value, class Hash, class KeyEqual>
+	void SharedLRU<Key, Value, Hash, KeyEqual>::insert(const Key& key, const Value& value)
+	{
+		std::size_t hash = hash_(key);
+		std::size_t s = shardOf(hash);
+		Shard& shard = shards_[s];
+		ShardGuard g(*this, shard);
+
+		slot_index i = find(s, hash, key);
+		if (i != npos)
+		{
+			slot(i).value = value;
+			unlinkList(shard, i);
+			pushFront(shard, i);
+			return;
+		}
+
+		if (shard.capacity == 0)
+			return;
+
+		if (shard.freeHead == npos)
+		{
+			release(s, shard.tail);
+			++shard.evictions;
+		}
+
+		i = shard.freeHead;
+		shard.freeHead = slot(i).next;
+
+		Slot& fresh = slot(i);
+		fresh.key = key;
+		fresh.value = value;
+		slot_index& head = bucketOf(s, hash);
+		fresh.hnext = head;
+		head = i;
+		pushFront(shard, i);
+		++shard.size;
+	}
+
+	template<typename Key, typename Value, class Hash, class KeyEqual>
+	Value SharedLRU<Key, Value, Hash, KeyEqual>::get(const Key& key)
+	{
+		std::size_t hash = hash_(key);
+		std::size_t s = shardOf(hash);
+		Shard& shard = shards_[s];
+		ShardGuard g(*this, shard);
+
+		slot_index i = find(s, hash, key);
+		if (i == npos)
+		{
+			++shard.misses;
+			throw KeyNotFound();
+		}
+		++shard.hits;
+
+		if (shard.head != i)
+		{
+			unlinkList(shard, i);
+			pushFront(shard, i);
+		}
+		return slot(i).value;
+	}
+
+	template<typename Key, typename Value, class Hash, class KeyEqual>
+	Value SharedLRU<Key, Value, Hash, KeyEqual>::peek(const Key& key) const
+	{
+		std::size_t hash = hash_(key);
+		std::size_t s = shardOf(hash);
+		ShardGuard g(*this, shards_[s]);
+
+		slot_index i = find(s, hash, key);
+		if (i == npos)
+			throw KeyNotFound();
+		return slot(i).value;
+	}
+
+	template<typename Key, typename Value, class Hash, class KeyEqual>
+	template<class Fn>
+	bool SharedLRU<Key, Value, Hash, KeyEqual>::update(const Key& key, Fn fn)
+	{
+		std::size_t hash = hash_(key);
+		std::size_t s = shardOf(hash);
+		Shard& shard = shards_[s];
+		ShardGuard g(*this, shard);
+
+		slot_index i = find(s, hash, key);
+		if (i == npos)
+			return false;
+
+		if (shard.head != i)
+		{
+			unlinkList(shard, i);
+			pushFront(shard, i);
+		}
+		fn(slot(i).value);
+		return true;
+	}
+
+	template<typename Key, typename Value, class Hash, class KeyEqual>
+	bool SharedLRU<Key, Value, Hash, KeyEqual>::erase(const Key& key)
+	{
+		std::size_t hash = hash_(key);
+		std::size_t s = shardOf(hash);
+		ShardGuard g(*this, shards_[s]);
+
+		slot_index i = find(s, hash, key);
+		if (i == npos)
+			return false;
+
+		release(s, i);
+		return true;
+	}
+
+	template<typename Key, typename Value, class Hash, class KeyEqual>
+	bool SharedLRU<Key, Value, Hash, KeyEqual>::contains(const Key& key) const
+	{
+		std::size_t hash = hash_(key);
+		std::size_t s = shardOf(hash);
+		ShardGuard g(*this, shards_[s]);
+		return find(s, hash, key) != npos;
+	}
+
+	// One shard at a time; other processes keep working on the rest meanwhile
+	template<typename Key, typename Value, class Hash, class KeyEqual>
+	void SharedLRU<Key, Value, Hash, KeyEqual>::clear()
+	{
+		for (std::size_t s = 0; s < header_->shardCount; ++s)
+		{
+			ShardGuard g(*this, shards_[s]);
+			resetShard(s);
+		}
+	}
+
+	template<typename Key, typename Value, class Hash, class KeyEqual>
+	bool SharedLRU<Key, Value, Hash, KeyEqual>::empty() const
+	{
+		return size() == 0;
+	}
+
+	template<typename Key, typename Value, class Hash, class KeyEqual>
+	std::size_t SharedLRU<Key, Value, Hash, KeyEqual>::size() const
+	{
+		std::size_t total = 0;
+		for (std::size_t s = 0; s < header_->shardCount; ++s)
+		{
+			ShardGuard g(*this, shards_[s]);
+			total += shards_[s].size;
+		}
+		return total;
+	}
+
+	template<typename Key, typename Value, class Hash, class KeyEqual>
+	std::size_t SharedLRU<Key, Value, Hash, KeyEqual>::capacity() const
+	{
+		return static_cast<std::size_t>(header_->capacity);
+	}
+
+	template<typename Key, typename Value, class Hash, class KeyEqual>
+	cache_stats SharedLRU<Key, Value, Hash, KeyEqual>::stats() const
+	{
+		cache_stats stats;
+		for (std::size_t s = 0; s < header_->shardCount; ++s)
+		{
+			ShardGuard g(*this, shards_[s]);
+			stats.hits      += shards_[s].hits;
+			stats.misses    += shards_[s].misses;
+			stats.evictions += shards_[s].evictions;
+		}
+		return stats;
+	}
+
+	template<typename Key, typename Value, class Hash, class KeyEqual>
+	std::size_t SharedLRU<Key, Value, Hash, KeyEqual>::recoveries() const
+	{
+		std::size_t total = 0;
+		for (std::size_t s = 0; s < header_->shardCount; ++s)
+		{
+			ShardGuard g(*this, shards_[s]);
+			total += shards_[s].recoveries;
+		}
+		return total;
+	}
+
+	template<typename Key, typename Value, class Hash, class KeyEqual>
+	bool SharedLRU<Key, Value, Hash, KeyEqual>::created() const
+	{
+		return created_;
+	}
+}
@@ -0,0 +1,499 @@
+#pragma once
+#include "caches/cache_utils.hpp"
+#include "caches/cache_index.hpp"
+#include "caches/intrusive_list.hpp"
+#include <algorithm>
+#include <mutex>
+#include <type_traits>
+
+namespace cache
+{
+	// 2Q (Johnson and Shasha): a new entry goes into a FIFO (A1in) and is
+	// not promoted by hits there. When it falls out of the FIFO only its key
+	// is kept, in a bounded ghost FIFO (A1out); a key that comes back while
+	// its ghost is remembered goes straight into the main LRU (Am). One-off
+	// scans therefore pass through A1in without touching Am. All three queues
+	// are intrusive lists and every step is O(1).
+	template<typename Key, typename Value, class LockT = NullLock,
+			 class Hash = std::hash<Key>, class KeyEqual = std::equal_to<Key>, class Compare = std::less<Key>>
+	class TwoQ
+	{
+		static_assert(
+			has_hash<Key, Hash>::value || has_less_comp<Key>::value,
+			"Key must be hashable (unordered_map) or less-comparable (map)"
+		);
+
+	private:
+		struct Node;
+		using indexT = select_index_t<Node, Key, Hash, KeyEqual, Compare>;
+
+		struct Node : ListHook, indexT::hook
+		{
+			Key key;
+			Value value;
+			bool main = false;  // in Am rather than A1in
+
+			template<class K, class... Args>
+			Node(K&& key, Args&&... args)
+				: key(std::forward<K>(key)),
+				  value(std::forward<Args>(args)...)
+			{ }
+		};
+
+		// A key recently dropped from A1in, without its value
+		struct Ghost;
+		using ghostIndexT = select_index_t<Ghost, Key, Hash, KeyEqual, Compare>;
+
+		struct Ghost : ListHook, ghostIndexT::hook
+		{
+			Key key;
+
+			Ghost(const Key& key)
+				: key(key)
+			{ }
+		};
+
+		// Frees what it holds once the Guard declared after it has unlocked
+		struct Graveyard : IntrusiveList<Node>
+		{
+			~Graveyard()
+			{
+				this->clear_and_dispose([](Node* node) { delete node; });
+			}
+		};
+
+		static std::size_t share(std::size_t capacity, double part);
+
+		Node* victim() const;
+		void remember(const Key& key);
+		bool forgetGhost(const Key& key);
+		void dropGhosts(std::size_t keep);
+		void unlinkNode(Node* node, Graveyard& dead);
+		void evictOne(Graveyard& dead);
+		void evictOne(Graveyard& dead, typename indexT::hint_type& hint);
+
+		template<class K, class... Args>
+		void insertImpl(K&& key, Args&&... args);
+
+		using Guard = std::lock_guard<LockT>;
+	public:
+		// A1in holds up to in_share of the capacity; A1out remembers up to
+		// out_share of the capacity in keys (the paper's Kin and Kout)
+		TwoQ(std::size_t capacity_, double in_share = 0.25, double out_share = 0.5);
+		~TwoQ();
+
+		void insert(const Key& key, const Value& value);
+		void insert(const Key& key, Value&& value);
+		void insert(Key&& key, const Value& value);
+		void insert(Key&& key, Value&& value);
+		template<class... Args>
+		void emplace(const Key& key, Args&&... args);
+		template<class... Args>
+		void emplace(Key&& key, Args&&... args);
+
+		// A hit refreshes recency only for entries already in Am
+		Value& get(const Key& key);
+		const Value& peek(const Key& key) const;
+
+		bool erase(const Key& key);
+		// Drops the ghost keys as well
+		void clear();
+		void set_capacity(std::size_t newCap);
+
+		bool contains(const Key& key) const;
+		bool empty() const;
+		std::size_t size() const;
+		// Entries in Am, and keys remembered in A1out
+		std::size_t main_size() const;
+		std::size_t ghost_size() const;
+		std::size_t capacity() const;
+		bool full() const;
+
+		cache_stats stats() const;
+
+		memory_stats memory_usage() const;
+		template<class ValueHeapBytes>
+		memory_stats memory_usage(ValueHeapBytes valueHeapBytes) const;
+
+		Value& operator[](const Key& key);
+		const Value& operator[](const Key& key) const;
+
+	private:
+		TwoQ(const TwoQ&) = delete;
+		TwoQ& operator=(const TwoQ&) = delete;
+
+		mutable LockT lock_;
+		indexT cache_;
+		IntrusiveList<Node> in_;
+		IntrusiveList<Node> main_;
+		std::size_t inCount_ = 0;
+
+		ghostIndexT ghostIndex_;
+		IntrusiveList<Ghost> ghosts_;
+
+		std::size_t capacity_;
+		double inShare_;
+		double outShare_;
+		std::size_t inCap_;
+		std::size_t outCap_;
+
+		cache_stats stats_;
+	};
+
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual, class Compare>
+	std::size_t TwoQ<Key, Value, LockT, Hash, KeyEqual, Compare>::share(std::size_t capacity, double part)
+	{
+		return static_cast<std::size_t>(capacity * std::max(0.0, part));
+	}
+
+	// A1in gives up its oldest entry while it is over its share, or when Am is empty
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual, class Compare>
+	typename TwoQ<Key, Value, LockT, Hash, KeyEqual, Compare>::Node* TwoQ<Key, Value, LockT, Hash, KeyEqual, Compare>::victim() const
+	{
+		return !in_.empty() && (inCount_ > inCap_ || main_.empty()) ? in_.back() : main_.back();
+	}
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual, class Compare>
+	void TwoQ<Key, Value, LockT, Hash, KeyEqual, Compare>::remember(const Key& key)
+	{
+		if (outCap_ == 0)
+			return;
+
+		dropGhosts(outCap_ - 1);
+		typename ghostIndexT::hint_type hint;
+		if (ghostIndex_.probe(key, hint))
+			return;
+
+		Ghost* ghost = new Ghost(key);
+		ghosts_.push_front(ghost);
+		ghostIndex_.insert(ghost, hint);
+	}
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual, class Compare>
+	bool TwoQ<Key, Value, LockT, Hash, KeyEqual, Compare>::forgetGhost(const Key& key)
+	{
+		Ghost* ghost = ghostIndex_.find(key);
+		if (ghost == nullptr)
+			return false;
+
+		ghostIndex_.erase(ghost);
+		ghosts_.unlink(ghost);
+		delete ghost;
+		return true;
+	}
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual, class Compare>
+	void TwoQ<Key, Value, LockT, Hash, KeyEqual, Compare>::dropGhosts(std::size_t keep)
+	{
+		while (ghostIndex_.size() > keep)
+		{
+			Ghost* oldest = ghosts_.back();
+			ghostIndex_.erase(oldest);
+			ghosts_.unlink(oldest);
+			delete oldest;
+		}
+	}
+
+	// Everything but the index: callers erase with or without a hint
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual, class Compare>
+	void TwoQ<Key, Value, LockT, Hash, KeyEqual, Compare>::unlinkNode(Node* node, Graveyard& dead)
+	{
+		IntrusiveList<Node>::unlink(node);
+		if (!node->main)
+			--inCount_;
+		dead.push_front(node);
+	}
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual, class Compare>
+	void TwoQ<Key, Value, LockT, Hash, KeyEqual, Compare>::evictOne(Graveyard& dead)
+	{
+		Node* node = victim();
+		if (!node->main)
+			remember(node->key);
+		cache_.erase(node);
+		unlinkNode(node, dead);
+		++stats_.evictions;
+	}
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual, class Compare>
+	void TwoQ<Key, Value, LockT, Hash, KeyEqual, Compare>::evictOne(Graveyard& dead, typename indexT::hint_type& hint)
+	{
+		Node* node = victim();
+		if (!node->main)
+			remember(node->key);
+		cache_.erase(node, hint);
+		unlinkNode(node, dead);
+		++stats_.evictions;
+	}
+
+	// Rewriting an entry counts as a use, so it refreshes recency in Am only
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual, class Compare>
+	template<class K, class... Args>
+	void TwoQ<Key, Value, LockT, Hash, KeyEqual, Compare>::insertImpl(K&& key, Args&&... args)
+	{
+		Graveyard dead;
+		Guard g(lock_);
+		if (capacity_ == 0)
+			return;
+
+		typename indexT::hint_type hint;
+		Node* found = cache_.probe(key, hint);
+		if (found)
+		{
+			assign_value(found->value, std::forward<Args>(args)...);
+			if (found->main)
+				main_.move_to_front(found);
+			return;
+		}
+
+		// Before evicting, which may push out the very ghost being looked for
+		bool seen = forgetGhost(key);
+
+		// >= rather than ==: a concurrent set_capacity may still be shrinking
+		if (cache_.size() >= capacity_)
+			evictOne(dead, hint);
+
+		Node* node = new Node(std::forward<K>(key), std::forward<Args>(args)...);
+		if (seen)
+		{
+			node->main = true;
+			main_.push_front(node);
+		}
+		else
+		{
+			in_.push_front(node);
+			++inCount_;
+		}
+		cache_.insert(node, hint);
+	}
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual, class Compare>
+	TwoQ<Key, Value, LockT, Hash, KeyEqual, Compare>::TwoQ(std::size_t capacity, double in_share, double out_share)
+		: capacity_(capacity), inShare_(in_share), outShare_(out_share),
+		  inCap_(share(capacity, in_share)), outCap_(share(capacity, out_share))
+	{ }
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual, class Compare>
+	TwoQ<Key, Value, LockT, Hash, KeyEqual, Compare>::~TwoQ()
+	{
+		in_.clear_and_dispose([](Node* node) { delete node; });
+		main_.clear_and_dispose([](Node* node) { delete node; });
+		ghosts_.clear_and_dispose([](Ghost* ghost) { delete ghost; });
+	}
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual, class Compare>
+	void TwoQ<Key, Value, LockT, Hash, KeyEqual, Compare>::insert(const Key& key, const Value& value)
+	{
+		insertImpl(key, value);
+	}
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual, class Compare>
+	void TwoQ<Key, Value, LockT, Hash, KeyEqual, Compare>::insert(const Key& key, Value&& value)
+	{
+		insertImpl(key, std::move(value));
+	}
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual, class Compare>
+	void TwoQ<Key, Value, LockT, Hash, KeyEqual, Compare>::insert(Key&& key, const Value& value)
+	{
+		insertImpl(std::move(key), value);
+	}
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual, class Compare>
+	void TwoQ<Key, Value, LockT, Hash, KeyEqual, Compare>::insert(Key&& key, Value&& value)
+	{
+		insertImpl(std::move(key), std::move(value));
+	}
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual, class Compare>
+	template<class... Args>
+	void TwoQ<Key, Value, LockT, Hash, KeyEqual, Compare>::emplace(const Key& key, Args&&... args)
+	{
+		insertImpl(key, std::forward<Args>(args)...);
+	}
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual, class Compare>
+	template<class... Args>
+	void TwoQ<Key, Value, LockT, Hash, KeyEqual, Compare>::emplace(Key&& key, Args&&... args)
+	{
+		insertImpl(std::move(key), std::forward<Args>(args)...);
+	}
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual, class Compare>
+	Value& TwoQ<Key, Value, LockT, Hash, KeyEqual, Compare>::get(const Key& key)
+	{
+		Guard g(lock_);
+		Node* node = cache_.find(key);
+		if (node == nullptr)
+		{
+			++stats_.misses;
+			throw KeyNotFound();
+		}
+		++stats_.hits;
+
+		if (node->main)
+			main_.move_to_front(node);
+		return node->value;
+	}
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual, class Compare>
+	const Value& TwoQ<Key, Value, LockT, Hash, KeyEqual, Compare>::peek(const Key& key) const
+	{
+		Guard g(lock_);
+		Node* node = cache_.find(key);
+		if (node == nullptr)
+			throw KeyNotFound();
+
+		return node->value;
+	}
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual, class Compare>
+	bool TwoQ<Key, Value, LockT, Hash, KeyEqual, Compare>::erase(const Key& key)
+	{
+		Graveyard dead;
+		Guard g(lock_);
+		Node* node = cache_.find(key);
+		if (node == nullptr)
+			return false;
+
+		cache_.erase(node);
+		unlinkNode(node, dead);
+		return true;
+	}
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual, class Compare>
+	void TwoQ<Key, Value, LockT, Hash, KeyEqual, Compare>::clear()
+	{
+		Graveyard dead;
+		Guard g(lock_);
+		dead.splice_back(in_);
+		dead.splice_back(main_);
+		cache_.clear();
+		inCount_ = 0;
+
+		ghosts_.clear_and_dispose([](Ghost* ghost) { delete ghost; });
+		ghostIndex_.clear();
+	}
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual, class Compare>
+	void TwoQ<Key, Value, LockT, Hash, KeyEqual, Compare>::set_capacity(std::size_t newCap)
+	{
+		{
+			Guard g(lock_);
+			capacity_ = newCap;
+			inCap_ = share(newCap, inShare_);
+			outCap_ = share(newCap, outShare_);
+			dropGhosts(outCap_);
+		}
+
+		// In bounded steps so other threads get the lock in between
+		bool shrinking = true;
+		while (shrinking)
+		{
+			Graveyard dead;
+			Guard g(lock_);
+
+			for (std::size_t i = 0; i < shrink_step && cache_.size() > capacity_; ++i)
+				evictOne(dead);
+
+			shrinking = cache_.size() > capacity_;
+		}
+	}
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual, class Compare>
+	bool TwoQ<Key, Value, LockT, Hash, KeyEqual, Compare>::contains(const Key& key) const
+	{
+		Guard g(lock_);
+		return cache_.find(key) != nullptr;
+	}
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual, class Compare>
+	bool TwoQ<Key, Value, LockT, Hash, KeyEqual, Compare>::empty() const
+	{
+		Guard g(lock_);
+		return cache_.empty();
+	}
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual, class Compare>
+	std::size_t TwoQ<Key, Value, LockT, Hash, KeyEqual, Compare>::size() const
+	{
+		Guard g(lock_);
+		return cache_.size();
+	}
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual, class Compare>
+	std::size_t TwoQ<Key, Value, LockT, Hash, KeyEqual, Compare>::main_size() const
+	{
+		Guard g(lock_);
+		return cache_.size() - inCount_;
+	}
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual, class Compare>
+	std::size_t TwoQ<Key, Value, LockT, Hash, KeyEqual, Compare>::ghost_size() const
+	{
+		Guard g(lock_);
+		return ghostIndex_.size();
+	}
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual, class Compare>
+	std::size_t TwoQ<Key, Value, LockT, Hash, KeyEqual, Compare>::capacity() const
+	{
+		Guard g(lock_);
+		return capacity_;
+	}
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual, class Compare>
+	bool TwoQ<Key, Value, LockT, Hash, KeyEqual, Compare>::full() const
+	{
+		Guard g(lock_);
+		return cache_.size() >= capacity_;
+	}
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual, class Compare>
+	cache_stats TwoQ<Key, Value, LockT, Hash, KeyEqual, Compare>::stats() const
+	{
+		Guard g(lock_);
+		return stats_;
+	}
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual, class Compare>
+	memory_stats TwoQ<Key, Value, LockT, Hash, KeyEqual, Compare>::memory_usage() const
+	{
+		Guard g(lock_);
+		memory_stats stats;
+		stats.index_bytes = cache_.memory_usage() + ghostIndex_.memory_usage()
+						  + ghostIndex_.size() * sizeof(Ghost);
+		stats.node_bytes  = cache_.size() * sizeof(Node);
+		return stats;
+	}
+
+	// Walks every entry under the lock - meant for diagnostics, not hot paths
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual, class Compare>
+	template<class ValueHeapBytes>
+	memory_stats TwoQ<Key, Value, LockT, Hash, KeyEqual, Compare>::memory_usage(ValueHeapBytes valueHeapBytes) const
+	{
+		Guard g(lock_);
+		memory_stats stats;
+		stats.index_bytes = cache_.memory_usage() + ghostIndex_.memory_usage()
+						  + ghostIndex_.size() * sizeof(Ghost);
+		stats.node_bytes  = cache_.size() * sizeof(Node);
+
+		for (const IntrusiveList<Node>* queue : { &in_, &main_ })
+			for (const Node* node = queue->front(); node; node = queue->next(node))
+				stats.value_heap_bytes += valueHeapBytes(node->value);
+		return stats;
+	}
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual, class Compare>
+	Value& TwoQ<Key, Value, LockT, Hash, KeyEqual, Compare>::operator[](const Key& key)
+	{
+		return get(key);
+	}
+
+	template<typename Key, typename Value, class LockT, class Hash, class KeyEqual, class Compare>
+	const Value& TwoQ<Key, Value, LockT, Hash, KeyEqual, Compare>::operator[](const Key& key) const
+	{
+		return peek(key);
+	}
+}
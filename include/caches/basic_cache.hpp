@@ -0,0 +1,1213 @@
+#pragma once
+#include "caches/cache_utils.hpp"
+#include "caches/cache_index.hpp"
+#include "caches/intrusive_list.hpp"
+#include "caches/negative_cache.hpp"
+#include "caches/refresh_ahead.hpp"
+#include "caches/tag_index.hpp"
+#include "caches/write_back.hpp"
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <vector>
+
+namespace cache
+{
+	// Eviction segments: one per priority class, then one for pinned entries
+	constexpr std::size_t cache_segments = priority_classes + 1;
+
+	// Holds the cache's lock. A stateless lock (NullLock) becomes an empty
+	// base instead of a member, so an unlocked cache pays nothing for it.
+	template<class LockT, bool = std::is_empty<LockT>::value && !std::is_final<LockT>::value>
+	class lock_holder
+	{
+	protected:
+		LockT& lockRef() const
+		{
+			return lock_;
+		}
+
+	private:
+		mutable LockT lock_;
+	};
+
+	template<class LockT>
+	class lock_holder<LockT, true> : private LockT
+	{
+	protected:
+		LockT& lockRef() const
+		{
+			return const_cast<lock_holder&>(*this);
+		}
+	};
+
+	// The cache behind LRU and LFU. Everything but the eviction order is
+	// shared: the index, pinning and priority classes, tags, write-behind,
+	// refresh-ahead, negative caching and deferred reclamation. All three
+	// policies are template arguments, so every call is resolved statically.
+	//
+	// Policy decides which entry goes next (see lru_policy, lfu_policy):
+	//   template<class Node> struct hook;   a base of every entry, for per-entry state
+	//   template<class Node> class order;   holds cache_segments lists of entries and offers
+	//     push(node, seg)         a new entry
+	//     touch(node, seg)        a use: get(), lookup() or assigning a present key
+	//     remove(node)            the entry leaves the cache
+	//     move(node, from, to)    the entry changes segment (pin, unpin, priority)
+	//     victim(seg)             the entry to evict from a segment, or nullptr
+	//     take_all(list)          moves every entry onto `list`
+	//     for_each(fn)            visits every entry
+	//     memory_usage()          bytes held beyond the entries themselves
+	//   counts_uses              true if order also offers top_k(k, out)
+	// IndexPolicy picks the lookup structure (see auto_index).
+	template<typename Key, typename Value, class Policy, class IndexPolicy = auto_index, class LockT = NullLock,
+			 class Hash = std::hash<Key>, class KeyEqual = std::equal_to<Key>, class Compare = std::less<Key>>
+	class basic_cache : private lock_holder<LockT>
+	{
+		static_assert(
+			has_hash<Key, Hash>::value || has_less_comp<Key>::value,
+			"Key must be hashable (unordered_map) or less-comparable (map)"
+		);
+
+	private:
+		struct Node;
+		using indexT = typename IndexPolicy::template index<Node, Key, Hash, KeyEqual, Compare>;
+		using orderT = typename Policy::template order<Node>;
+
+		// The key lives only here; the index links through the node
+		struct Node : ListHook, Policy::template hook<Node>, indexT::hook, TagIndex<Node>::hook
+		{
+			Key key;
+			Value value;
+			priority cls = priority::normal;
+			bool pinned = false;
+
+			template<class K, class... Args>
+			Node(K&& key, Args&&... args)
+				: key(std::forward<K>(key)),
+				  value(std::forward<Args>(args)...)
+			{ }
+		};
+
+		using Guard = std::lock_guard<LockT>;
+		using lock_holder<LockT>::lockRef;
+
+		// Frees what it holds once the Guard declared after it has unlocked
+		struct Graveyard : IntrusiveList<Node>
+		{
+			~Graveyard()
+			{
+				this->clear_and_dispose([](Node* node) { delete node; });
+			}
+		};
+
+		static constexpr std::size_t pinned_segment = priority_classes;
+
+		std::size_t segmentOf(const Node* node) const;
+		Node* victim() const;
+		std::size_t evictable() const;
+		void relink(Node* node, priority cls, bool pinned);
+
+		void touch(Node* node);
+		void eraseFullNode(Node* node);
+		void eraseFullNode(Node* node, typename indexT::hint_type& hint);
+		void releaseNode(Node* node);
+		void releaseAll();
+		void takeRetired(Graveyard& dead, std::size_t maxNodes);
+		void collectRetired(Graveyard& dead);
+		void applyRefresh(const Key& key, std::uint64_t version, Value* fresh);
+
+		template<class K, class... Args>
+		Node* insertProbed(K&& key, Node* found, typename indexT::hint_type& hint, Args&&... args);
+		template<class K, class... Args>
+		bool insertImpl(K&& key, Args&&... args);
+		template<class K, class... Args>
+		bool tryEmplace(K&& key, Args&&... args);
+		template<class K, class... Args>
+		void insertTagged(tag_list tags, K&& key, Args&&... args);
+		template<class K, class... Args>
+		void insertPrioritized(priority cls, K&& key, Args&&... args);
+
+		// Heterogeneous lookup needs a transparent Hash + KeyEqual (or Compare)
+		template<class K>
+		using enable_lookup_t = std::enable_if_t<indexT::transparent, K>;
+		// Precomputed hashes come from hash_function() and only exist for hashed keys
+		template<class K>
+		using enable_hashed_t = std::enable_if_t<indexT::hashed
+								&& (std::is_same<K, Key>::value || indexT::transparent), K>;
+		template<class P>
+		using enable_counting_t = std::enable_if_t<P::counts_uses, P>;
+		template<class L>
+		using enable_lock_stats_t = decltype(std::declval<const L&>().stats());
+	public:
+		basic_cache(std::size_t capacity);
+		~basic_cache();
+
+		void insert(const Key& key, const Value& value);
+		void insert(const Key& key, Value&& value);
+		void insert(Key&& key, const Value& value);
+		void insert(Key&& key, Value&& value);
+		void insert(const Key& key, std::size_t hash, const Value& value);
+		void insert(const Key& key, std::size_t hash, Value&& value);
+		template<class... Args>
+		void emplace(const Key& key, Args&&... args);
+		template<class... Args>
+		void emplace(Key&& key, Args&&... args);
+
+		// The entry joins every listed tag group, keeping tags it already has
+		void insert(const Key& key, const Value& value, tag_list tags);
+		void insert(Key&& key, Value&& value, tag_list tags);
+		template<class... Args>
+		void emplace(tag_list tags, const Key& key, Args&&... args);
+		template<class... Args>
+		void emplace(tag_list tags, Key&& key, Args&&... args);
+
+		// The entry moves to the given eviction class (new entries start as normal)
+		void insert(const Key& key, const Value& value, priority cls);
+		void insert(Key&& key, Value&& value, priority cls);
+
+		// Constructs the value only if the key is absent; a present entry is left untouched
+		template<class... Args>
+		bool try_emplace(const Key& key, Args&&... args);
+		template<class... Args>
+		bool try_emplace(Key&& key, Args&&... args);
+
+		// true if a new entry was inserted, false if an existing one was assigned
+		template<class V>
+		bool insert_or_assign(const Key& key, V&& value);
+		template<class V>
+		bool insert_or_assign(Key&& key, V&& value);
+
+		// Inserts or assigns every key/value pair of the range under one lock;
+		// later pairs may evict earlier ones if the range exceeds the capacity
+		template<class InputIt>
+		void insert_many(InputIt first, InputIt last);
+
+		Value& get(const Key& key);
+		template<class K, class = enable_lookup_t<K>>
+		Value& get(const K& key);
+		template<class K, class = enable_hashed_t<K>>
+		Value& get(const K& key, std::size_t hash);
+
+		const Value& peek(const Key& key) const;
+		template<class K, class = enable_lookup_t<K>>
+		const Value& peek(const K& key) const;
+		template<class K, class = enable_hashed_t<K>>
+		const Value& peek(const K& key, std::size_t hash) const;
+
+		bool erase(const Key& key);
+		template<class K, class = enable_lookup_t<K>>
+		bool erase(const K& key);
+		template<class K, class = enable_hashed_t<K>>
+		bool erase(const K& key, std::size_t hash);
+
+		// Removes every entry carrying the tag in one locked pass; returns how many
+		std::size_t invalidate_tag(tag_type tag);
+		std::size_t tag_size(tag_type tag) const;
+
+		void clear();
+		// Bounds the unpinned entries; pinned ones come on top
+		void set_capacity(std::size_t newCap);
+
+		// Pinned entries are never evicted; unpinning one may evict to make room.
+		// Both return false if the key is absent.
+		bool pin(const Key& key);
+		bool unpin(const Key& key);
+		std::size_t pinned_count() const;
+		// Moves an entry to another class: LRU makes it the class's most
+		// recent entry, LFU keeps its frequency
+		bool set_priority(const Key& key, priority cls);
+
+		// Ordered (non-hashable) keys only: one critical section, O(log n + k).
+		// Ranges are half-open [lo, hi); visiting does not count as a use.
+		std::size_t erase_range(const Key& lo, const Key& hi);
+		template<class Prefix>
+		std::size_t erase_prefix(const Prefix& prefix);
+		template<class Fn>
+		void for_each_in_range(const Key& lo, const Key& hi, Fn fn);
+
+		// Write-behind: from now on every insert marks its entry dirty, and `sink`
+		// receives dirty entries in batches - on flush(), flush_expired() (see
+		// Flusher), clear(), destruction, and from inserting threads once more
+		// than opts.max_dirty are pending. Dirty entries that are evicted or
+		// erased are still written. Changes made through get() are not tracked.
+		void enable_write_behind(write_sink<Key, Value> sink, write_behind_options opts = write_behind_options());
+		// Write every pending entry / those dirty longer than max_staleness; return how many
+		std::size_t flush();
+		std::size_t flush_expired();
+		std::size_t dirty_count() const;
+
+		// Refresh-ahead: once an entry written after this call is older than
+		// `refresh_after`, the next get() still returns the cached value but also
+		// queues one reload of the key on `pool`. The result replaces the value in
+		// place, without counting as a use; a failed reload keeps the old value.
+		// The pool must outlive the cache.
+		void enable_refresh_ahead(refresh_loader<Key, Value> loader, RefreshPool& pool, std::chrono::milliseconds refresh_after);
+
+		// Negative caching: insert_absent() records that a key has no value
+		// upstream, and lookup() tells a hit (copied into `out`) from a key known
+		// to be absent and from one never seen, without throwing. Absent keys are
+		// kept apart from the entries and take no capacity (see NegativeCache);
+		// inserting a value for a key forgets its absence.
+		void enable_negative_cache(negative_cache_options opts = negative_cache_options());
+		void insert_absent(const Key& key);
+		lookup_status lookup(const Key& key, Value& out);
+
+		void set_reclaim_mode(reclaim_mode mode);
+		// Frees up to maxNodes removed entries outside the lock; returns how many
+		std::size_t reclaim(std::size_t maxNodes = std::numeric_limits<std::size_t>::max());
+		std::size_t pending_reclaim() const;
+
+		bool contains(const Key& key) const;
+		template<class K, class = enable_lookup_t<K>>
+		bool contains(const K& key) const;
+		template<class K, class = enable_hashed_t<K>>
+		bool contains(const K& key, std::size_t hash) const;
+
+		bool empty() const;
+		std::size_t size() const;
+		std::size_t capacity() const;
+		bool full() const;
+
+		Hash hash_function() const;
+		cache_stats stats() const;
+		// Wait and hold times of the lock, if it measures them (InstrumentedLock)
+		template<class L = LockT, class = enable_lock_stats_t<L>>
+		lock_stats contention() const;
+
+		// Most frequently used keys first; walks only the entries it returns.
+		// Only for policies that count uses (LFU).
+		template<class P = Policy, class = enable_counting_t<P>>
+		std::vector<hot_key<Key>> top_k(std::size_t k) const;
+
+		memory_stats memory_usage() const;
+		template<class ValueHeapBytes>
+		memory_stats memory_usage(ValueHeapBytes valueHeapBytes) const;
+
+		Value& operator[](const Key& key);
+		const Value& operator[](const Key& key) const;
+
+	private:
+		basic_cache(const basic_cache&) = delete;
+		basic_cache& operator=(const basic_cache&) = delete;
+
+		std::size_t capacity_;
+		indexT index_;
+		orderT order_;
+		std::size_t pinnedCount_ = 0;
+
+		TagIndex<Node> tags_;
+		WriteBack<Node, Key, Value> writeBack_;
+		RefreshAhead<Node, Key, Value> refresh_;
+		std::unique_ptr<select_negative_cache_t<Key, Hash, KeyEqual>> negative_;
+
+		// Unlinked under the lock, destroyed outside it
+		IntrusiveList<Node> retired_;
+		std::size_t retiredCount_ = 0;
+		reclaim_mode reclaimMode_ = reclaim_mode::immediate;
+
+		cache_stats stats_;
+	};
+
+
+	template<typename Key, typename Value, class Policy, class IndexPolicy, class LockT, class Hash, class KeyEqual, class Compare>
+	std::size_t basic_cache<Key, Value, Policy, IndexPolicy, LockT, Hash, KeyEqual, Compare>::segmentOf(const Node* node) const
+	{
+		return node->pinned ? pinned_segment : static_cast<std::size_t>(node->cls);
+	}
+
+	// The policy's victim in the lowest non-empty class
+	template<typename Key, typename Value, class Policy, class IndexPolicy, class LockT, class Hash, class KeyEqual, class Compare>
+	typename basic_cache<Key, Value, Policy, IndexPolicy, LockT, Hash, KeyEqual, Compare>::Node*
+	basic_cache<Key, Value, Policy, IndexPolicy, LockT, Hash, KeyEqual, Compare>::victim() const
+	{
+		for (std::size_t i = 0; i < priority_classes; ++i)
+		{
+			if (Node* node = order_.victim(i))
+				return node;
+		}
+		return nullptr;
+	}
+
+	template<typename Key, typename Value, class Policy, class IndexPolicy, class LockT, class Hash, class KeyEqual, class Compare>
+	std::size_t basic_cache<Key, Value, Policy, IndexPolicy, LockT, Hash, KeyEqual, Compare>::evictable() const
+	{
+		return index_.size() - pinnedCount_;
+	}
+
+	template<typename Key, typename Value, class Policy, class IndexPolicy, class LockT, class Hash, class KeyEqual, class Compare>
+	void basic_cache<Key, Value, Policy, IndexPolicy, LockT, Hash, KeyEqual, Compare>::relink(Node* node, priority cls, bool pinned)
+	{
+		std::size_t from = segmentOf(node);
+		pinnedCount_ = pinnedCount_ - node->pinned + pinned;
+		node->cls = cls;
+		node->pinned = pinned;
+		order_.move(node, from, segmentOf(node));
+	}
+
+	template<typename Key, typename Value, class Policy, class IndexPolicy, class LockT, class Hash, class KeyEqual, class Compare>
+	void basic_cache<Key, Value, Policy, IndexPolicy, LockT, Hash, KeyEqual, Compare>::touch(Node* node)
+	{
+		order_.touch(node, segmentOf(node));
+	}
+
+	// Shared tail of every insert; `found` and `hint` come from a single probe.
+	// Returns the entry written, which is `found` unless a new one was made.
+	template<typename Key, typename Value, class Policy, class IndexPolicy, class LockT, class Hash, class KeyEqual, class Compare>
+	template<class K, class... Args>
+	typename basic_cache<Key, Value, Policy, IndexPolicy, LockT, Hash, KeyEqual, Compare>::Node*
+	basic_cache<Key, Value, Policy, IndexPolicy, LockT, Hash, KeyEqual, Compare>::insertProbed(K&& key, Node* found, typename indexT::hint_type& hint, Args&&... args)
+	{
+		if (found)
+		{
+			assign_value(found->value, std::forward<Args>(args)...);
+			touch(found);
+			if (writeBack_.enabled())
+				writeBack_.mark(found);
+			if (refresh_.enabled())
+				refresh_.stamp(found);
+			return found;
+		}
+
+		// >= rather than ==: a concurrent set_capacity may still be shrinking
+		if (evictable() >= capacity_)
+		{
+			eraseFullNode(victim(), hint);
+			++stats_.evictions;
+		}
+
+		Node* node = new Node(std::forward<K>(key), std::forward<Args>(args)...);
+		order_.push(node, static_cast<std::size_t>(priority::normal));
+		index_.insert(node, hint);
+		if (writeBack_.enabled())
+			writeBack_.mark(node);
+		if (refresh_.enabled())
+			refresh_.stamp(node);
+		if (negative_)
+			negative_->forget(node->key);
+		return node;
+	}
+
+	template<typename Key, typename Value, class Policy, class IndexPolicy, class LockT, class Hash, class KeyEqual, class Compare>
+	template<class K, class... Args>
+	bool basic_cache<Key, Value, Policy, IndexPolicy, LockT, Hash, KeyEqual, Compare>::insertImpl(K&& key, Args&&... args)
+	{
+		writeBack_.relieve(lockRef());
+		Graveyard dead;
+		Guard g(lockRef());
+		if (capacity_ == 0)
+			return false;
+
+		typename indexT::hint_type hint;
+		Node* found = index_.probe(key, hint);
+		bool inserted = insertProbed(std::forward<K>(key), found, hint, std::forward<Args>(args)...) != found;
+		collectRetired(dead);
+		return inserted;
+	}
+
+	template<typename Key, typename Value, class Policy, class IndexPolicy, class LockT, class Hash, class KeyEqual, class Compare>
+	template<class K, class... Args>
+	bool basic_cache<Key, Value, Policy, IndexPolicy, LockT, Hash, KeyEqual, Compare>::tryEmplace(K&& key, Args&&... args)
+	{
+		writeBack_.relieve(lockRef());
+		Graveyard dead;
+		Guard g(lockRef());
+		if (capacity_ == 0)
+			return false;
+
+		typename indexT::hint_type hint;
+		Node* found = index_.probe(key, hint);
+		if (found)
+			return false;
+
+		bool inserted = insertProbed(std::forward<K>(key), found, hint, std::forward<Args>(args)...) != found;
+		collectRetired(dead);
+		return inserted;
+	}
+
+	template<typename Key, typename Value, class Policy, class IndexPolicy, class LockT, class Hash, class KeyEqual, class Compare>
+	void basic_cache<Key, Value, Policy, IndexPolicy, LockT, Hash, KeyEqual, Compare>::eraseFullNode(Node* node)
+	{
+		index_.erase(node);
+		releaseNode(node);
+	}
+
+	template<typename Key, typename Value, class Policy, class IndexPolicy, class LockT, class Hash, class KeyEqual, class Compare>
+	void basic_cache<Key, Value, Policy, IndexPolicy, LockT, Hash, KeyEqual, Compare>::eraseFullNode(Node* node, typename indexT::hint_type& hint)
+	{
+		index_.erase(node, hint);
+		releaseNode(node);
+	}
+
+	template<typename Key, typename Value, class Policy, class IndexPolicy, class LockT, class Hash, class KeyEqual, class Compare>
+	void basic_cache<Key, Value, Policy, IndexPolicy, LockT, Hash, KeyEqual, Compare>::releaseNode(Node* node)
+	{
+		tags_.detach(node);
+		order_.remove(node);
+		pinnedCount_ -= node->pinned;
+		if (writeBack_.enabled())
+			writeBack_.retire(node);
+		if (refresh_.enabled())
+			refresh_.retire(node);
+		retired_.push_back(node);
+		++retiredCount_;
+	}
+
+	template<typename Key, typename Value, class Policy, class IndexPolicy, class LockT, class Hash, class KeyEqual, class Compare>
+	void basic_cache<Key, Value, Policy, IndexPolicy, LockT, Hash, KeyEqual, Compare>::releaseAll()
+	{
+		order_.take_all(retired_);
+		retiredCount_ += index_.size();
+		index_.clear();
+		tags_.clear();
+		refresh_.clear();
+		if (negative_)
+			negative_->clear();
+		pinnedCount_ = 0;
+	}
+
+	template<typename Key, typename Value, class Policy, class IndexPolicy, class LockT, class Hash, class KeyEqual, class Compare>
+	void basic_cache<Key, Value, Policy, IndexPolicy, LockT, Hash, KeyEqual, Compare>::takeRetired(Graveyard& dead, std::size_t maxNodes)
+	{
+		if (maxNodes >= retiredCount_)
+		{
+			dead.splice_back(retired_);
+			retiredCount_ = 0;
+			return;
+		}
+
+		for (std::size_t i = 0; i < maxNodes; ++i)
+		{
+			Node* node = retired_.front();
+			retired_.unlink(node);
+			dead.push_back(node);
+		}
+		retiredCount_ -= maxNodes;
+	}
+
+	// A finished reload, from a RefreshPool thread
+	template<typename Key, typename Value, class Policy, class IndexPolicy, class LockT, class Hash, class KeyEqual, class Compare>
+	void basic_cache<Key, Value, Policy, IndexPolicy, LockT, Hash, KeyEqual, Compare>::applyRefresh(const Key& key, std::uint64_t version, Value* fresh)
+	{
+		Guard g(lockRef());
+		if (Node* node = index_.find(key))
+			refresh_.finish(node, version, fresh);
+	}
+
+	// Picks what the current call frees after unlocking
+	template<typename Key, typename Value, class Policy, class IndexPolicy, class LockT, class Hash, class KeyEqual, class Compare>
+	void basic_cache<Key, Value, Policy, IndexPolicy, LockT, Hash, KeyEqual, Compare>::collectRetired(Graveyard& dead)
+	{
+		takeRetired(dead, reclaimMode_ == reclaim_mode::immediate
+							? retiredCount_
+							: reclaim_chunk);
+	}
+
+	template<typename Key, typename Value, class Policy, class IndexPolicy, class LockT, class Hash, class KeyEqual, class Compare>
+	template<class K, class... Args>
+	void basic_cache<Key, Value, Policy, IndexPolicy, LockT, Hash, KeyEqual, Compare>::insertTagged(tag_list tags, K&& key, Args&&... args)
+	{
+		writeBack_.relieve(lockRef());
+		Graveyard dead;
+		Guard g(lockRef());
+		if (capacity_ == 0)
+			return;
+
+		typename indexT::hint_type hint;
+		Node* found = index_.probe(key, hint);
+		tags_.attach(insertProbed(std::forward<K>(key), found, hint, std::forward<Args>(args)...), tags);
+		collectRetired(dead);
+	}
+
+	template<typename Key, typename Value, class Policy, class IndexPolicy, class LockT, class Hash, class KeyEqual, class Compare>
+	template<class K, class... Args>
+	void basic_cache<Key, Value, Policy, IndexPolicy, LockT, Hash, KeyEqual, Compare>::insertPrioritized(priority cls, K&& key, Args&&... args)
+	{
+		writeBack_.relieve(lockRef());
+		Graveyard dead;
+		Guard g(lockRef());
+		if (capacity_ == 0)
+			return;
+
+		typename indexT::hint_type hint;
+		Node* found = index_.probe(key, hint);
+		Node* node = insertProbed(std::forward<K>(key), found, hint, std::forward<Args>(args)...);
+		relink(node, cls, node->pinned);
+		collectRetired(dead);
+	}
+
+	template<typename Key, typename Value, class Policy, class IndexPolicy, class LockT, class Hash, class KeyEqual, class Compare>
+	basic_cache<Key, Value, Policy, IndexPolicy, LockT, Hash, KeyEqual, Compare>::basic_cache(std::size_t capacity)
+		: capacity_(capacity)
+	{ }
+
+	template<typename Key, typename Value, class Policy, class IndexPolicy, class LockT, class Hash, class KeyEqual, class Compare>
+	basic_cache<Key, Value, Policy, IndexPolicy, LockT, Hash, KeyEqual, Compare>::~basic_cache()
+	{
+		refresh_.close();
+		if (writeBack_.enabled())
+		{
+			// Nobody is left to retry a failing sink; its batch is dropped
+			try
+			{
+				writeBack_.flush_all(lockRef());
+			}
+			catch (...)
+			{ }
+		}
+		releaseAll();
+		retired_.clear_and_dispose([](Node* node) { delete node; });
+	}
+
+	template<typename Key, typename Value, class Policy, class IndexPolicy, class LockT, class Hash, class KeyEqual, class Compare>
+	void basic_cache<Key, Value, Policy, IndexPolicy, LockT, Hash, KeyEqual, Compare>::insert(const Key& key, const Value& value)
+	{
+		insertImpl(key, value);
+	}
+
+	template<typename Key, typename Value, class Policy, class IndexPolicy, class LockT, class Hash, class KeyEqual, class Compare>
+	void basic_cache<Key, Value, Policy, IndexPolicy, LockT, Hash, KeyEqual, Compare>::insert(const Key& key, Value&& value)
+	{
+		insertImpl(key, std::move(value));
+	}
+
+	template<typename Key, typename Value, class Policy, class IndexPolicy, class LockT, class Hash, class KeyEqual, class Compare>
+	void basic_cache<Key, Value, Policy, IndexPolicy, LockT, Hash, KeyEqual, Compare>::insert(const Key& key, std::size_t hash, const Value& value)
+	{
+		static_assert(indexT::hashed, "Precomputed hashes need a hashable Key");
+		writeBack_.relieve(lockRef());
+		Graveyard dead;
+		Guard g(lockRef());
+		if (capacity_ == 0)
+			return;
+
+		typename indexT::hint_type hint;
+		Node* found = index_.probe_hashed(key, hash, hint);
+		insertProbed(key, found, hint, value);
+		collectRetired(dead);
+	}
+
+	template<typename Key, typename Value, class Policy, class IndexPolicy, class LockT, class Hash, class KeyEqual, class Compare>
+	void basic_cache<Key, Value, Policy, IndexPolicy, LockT, Hash, KeyEqual, Compare>::insert(const Key& key, std::size_t hash, Value&& value)
+	{
+		static_assert(indexT::hashed, "Precomputed hashes need a hashable Key");
+		writeBack_.relieve(lockRef());
+		Graveyard dead;
+		Guard g(lockRef());
+		if (capacity_ == 0)
+			return;
+
+		typename indexT::hint_type hint;
+		Node* found = index_.probe_hashed(key, hash, hint);
+		insertProbed(key, found, hint, std::move(value));
+		collectRetired(dead);
+	}
+
+	template<typename Key, typename Value, class Policy, class IndexPolicy, class LockT, class Hash, class KeyEqual, class Compare>
+	template<class... Args>
+	void basic_cache<Key, Value, Policy, IndexPolicy, LockT, Hash, KeyEqual, Compare>::emplace(const Key& key, Args&& ... args)
+	{
+		insertImpl(key, std::forward<Args>(args)...);
+	}
+
+	template<typename Key, typename Value, class Policy, class IndexPolicy, class LockT, class Hash, class KeyEqual, class Compare>
+	void basic_cache<Key, Value, Policy, IndexPolicy, LockT, Hash, KeyEqual, Compare>::insert(Key&& key, const Value& value)
+	{
+		insertImpl(std::move(key), value);
+	}
+
+	template<typename Key, typename Value, class Policy, class IndexPolicy, class LockT, class Hash, class KeyEqual, class Compare>
+	void basic_cache<Key, Value, Policy, IndexPolicy, LockT, Hash, KeyEqual, Compare>::insert(Key&& key, Value&& value)
+	{
+		insertImpl(std::move(key), std::move(value));
+	}
+
+	template<typename Key, typename Value, class Policy, class IndexPolicy, class LockT, class Hash, class KeyEqual, class Compare>
+	template<class... Args>
+	void basic_cache<Key, Value, Policy, IndexPolicy, LockT, Hash, KeyEqual, Compare>::emplace(Key&& key, Args&&... args)
+	{
+		insertImpl(std::move(key), std::forward<Args>(args)...);
+	}
+
+	template<typename Key, typename Value, class Policy, class IndexPolicy, class LockT, class Hash, class KeyEqual, class Compare>
+	void basic_cache<Key, Value, Policy, IndexPolicy, LockT, Hash, KeyEqual, Compare>::insert(const Key& key, const Value& value, tag_list tags)
+	{
+		insertTagged(tags, key, value);
+	}
+
+	template<typename Key, typename Value, class Policy, class IndexPolicy, class LockT, class Hash, class KeyEqual, class Compare>
+	void basic_cache<Key, Value, Policy, IndexPolicy, LockT, Hash, KeyEqual, Compare>::insert(Key&& key, Value&& value, tag_list tags)
+	{
+		insertTagged(tags, std::move(key), std::move(value));
+	}
+
+	template<typename Key, typename Value, class Policy, class IndexPolicy, class LockT, class Hash, class KeyEqual, class Compare>
+	template<class... Args>
+	void basic_cache<Key, Value, Policy, IndexPolicy, LockT, Hash, KeyEqual, Compare>::emplace(tag_list tags, const Key& key, Args&&... args)
+	{
+		insertTagged(tags, key, std::forward<Args>(args)...);
+	}
+
+	template<typename Key, typename Value, class Policy, class IndexPolicy, class LockT, class Hash, class KeyEqual, class Compare>
+	template<class... Args>
+	void basic_cache<Key, Value, Policy, IndexPolicy, LockT, Hash, KeyEqual, Compare>::emplace(tag_list tags, Key&& key, Args&&... args)
+	{
+		insertTagged(tags, std::move(key), std::forward<Args>(args)...);
+	}
+
+	template<typename Key, typename Value, class Policy, class IndexPolicy, class LockT, class Hash, class KeyEqual, class Compare>
+	void basic_cache<Key, Value, Policy, IndexPolicy, LockT, Hash, KeyEqual, Compare>::insert(const Key& key, const Value& value, priority cls)
+	{
+		insertPrioritized(cls, key, value);
+	}
+
+	template<typename Key, typename Value, class Policy, class IndexPolicy, class LockT, class Hash, class KeyEqual, class Compare>
+	void basic_cache<Key, Value, Policy, IndexPolicy, LockT, Hash, KeyEqual, Compare>::insert(Key&& key, Value&& value, priority cls)
+	{
+		insertPrioritized(cls, std::move(key), std::move(value));
+	}
+
+	template<typename Key, typename Value, class Policy, class IndexPolicy, class LockT, class Hash, class KeyEqual, class Compare>
+	template<class... Args>
+	bool basic_cache<Key, Value, Policy, IndexPolicy, LockT, Hash, KeyEqual, Compare>::try_emplace(const Key& key, Args&&... args)
+	{
+		return tryEmplace(key, std::forward<Args>(args)...);
+	}
+
+	template<typename Key, typename Value, class Policy, class IndexPolicy, class LockT, class Hash, class KeyEqual, class Compare>
+	template<class... Args>
+	bool basic_cache<Key, Value, Policy, IndexPolicy, LockT, Hash, KeyEqual, Compare>::try_emplace(Key&& key, Args&&... args)
+	{
+		return tryEmplace(std::move(key), std::forward<Args>(args)...);
+	}
+
+	template<typename Key, typename Value, class Policy, class IndexPolicy, class LockT, class Hash, class KeyEqual, class Compare>
+	template<class V>
+	bool basic_cache<Key, Value, Policy, IndexPolicy, LockT, Hash, KeyEqual, Compare>::insert_or_assign(const Key& key, V&& value)
+	{
+		return insertImpl(key, std::forward<V>(value));
+	}
+
+	template<typename Key, typename Value, class Policy, class IndexPolicy, class LockT, class Hash, class KeyEqual, class Compare>
+	template<class V>
+	bool basic_cache<Key, Value, Policy, IndexPolicy, LockT, Hash, KeyEqual, Compare>::insert_or_assign(Key&& key, V&& value)
+	{
+		return insertImpl(std::move(key), std::forward<V>(value));
+	}
+
+	template<typename Key, typename Value, class Policy, class IndexPolicy, class LockT, class Hash, class KeyEqual, class Compare>
+	template<class InputIt>
+	void basic_cache<Key, Value, Policy, IndexPolicy, LockT, Hash, KeyEqual, Compare>::insert_many(InputIt first, InputIt last)
+	{
+		writeBack_.relieve(lockRef());
+		Graveyard dead;
+		Guard g(lockRef());
+		if (capacity_ == 0)
+			return;
+
+		for (; first != last; ++first)
+		{
+			auto&& entry = *first;
+			typename indexT::hint_type hint;
+			Node* found = index_.probe(entry.first, hint);
+			insertProbed(std::forward<decltype(entry)>(entry).first, found, hint,
+				std::forward<decltype(entry)>(entry).second);
+		}
+		collectRetired(dead);
+	}
+
+	template<typename Key, typename Value, class Policy, class IndexPolicy, class LockT, class Hash, class KeyEqual, class Compare>
+	Value& basic_cache<Key, Value, Policy, IndexPolicy, LockT, Hash, KeyEqual, Compare>::get(const Key& key)
+	{
+		// The lookup templates always accept Key itself when named explicitly
+		return get<Key, Key>(key);
+	}
+
+	template<typename Key, typename Value, class Policy, class IndexPolicy, class LockT, class Hash, class KeyEqual, class Compare>
+	template<class K, class>
+	Value& basic_cache<Key, Value, Policy, IndexPolicy, LockT, Hash, KeyEqual, Compare>::get(const K& key)
+	{
+		Guard g(lockRef());
+		Node* node = index_.find(key);
+		if (node == nullptr)
+		{
+			++stats_.misses;
+			throw KeyNotFound();
+		}
+		++stats_.hits;
+
+		touch(node);
+		if (refresh_.enabled())
+			refresh_.check(node);
+
+		return node->value;
+	}
+
+	template<typename Key, typename Value, class Policy, class IndexPolicy, class LockT, class Hash, class KeyEqual, class Compare>
+	template<class K, class>
+	Value& basic_cache<Key, Value, Policy, IndexPolicy, LockT, Hash, KeyEqual, Compare>::get(const K& key, std::size_t hash)
+	{
+		Guard g(lockRef());
+		Node* node = index_.find_hashed(key, hash);
+		if (node == nullptr)
+		{
+			++stats_.misses;
+			throw KeyNotFound();
+		}
+		++stats_.hits;
+
+		touch(node);
+		if (refresh_.enabled())
+			refresh_.check(node);
+
+		return node->value;
+	}
+
+	template<typename Key, typename Value, class Policy, class IndexPolicy, class LockT, class Hash, class KeyEqual, class Compare>
+	const Value& basic_cache<Key, Value, Policy, IndexPolicy, LockT, Hash, KeyEqual, Compare>::peek(const Key& key) const
+	{
+		return peek<Key, Key>(key);
+	}
+
+	template<typename Key, typename Value, class Policy, class IndexPolicy, class LockT, class Hash, class KeyEqual, class Compare>
+	template<class K, class>
+	const Value& basic_cache<Key, Value, Policy, IndexPolicy, LockT, Hash, KeyEqual, Compare>::peek(const K& key) const
+	{
+		Guard g(lockRef());
+		Node* node = index_.find(key);
+		if (node == nullptr)
+			throw KeyNotFound();
+
+		return node->value;
+	}
+
+	template<typename Key, typename Value, class Policy, class IndexPolicy, class LockT, class Hash, class KeyEqual, class Compare>
+	template<class K, class>
+	const Value& basic_cache<Key, Value, Policy, IndexPolicy, LockT, Hash, KeyEqual, Compare>::peek(const K& key, std::size_t hash) const
+	{
+		Guard g(lockRef());
+		Node* node = index_.find_hashed(key, hash);
+		if (node == nullptr)
+			throw KeyNotFound();
+
+		return node->value;
+	}
+
+	template<typename Key, typename Value, class Policy, class IndexPolicy, class LockT, class Hash, class KeyEqual, class Compare>
+	bool basic_cache<Key, Value, Policy, IndexPolicy, LockT, Hash, KeyEqual, Compare>::erase(const Key& key)
+	{
+		return erase<Key, Key>(key);
+	}
+
+	template<typename Key, typename Value, class Policy, class IndexPolicy, class LockT, class Hash, class KeyEqual, class Compare>
+	template<class K, class>
+	bool basic_cache<Key, Value, Policy, IndexPolicy, LockT, Hash, KeyEqual, Compare>::erase(const K& key)
+	{
+		Graveyard dead;
+		Guard g(lockRef());
+		Node* node = index_.find(key);
+		if (node == nullptr)
+			return false;
+
+		eraseFullNode(node);
+		collectRetired(dead);
+		return true;
+	}
+
+	template<typename Key, typename Value, class Policy, class IndexPolicy, class LockT, class Hash, class KeyEqual, class Compare>
+	template<class K, class>
+	bool basic_cache<Key, Value, Policy, IndexPolicy, LockT, Hash, KeyEqual, Compare>::erase(const K& key, std::size_t hash)
+	{
+		Graveyard dead;
+		Guard g(lockRef());
+		Node* node = index_.find_hashed(key, hash);
+		if (node == nullptr)
+			return false;
+
+		eraseFullNode(node);
+		collectRetired(dead);
+		return true;
+	}
+
+	template<typename Key, typename Value, class Policy, class IndexPolicy, class LockT, class Hash, class KeyEqual, class Compare>
+	void basic_cache<Key, Value, Policy, IndexPolicy, LockT, Hash, KeyEqual, Compare>::clear()
+	{
+		bool writeBack;
+		{
+			Graveyard dead;
+			Guard g(lockRef());
+			writeBack = writeBack_.enabled();
+			if (writeBack)
+				writeBack_.retire_all();
+
+			releaseAll();
+			collectRetired(dead);
+		}
+
+		if (writeBack)
+			writeBack_.flush_all(lockRef());
+	}
+
+	template<typename Key, typename Value, class Policy, class IndexPolicy, class LockT, class Hash, class KeyEqual, class Compare>
+	std::size_t basic_cache<Key, Value, Policy, IndexPolicy, LockT, Hash, KeyEqual, Compare>::invalidate_tag(tag_type tag)
+	{
+		Graveyard dead;
+		Guard g(lockRef());
+		std::size_t count = tags_.take(tag, [this](Node* node) { eraseFullNode(node); });
+		collectRetired(dead);
+		return count;
+	}
+
+	template<typename Key, typename Value, class Policy, class IndexPolicy, class LockT, class Hash, class KeyEqual, class Compare>
+	std::size_t basic_cache<Key, Value, Policy, IndexPolicy, LockT, Hash, KeyEqual, Compare>::tag_size(tag_type tag) const
+	{
+		Guard g(lockRef());
+		return tags_.size(tag);
+	}
+
+	template<typename Key, typename Value, class Policy, class IndexPolicy, class LockT, class Hash, class KeyEqual, class Compare>
+	std::size_t basic_cache<Key, Value, Policy, IndexPolicy, LockT, Hash, KeyEqual, Compare>::erase_range(const Key& lo, const Key& hi)
+	{
+		static_assert(!indexT::hashed, "Range operations need an ordered Key");
+		Graveyard dead;
+		Guard g(lockRef());
+		std::size_t count = index_.erase_range(lo, hi, [this](Node* node) { releaseNode(node); });
+		collectRetired(dead);
+		return count;
+	}
+
+	// prefix_compare<Key, Prefix> decides which keys start with the prefix
+	template<typename Key, typename Value, class Policy, class IndexPolicy, class LockT, class Hash, class KeyEqual, class Compare>
+	template<class Prefix>
+	std::size_t basic_cache<Key, Value, Policy, IndexPolicy, LockT, Hash, KeyEqual, Compare>::erase_prefix(const Prefix& prefix)
+	{
+		static_assert(!indexT::hashed, "Range operations need an ordered Key");
+		Graveyard dead;
+		Guard g(lockRef());
+		std::size_t count = index_.erase_prefix(prefix, [this](Node* node) { releaseNode(node); });
+		collectRetired(dead);
+		return count;
+	}
+
+	// fn(const Key&, Value&) runs under the lock and must not call back into the cache
+	template<typename Key, typename Value, class Policy, class IndexPolicy, class LockT, class Hash, class KeyEqual, class Compare>
+	template<class Fn>
+	void basic_cache<Key, Value, Policy, IndexPolicy, LockT, Hash, KeyEqual, Compare>::for_each_in_range(const Key& lo, const Key& hi, Fn fn)
+	{
+		static_assert(!indexT::hashed, "Range operations need an ordered Key");
+		Guard g(lockRef());
+		index_.for_range(lo, hi, [&fn](Node* node) { fn(static_cast<const Key&>(node->key), node->value); });
+	}
+
+	template<typename Key, typename Value, class Policy, class IndexPolicy, class LockT, class Hash, class KeyEqual, class Compare>
+	void basic_cache<Key, Value, Policy, IndexPolicy, LockT, Hash, KeyEqual, Compare>::set_capacity(std::size_t newCap)
+	{
+		{
+			Guard g(lockRef());
+			capacity_ = newCap;
+		}
+
+		// Shrink in bounded steps so other threads get the lock in between
+		bool shrinking = true;
+		while (shrinking)
+		{
+			Graveyard dead;
+			Guard g(lockRef());
+
+			for (std::size_t i = 0; i < shrink_step && evictable() > capacity_; ++i)
+				eraseFullNode(victim());
+
+			shrinking = evictable() > capacity_;
+			collectRetired(dead);
+		}
+	}
+
+	template<typename Key, typename Value, class Policy, class IndexPolicy, class LockT, class Hash, class KeyEqual, class Compare>
+	bool basic_cache<Key, Value, Policy, IndexPolicy, LockT, Hash, KeyEqual, Compare>::pin(const Key& key)
+	{
+		Guard g(lockRef());
+		Node* node = index_.find(key);
+		if (node == nullptr)
+			return false;
+
+		if (!node->pinned)
+			relink(node, node->cls, true);
+		return true;
+	}
+
+	template<typename Key, typename Value, class Policy, class IndexPolicy, class LockT, class Hash, class KeyEqual, class Compare>
+	bool basic_cache<Key, Value, Policy, IndexPolicy, LockT, Hash, KeyEqual, Compare>::unpin(const Key& key)
+	{
+		Graveyard dead;
+		Guard g(lockRef());
+		Node* node = index_.find(key);
+		if (node == nullptr)
+			return false;
+
+		if (node->pinned)
+		{
+			relink(node, node->cls, false);
+			while (evictable() > capacity_)
+			{
+				eraseFullNode(victim());
+				++stats_.evictions;
+			}
+		}
+		collectRetired(dead);
+		return true;
+	}
+
+	template<typename Key, typename Value, class Policy, class IndexPolicy, class LockT, class Hash, class KeyEqual, class Compare>
+	std::size_t basic_cache<Key, Value, Policy, IndexPolicy, LockT, Hash, KeyEqual, Compare>::pinned_count() const
+	{
+		Guard g(lockRef());
+		return pinnedCount_;
+	}
+
+	template<typename Key, typename Value, class Policy, class IndexPolicy, class LockT, class Hash, class KeyEqual, class Compare>
+	bool basic_cache<Key, Value, Policy, IndexPolicy, LockT, Hash, KeyEqual, Compare>::set_priority(const Key& key, priority cls)
+	{
+		Guard g(lockRef());
+		Node* node = index_.find(key);
+		if (node == nullptr)
+			return false;
+
+		relink(node, cls, node->pinned);
+		return true;
+	}
+
+	template<typename Key, typename Value, class Policy, class IndexPolicy, class LockT, class Hash, class KeyEqual, class Compare>
+	void basic_cache<Key, Value, Policy, IndexPolicy, LockT, Hash, KeyEqual, Compare>::enable_write_behind(write_sink<Key, Value> sink, write_behind_options opts)
+	{
+		Guard g(lockRef());
+		writeBack_.enable(std::move(sink), opts);
+	}
+
+	template<typename Key, typename Value, class Policy, class IndexPolicy, class LockT, class Hash, class KeyEqual, class Compare>
+	std::size_t basic_cache<Key, Value, Policy, IndexPolicy, LockT, Hash, KeyEqual, Compare>::flush()
+	{
+		return writeBack_.flush_all(lockRef());
+	}
+
+	template<typename Key, typename Value, class Policy, class IndexPolicy, class LockT, class Hash, class KeyEqual, class Compare>
+	std::size_t basic_cache<Key, Value, Policy, IndexPolicy, LockT, Hash, KeyEqual, Compare>::flush_expired()
+	{
+		return writeBack_.flush_expired(lockRef());
+	}
+
+	template<typename Key, typename Value, class Policy, class IndexPolicy, class LockT, class Hash, class KeyEqual, class Compare>
+	std::size_t basic_cache<Key, Value, Policy, IndexPolicy, LockT, Hash, KeyEqual, Compare>::dirty_count() const
+	{
+		return writeBack_.size();
+	}
+
+	template<typename Key, typename Value, class Policy, class IndexPolicy, class LockT, class Hash, class KeyEqual, class Compare>
+	void basic_cache<Key, Value, Policy, IndexPolicy, LockT, Hash, KeyEqual, Compare>::enable_refresh_ahead(refresh_loader<Key, Value> loader,
+		RefreshPool& pool, std::chrono::milliseconds refresh_after)
+	{
+		Guard g(lockRef());
+		refresh_.enable(std::move(loader), pool, refresh_after,
+			[this](const Key& key, std::uint64_t version, Value* fresh) { applyRefresh(key, version, fresh); });
+	}
+
+	template<typename Key, typename Value, class Policy, class IndexPolicy, class LockT, class Hash, class KeyEqual, class Compare>
+	void basic_cache<Key, Value, Policy, IndexPolicy, LockT, Hash, KeyEqual, Compare>::enable_negative_cache(negative_cache_options opts)
+	{
+		static_assert(has_hash<Key, Hash>::value, "Negative caching needs a hashable Key");
+		Guard g(lockRef());
+		negative_.reset(new select_negative_cache_t<Key, Hash, KeyEqual>(opts));
+	}
+
+	template<typename Key, typename Value, class Policy, class IndexPolicy, class LockT, class Hash, class KeyEqual, class Compare>
+	void basic_cache<Key, Value, Policy, IndexPolicy, LockT, Hash, KeyEqual, Compare>::insert_absent(const Key& key)
+	{
+		Graveyard dead;
+		Guard g(lockRef());
+		if (!negative_)
+			return;
+
+		if (Node* node = index_.find(key))
+			eraseFullNode(node);
+		negative_->record(key);
+		collectRetired(dead);
+	}
+
+	template<typename Key, typename Value, class Policy, class IndexPolicy, class LockT, class Hash, class KeyEqual, class Compare>
+	lookup_status basic_cache<Key, Value, Policy, IndexPolicy, LockT, Hash, KeyEqual, Compare>::lookup(const Key& key, Value& out)
+	{
+		Guard g(lockRef());
+		if (Node* node = index_.find(key))
+		{
+			++stats_.hits;
+			touch(node);
+			if (refresh_.enabled())
+				refresh_.check(node);
+			out = node->value;
+			return lookup_status::hit;
+		}
+
+		if (negative_ && negative_->absent(key))
+		{
+			++stats_.negative_hits;
+			return lookup_status::known_absent;
+		}
+		++stats_.misses;
+		return lookup_status::unknown;
+	}
+
+	template<typename Key, typename Value, class Policy, class IndexPolicy, class LockT, class Hash, class KeyEqual, class Compare>
+	void basic_cache<Key, Value, Policy, IndexPolicy, LockT, Hash, KeyEqual, Compare>::set_reclaim_mode(reclaim_mode mode)
+	{
+		Guard g(lockRef());
+		reclaimMode_ = mode;
+	}
+
+	template<typename Key, typename Value, class Policy, class IndexPolicy, class LockT, class Hash, class KeyEqual, class Compare>
+	std::size_t basic_cache<Key, Value, Policy, IndexPolicy, LockT, Hash, KeyEqual, Compare>::reclaim(std::size_t maxNodes)
+	{
+		Graveyard dead;
+		Guard g(lockRef());
+		std::size_t count = std::min(maxNodes, retiredCount_);
+		takeRetired(dead, count);
+		return count;
+	}
+
+	template<typename Key, typename Value, class Policy, class IndexPolicy, class LockT, class Hash, class KeyEqual, class Compare>
+	std::size_t basic_cache<Key, Value, Policy, IndexPolicy, LockT, Hash, KeyEqual, Compare>::pending_reclaim() const
+	{
+		Guard g(lockRef());
+		return retiredCount_;
+	}
+
+	template<typename Key, typename Value, class Policy, class IndexPolicy, class LockT, class Hash, class KeyEqual, class Compare>
+	bool basic_cache<Key, Value, Policy, IndexPolicy, LockT, Hash, KeyEqual, Compare>::contains(const Key &key) const
+	{
+		return contains<Key, Key>(key);
+	}
+
+	template<typename Key, typename Value, class Policy, class IndexPolicy, class LockT, class Hash, class KeyEqual, class Compare>
+	template<class K, class>
+	bool basic_cache<Key, Value, Policy, IndexPolicy, LockT, Hash, KeyEqual, Compare>::contains(const K& key) const
+	{
+		Guard g(lockRef());
+		return index_.find(key) != nullptr;
+	}
+
+	template<typename Key, typename Value, class Policy, class IndexPolicy, class LockT, class Hash, class KeyEqual, class Compare>
+	template<class K, class>
+	bool basic_cache<Key, Value, Policy, IndexPolicy, LockT, Hash, KeyEqual, Compare>::contains(const K& key, std::size_t hash) const
+	{
+		Guard g(lockRef());
+		return index_.find_hashed(key, hash) != nullptr;
+	}
+
+	template<typename Key, typename Value, class Policy, class IndexPolicy, class LockT, class Hash, class KeyEqual, class Compare>
+	bool basic_cache<Key, Value, Policy, IndexPolicy, LockT, Hash, KeyEqual, Compare>::empty() const
+	{
+		Guard g(lockRef());
+		return index_.empty();
+	}
+
+	template<typename Key, typename Value, class Policy, class IndexPolicy, class LockT, class Hash, class KeyEqual, class Compare>
+	std::size_t basic_cache<Key, Value, Policy, IndexPolicy, LockT, Hash, KeyEqual, Compare>::size() const
+	{
+		Guard g(lockRef());
+		return index_.size();
+	}
+
+	template<typename Key, typename Value, class Policy, class IndexPolicy, class LockT, class Hash, class KeyEqual, class Compare>
+	std::size_t basic_cache<Key, Value, Policy, IndexPolicy, LockT, Hash, KeyEqual, Compare>::capacity() const
+	{
+		Guard g(lockRef());
+		return capacity_;
+	}
+
+	template<typename Key, typename Value, class Policy, class IndexPolicy, class LockT, class Hash, class KeyEqual, class Compare>
+	bool basic_cache<Key, Value, Policy, IndexPolicy, LockT, Hash, KeyEqual, Compare>::full() const
+	{
+		Guard g(lockRef());
+		return evictable() >= capacity_;
+	}
+
+	template<typename Key, typename Value, class Policy, class IndexPolicy, class LockT, class Hash, class KeyEqual, class Compare>
+	Hash basic_cache<Key, Value, Policy, IndexPolicy, LockT, Hash, KeyEqual, Compare>::hash_function() const
+	{
+		static_assert(indexT::hashed, "Key is not hashable");
+		return index_.hash_function();
+	}
+
+	template<typename Key, typename Value, class Policy, class IndexPolicy, class LockT, class Hash, class KeyEqual, class Compare>
+	cache_stats basic_cache<Key, Value, Policy, IndexPolicy, LockT, Hash, KeyEqual, Compare>::stats() const
+	{
+		Guard g(lockRef());
+		return stats_;
+	}
+
+	// Read without taking the lock, so measuring does not disturb it
+	template<typename Key, typename Value, class Policy, class IndexPolicy, class LockT, class Hash, class KeyEqual, class Compare>
+	template<class L, class>
+	lock_stats basic_cache<Key, Value, Policy, IndexPolicy, LockT, Hash, KeyEqual, Compare>::contention() const
+	{
+		return lockRef().stats();
+	}
+
+	template<typename Key, typename Value, class Policy, class IndexPolicy, class LockT, class Hash, class KeyEqual, class Compare>
+	template<class P, class>
+	std::vector<hot_key<Key>> basic_cache<Key, Value, Policy, IndexPolicy, LockT, Hash, KeyEqual, Compare>::top_k(std::size_t k) const
+	{
+		Guard g(lockRef());
+		std::vector<hot_key<Key>> top;
+		top.reserve(std::min(k, index_.size()));
+		order_.top_k(k, top);
+		return top;
+	}
+
+	template<typename Key, typename Value, class Policy, class IndexPolicy, class LockT, class Hash, class KeyEqual, class Compare>
+	memory_stats basic_cache<Key, Value, Policy, IndexPolicy, LockT, Hash, KeyEqual, Compare>::memory_usage() const
+	{
+		Guard g(lockRef());
+		memory_stats stats;
+		stats.index_bytes = index_.memory_usage() + tags_.memory_usage() + writeBack_.memory_usage() + refresh_.memory_usage();
+		if (negative_)
+			stats.index_bytes += negative_->memory_usage();
+		stats.node_bytes  = (index_.size() + retiredCount_) * sizeof(Node) + order_.memory_usage();
+		stats.pinned_bytes = pinnedCount_ * sizeof(Node);
+		return stats;
+	}
+
+	// Walks every entry under the lock - meant for diagnostics, not hot paths
+	template<typename Key, typename Value, class Policy, class IndexPolicy, class LockT, class Hash, class KeyEqual, class Compare>
+	template<class ValueHeapBytes>
+	memory_stats basic_cache<Key, Value, Policy, IndexPolicy, LockT, Hash, KeyEqual, Compare>::memory_usage(ValueHeapBytes valueHeapBytes) const
+	{
+		Guard g(lockRef());
+		memory_stats stats;
+		stats.index_bytes = index_.memory_usage() + tags_.memory_usage() + writeBack_.memory_usage() + refresh_.memory_usage();
+		if (negative_)
+			stats.index_bytes += negative_->memory_usage();
+		stats.node_bytes  = (index_.size() + retiredCount_) * sizeof(Node) + order_.memory_usage();
+		stats.pinned_bytes = pinnedCount_ * sizeof(Node);
+
+		order_.for_each([&](const Node* node)
+		{
+			std::size_t bytes = valueHeapBytes(node->value);
+			stats.value_heap_bytes += bytes;
+			if (node->pinned)
+				stats.pinned_bytes += bytes;
+		});
+		return stats;
+	}
+
+	template<typename Key, typename Value, class Policy, class IndexPolicy, class LockT, class Hash, class KeyEqual, class Compare>
+	Value& basic_cache<Key, Value, Policy, IndexPolicy, LockT, Hash, KeyEqual, Compare>::operator[](const Key &key)
+	{
+		return get(key);
+	}
+
+	template<typename Key, typename Value, class Policy, class IndexPolicy, class LockT, class Hash, class KeyEqual, class Compare>
+	const Value& basic_cache<Key, Value, Policy, IndexPolicy, LockT, Hash, KeyEqual, Compare>::operator[](const Key &key) const
+	{
+		return peek(key);
+	}
+}
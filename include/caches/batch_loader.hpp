@@ -0,0 +1,323 @@
+#pragma once
+#include "caches/cache_utils.hpp"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <future>
+#include <iterator>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#if defined(__cpp_impl_coroutine) && __cpp_impl_coroutine >= 201902L
+#include <coroutine>
+#define CACHES_HAS_COROUTINES 1
+#else
+#define CACHES_HAS_COROUTINES 0
+#endif
+
+namespace cache
+{
+	// Read-through loading for a cache whose backend is cheaper in bulk.
+	// A miss does not call the backend itself: its key joins the next batch,
+	// which a loader thread dispatches once `window` has passed since the
+	// batch's first key or once it holds `max_batch` keys. A key that is
+	// already queued or loading is not asked for twice; its callers share one
+	// future. Loaded values go into the cache with one insert_many(), keys
+	// the backend left out are recorded with insert_absent() (which does
+	// nothing unless the cache has a negative cache) and fail with KeyNotFound.
+	template<typename Key, typename Value, class Cache,
+			 class Hash = std::hash<Key>, class KeyEqual = std::equal_to<Key>>
+	class BatchLoader
+	{
+		static_assert(has_hash<Key, Hash>::value, "BatchLoader needs a hashable Key");
+		static_assert(std::is_default_constructible<Value>::value, "BatchLoader reads the cache through lookup()");
+
+		using clock = std::chrono::steady_clock;
+
+		// Queued, or part of the batch being loaded
+		struct Pending
+		{
+			std::promise<Value> promise;
+			std::shared_future<Value> future;
+			std::vector<std::function<void()>> waiters;
+			bool loading = false;
+		};
+
+	public:
+		BatchLoader(Cache& cache, bulk_loader<Key, Value> loader, batch_loader_options opts = batch_loader_options());
+		// Loads whatever is still queued, without waiting out the window
+		~BatchLoader();
+
+		// Ready at once on a hit or a known-absent key (KeyNotFound)
+		std::shared_future<Value> get(const Key& key);
+
+#if CACHES_HAS_COROUTINES
+		// co_await loader.get_async(key): a miss suspends the coroutine, which
+		// is resumed on the loader thread once its batch is in
+		class Awaitable
+		{
+		public:
+			bool await_ready() const
+			{
+				return future_.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+			}
+
+			bool await_suspend(std::coroutine_handle<> handle)
+			{
+				return loader_.subscribe(key_, future_, [handle] { handle.resume(); });
+			}
+
+			Value await_resume()
+			{
+				return future_.get();
+			}
+
+		private:
+			friend class BatchLoader;
+
+			Awaitable(BatchLoader& loader, const Key& key, std::shared_future<Value> future)
+				: loader_(loader), key_(key), future_(std::move(future))
+			{ }
+
+			BatchLoader& loader_;
+			Key key_;
+			std::shared_future<Value> future_;
+		};
+
+		Awaitable get_async(const Key& key);
+#endif
+
+		// Keys queued or being loaded
+		std::size_t pending() const;
+		// Backend calls made so far
+		std::size_t batches() const;
+
+	private:
+		BatchLoader(const BatchLoader&) = delete;
+		BatchLoader& operator=(const BatchLoader&) = delete;
+
+		static std::shared_future<Value> failed(std::exception_ptr error);
+
+		bool subscribe(const Key& key, const std::shared_future<Value>& future, std::function<void()> resume);
+		void loop();
+		void load(std::vector<Key> keys);
+
+		Cache& cache_;
+		bulk_loader<Key, Value> loader_;
+		batch_loader_options opts_;
+
+		mutable std::mutex mutex_;
+		std::condition_variable wake_;
+		std::unordered_map<Key, Pending, Hash, KeyEqual> pending_;
+		std::vector<Key> queued_;   // the next batch, in arrival order
+		clock::time_point firstQueued_;
+		std::size_t batches_ = 0;
+		bool stop_ = false;
+		std::thread thread_;
+	};
+
+
+	template<typename Key, typename Value, class Cache, class Hash, class KeyEqual>
+	BatchLoader<Key, Value, Cache, Hash, KeyEqual>::BatchLoader(Cache& cache, bulk_loader<Key, Value> loader, batch_loader_options opts)
+		: cache_(cache), loader_(std::move(loader)), opts_(opts)
+	{
+		opts_.max_batch = std::max<std::size_t>(1, opts_.max_batch);
+		thread_ = std::thread(&BatchLoader::loop, this);
+	}
+
+	template<typename Key, typename Value, class Cache, class Hash, class KeyEqual>
+	BatchLoader<Key, Value, Cache, Hash, KeyEqual>::~BatchLoader()
+	{
+		{
+			std::lock_guard<std::mutex> g(mutex_);
+			stop_ = true;
+		}
+		wake_.notify_all();
+		thread_.join();
+	}
+
+	template<typename Key, typename Value, class Cache, class Hash, class KeyEqual>
+	std::shared_future<Value> BatchLoader<Key, Value, Cache, Hash, KeyEqual>::failed(std::exception_ptr error)
+	{
+		std::promise<Value> promise;
+		promise.set_exception(error);
+		return promise.get_future().share();
+	}
+
+	// A key loaded between the cache lookup and the queueing is simply loaded again
+	template<typename Key, typename Value, class Cache, class Hash, class KeyEqual>
+	std::shared_future<Value> BatchLoader<Key, Value, Cache, Hash, KeyEqual>::get(const Key& key)
+	{
+		Value value;
+		lookup_status status = cache_.lookup(key, value);
+		if (status == lookup_status::hit)
+		{
+			std::promise<Value> promise;
+			promise.set_value(std::move(value));
+			return promise.get_future().share();
+		}
+		if (status == lookup_status::known_absent)
+			return failed(std::make_exception_ptr(KeyNotFound()));
+
+		bool wake = false;
+		std::shared_future<Value> future;
+		{
+			std::lock_guard<std::mutex> g(mutex_);
+			auto iter = pending_.find(key);
+			if (iter != pending_.end())
+				return iter->second.future;
+
+			if (stop_)
+				return failed(std::make_exception_ptr(KeyNotFound()));
+
+			Pending& entry = pending_[key];
+			entry.future = entry.promise.get_future().share();
+			future = entry.future;
+
+			if (queued_.empty())
+				firstQueued_ = clock::now();
+			queued_.push_back(key);
+			wake = queued_.size() == 1 || queued_.size() >= opts_.max_batch;
+		}
+
+		if (wake)
+			wake_.notify_one();
+		return future;
+	}
+
+#if CACHES_HAS_COROUTINES
+	template<typename Key, typename Value, class Cache, class Hash, class KeyEqual>
+	typename BatchLoader<Key, Value, Cache, Hash, KeyEqual>::Awaitable BatchLoader<Key, Value, Cache, Hash, KeyEqual>::get_async(const Key& key)
+	{
+		return Awaitable(*this, key, get(key));
+	}
+#endif
+
+	// false if the future became ready meanwhile, so the caller need not suspend.
+	// Futures are fulfilled and their entries erased under the same lock.
+	template<typename Key, typename Value, class Cache, class Hash, class KeyEqual>
+	bool BatchLoader<Key, Value, Cache, Hash, KeyEqual>::subscribe(const Key& key, const std::shared_future<Value>& future, std::function<void()> resume)
+	{
+		std::lock_guard<std::mutex> g(mutex_);
+		if (future.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+			return false;
+
+		pending_.find(key)->second.waiters.push_back(std::move(resume));
+		return true;
+	}
+
+	template<typename Key, typename Value, class Cache, class Hash, class KeyEqual>
+	std::size_t BatchLoader<Key, Value, Cache, Hash, KeyEqual>::pending() const
+	{
+		std::lock_guard<std::mutex> g(mutex_);
+		return pending_.size();
+	}
+
+	template<typename Key, typename Value, class Cache, class Hash, class KeyEqual>
+	std::size_t BatchLoader<Key, Value, Cache, Hash, KeyEqual>::batches() const
+	{
+		std::lock_guard<std::mutex> g(mutex_);
+		return batches_;
+	}
+
+	template<typename Key, typename Value, class Cache, class Hash, class KeyEqual>
+	void BatchLoader<Key, Value, Cache, Hash, KeyEqual>::loop()
+	{
+		std::unique_lock<std::mutex> lk(mutex_);
+		for (;;)
+		{
+			wake_.wait(lk, [this] { return stop_ || !queued_.empty(); });
+			if (queued_.empty())
+				break;
+
+			wake_.wait_until(lk, firstQueued_ + opts_.window, [this]
+			{
+				return stop_ || queued_.size() >= opts_.max_batch;
+			});
+
+			// Whatever is over max_batch starts the next window
+			std::vector<Key> keys;
+			if (queued_.size() > opts_.max_batch)
+			{
+				keys.assign(queued_.begin(), queued_.begin() + opts_.max_batch);
+				queued_.erase(queued_.begin(), queued_.begin() + opts_.max_batch);
+				firstQueued_ = clock::now();
+			}
+			else
+				keys.swap(queued_);
+
+			for (const Key& key : keys)
+				pending_.find(key)->second.loading = true;
+			++batches_;
+
+			lk.unlock();
+			load(std::move(keys));
+			lk.lock();
+		}
+	}
+
+	template<typename Key, typename Value, class Cache, class Hash, class KeyEqual>
+	void BatchLoader<Key, Value, Cache, Hash, KeyEqual>::load(std::vector<Key> keys)
+	{
+		std::vector<std::pair<Key, Value>> loaded;
+		std::exception_ptr error;
+		try
+		{
+			loaded = loader_(keys);
+			cache_.insert_many(loaded.begin(), loaded.end());
+
+			// Recorded before the callers hear of it, so that a retry finds the absence
+			std::unordered_set<Key, Hash, KeyEqual> found;
+			for (const std::pair<Key, Value>& entry : loaded)
+				found.insert(entry.first);
+			for (const Key& key : keys)
+				if (found.count(key) == 0)
+					cache_.insert_absent(key);
+		}
+		catch (...)
+		{
+			error = std::current_exception();
+		}
+
+		std::vector<std::function<void()>> resume;
+		{
+			std::lock_guard<std::mutex> g(mutex_);
+
+			// Extra or repeated keys from the backend are ignored
+			if (!error)
+			{
+				for (std::pair<Key, Value>& entry : loaded)
+				{
+					auto iter = pending_.find(entry.first);
+					if (iter == pending_.end() || !iter->second.loading)
+						continue;
+
+					iter->second.promise.set_value(std::move(entry.second));
+					std::move(iter->second.waiters.begin(), iter->second.waiters.end(), std::back_inserter(resume));
+					pending_.erase(iter);
+				}
+			}
+
+			for (const Key& key : keys)
+			{
+				auto iter = pending_.find(key);
+				if (iter == pending_.end())
+					continue;
+
+				iter->second.promise.set_exception(error ? error : std::make_exception_ptr(KeyNotFound()));
+				std::move(iter->second.waiters.begin(), iter->second.waiters.end(), std::back_inserter(resume));
+				pending_.erase(iter);
+			}
+		}
+
+		for (std::function<void()>& fn : resume)
+			fn();
+	}
+}
@@ -0,0 +1,610 @@
+#pragma once
+#include "caches/cache_utils.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <set>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace cache
+{
+	// Chained hash table whose links live inside the cache nodes.
+	// The key is stored only once - in the node - and every bucket
+	// costs a single pointer, so the per-entry overhead is one
+	// pointer for the chain plus one bucket slot.
+	template<class Node, class Key, class Hash = std::hash<Key>, class KeyEqual = std::equal_to<Key>>
+	class HashIndex
+	{
+	public:
+		struct hook
+		{
+			Node* hnext = nullptr;
+		};
+
+		// Remembered between probe() and insert() so that a miss costs one hash
+		using hint_type = std::size_t;
+
+		static constexpr bool hashed = true;
+		static constexpr bool transparent = is_transparent<Hash>::value && is_transparent<KeyEqual>::value;
+
+		HashIndex() = default;
+
+		~HashIndex()
+		{
+			delete[] buckets_;
+		}
+
+		template<class K>
+		std::size_t hash(const K& key) const
+		{
+			return hash_(key);
+		}
+
+		template<class K>
+		Node* find(const K& key) const
+		{
+			return find_hashed(key, hash_(key));
+		}
+
+		template<class K>
+		Node* find_hashed(const K& key, std::size_t hash) const
+		{
+			if (size_ == 0)
+				return nullptr;
+
+			for (Node* n = buckets_[bucket(hash)]; n; n = n->hnext)
+			{
+				if (eq_(n->key, key))
+					return n;
+			}
+			return nullptr;
+		}
+
+		template<class K>
+		Node* probe(const K& key, hint_type& hint) const
+		{
+			hint = hash_(key);
+			return find_hashed(key, hint);
+		}
+
+		template<class K>
+		Node* probe_hashed(const K& key, std::size_t hash, hint_type& hint) const
+		{
+			hint = hash;
+			return find_hashed(key, hint);
+		}
+
+		Hash hash_function() const
+		{
+			return hash_;
+		}
+
+		void insert(Node* node, hint_type hint)
+		{
+			if (size_ >= bucketCount_)
+				grow();
+
+			Node*& head = buckets_[bucket(hint)];
+			node->hnext = head;
+			head = node;
+			++size_;
+		}
+
+		void erase(Node* node)
+		{
+			Node** link = &buckets_[bucket(hash_(node->key))];
+			while (*link != node)
+				link = &(*link)->hnext;
+
+			*link = node->hnext;
+			--size_;
+		}
+
+		void erase(Node* node, hint_type&)
+		{
+			erase(node);
+		}
+
+		void clear()
+		{
+			std::fill(buckets_, buckets_ + bucketCount_, nullptr);
+			size_ = 0;
+		}
+
+		std::size_t size() const
+		{
+			return size_;
+		}
+
+		bool empty() const
+		{
+			return size_ == 0;
+		}
+
+		std::size_t memory_usage() const
+		{
+			return bucketCount_ * sizeof(Node*);
+		}
+
+	private:
+		HashIndex(const HashIndex&) = delete;
+		HashIndex& operator=(const HashIndex&) = delete;
+
+		// Fibonacci hashing: spreads identity hashes (std::hash<int>) over the table
+		std::size_t bucket(std::size_t hash) const
+		{
+			return static_cast<std::size_t>((static_cast<std::uint64_t>(hash) * 0x9E3779B97F4A7C15ull) >> shift_);
+		}
+
+		void grow()
+		{
+			std::size_t oldCount = bucketCount_;
+			Node** oldBuckets = buckets_;
+
+			bucketCount_ = oldCount == 0 ? 8 : oldCount * 2;
+			buckets_ = new Node*[bucketCount_]();
+			shift_ = oldCount == 0 ? 61 : shift_ - 1;
+
+			for (std::size_t i = 0; i < oldCount; ++i)
+			{
+				Node* n = oldBuckets[i];
+				while (n)
+				{
+					Node* next = n->hnext;
+					Node*& head = buckets_[bucket(hash_(n->key))];
+					n->hnext = head;
+					head = n;
+					n = next;
+				}
+			}
+			delete[] oldBuckets;
+		}
+
+		Node** buckets_ = nullptr;
+		std::size_t bucketCount_ = 0;
+		std::size_t size_ = 0;
+		unsigned shift_ = 64;
+		Hash hash_;
+		KeyEqual eq_;
+	};
+
+	// Open-addressing table for integral keys (see is_integer_key).
+	// Slots hold the key inline next to the node pointer, so a probe never
+	// touches the node; a null pointer marks an empty slot, which leaves every
+	// key value usable. Linear probing with backward-shift deletion keeps runs
+	// short without tombstones, and nodes need no hook at all.
+	template<class Node, class Key, class Hash = std::hash<Key>>
+	class IntegerIndex
+	{
+		struct Slot
+		{
+			Key key;
+			Node* node;
+		};
+
+		static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+	public:
+		struct hook
+		{ };
+
+		// The hash, plus the empty slot the probe ended on while it is still valid
+		struct hint_type
+		{
+			std::size_t hash = 0;
+			std::size_t slot = npos;
+		};
+
+		static constexpr bool hashed = true;
+		static constexpr bool transparent = false;
+
+		IntegerIndex() = default;
+
+		~IntegerIndex()
+		{
+			delete[] slots_;
+		}
+
+		std::size_t hash(const Key& key) const
+		{
+			return hash_(key);
+		}
+
+		Node* find(const Key& key) const
+		{
+			return find_hashed(key, hash_(key));
+		}
+
+		Node* find_hashed(const Key& key, std::size_t hash) const
+		{
+			if (size_ == 0)
+				return nullptr;
+
+			std::size_t i = home(hash);
+			while (slots_[i].node && slots_[i].key != key)
+				i = (i + 1) & mask_;
+			return slots_[i].node;
+		}
+
+		Node* probe(const Key& key, hint_type& hint) const
+		{
+			return probe_hashed(key, hash_(key), hint);
+		}
+
+		Node* probe_hashed(const Key& key, std::size_t hash, hint_type& hint) const
+		{
+			hint.hash = hash;
+			hint.slot = npos;
+			if (size_ == 0)
+				return nullptr;
+
+			std::size_t i = home(hash);
+			while (slots_[i].node && slots_[i].key != key)
+				i = (i + 1) & mask_;
+
+			if (slots_[i].node == nullptr)
+				hint.slot = i;
+			return slots_[i].node;
+		}
+
+		Hash hash_function() const
+		{
+			return hash_;
+		}
+
+		void insert(Node* node, hint_type hint)
+		{
+			if ((size_ + 1) * 4 > capacity_ * 3)
+			{
+				grow();
+				hint.slot = npos;
+			}
+
+			std::size_t i = hint.slot;
+			if (i == npos)
+				i = freeSlot(hint.hash);
+
+			slots_[i].key = node->key;
+			slots_[i].node = node;
+			++size_;
+		}
+
+		void erase(Node* node)
+		{
+			std::size_t i = home(hash_(node->key));
+			while (slots_[i].node != node)
+				i = (i + 1) & mask_;
+
+			// Pulls back every later entry of the run that may live in the hole
+			for (std::size_t j = (i + 1) & mask_; slots_[j].node; j = (j + 1) & mask_)
+			{
+				std::size_t want = home(hash_(slots_[j].key));
+				if (((j - want) & mask_) >= ((j - i) & mask_))
+				{
+					slots_[i] = slots_[j];
+					i = j;
+				}
+			}
+			slots_[i].node = nullptr;
+			--size_;
+		}
+
+		// Shifting entries back may open a hole before the remembered slot
+		void erase(Node* node, hint_type& hint)
+		{
+			erase(node);
+			hint.slot = npos;
+		}
+
+		void clear()
+		{
+			for (std::size_t i = 0; i < capacity_; ++i)
+				slots_[i].node = nullptr;
+			size_ = 0;
+		}
+
+		std::size_t size() const
+		{
+			return size_;
+		}
+
+		bool empty() const
+		{
+			return size_ == 0;
+		}
+
+		std::size_t memory_usage() const
+		{
+			return capacity_ * sizeof(Slot);
+		}
+
+	private:
+		IntegerIndex(const IntegerIndex&) = delete;
+		IntegerIndex& operator=(const IntegerIndex&) = delete;
+
+		// Folds the high half in before the Fibonacci multiply, so keys that
+		// differ only in their upper bits still land apart
+		std::size_t home(std::size_t hash) const
+		{
+			std::uint64_t h = static_cast<std::uint64_t>(hash);
+			h ^= h >> 32;
+			return static_cast<std::size_t>((h * 0x9E3779B97F4A7C15ull) >> shift_);
+		}
+
+		std::size_t freeSlot(std::size_t hash) const
+		{
+			std::size_t i = home(hash);
+			while (slots_[i].node)
+				i = (i + 1) & mask_;
+			return i;
+		}
+
+		void grow()
+		{
+			std::size_t oldCapacity = capacity_;
+			Slot* oldSlots = slots_;
+
+			capacity_ = oldCapacity == 0 ? 16 : oldCapacity * 2;
+			mask_ = capacity_ - 1;
+			shift_ = oldCapacity == 0 ? 60 : shift_ - 1;
+			slots_ = new Slot[capacity_]();
+
+			for (std::size_t i = 0; i < oldCapacity; ++i)
+			{
+				if (oldSlots[i].node)
+					slots_[freeSlot(hash_(oldSlots[i].key))] = oldSlots[i];
+			}
+			delete[] oldSlots;
+		}
+
+		Slot* slots_ = nullptr;
+		std::size_t capacity_ = 0;
+		std::size_t mask_ = 0;
+		std::size_t size_ = 0;
+		unsigned shift_ = 64;
+		Hash hash_;
+	};
+
+	// Customization point for erase_prefix(): compare(key, prefix) is negative
+	// when key sorts before every key starting with prefix, zero when it starts
+	// with it and positive after. Must agree with the cache's Compare.
+	template<class Key, class Prefix, class = void>
+	struct prefix_compare;
+
+	namespace detail
+	{
+		template<std::size_t I, std::size_t N>
+		struct tuple_prefix
+		{
+			template<class K, class P>
+			static int compare(const K& key, const P& prefix)
+			{
+				if (std::get<I>(key) < std::get<I>(prefix))
+					return -1;
+				if (std::get<I>(prefix) < std::get<I>(key))
+					return 1;
+				return tuple_prefix<I + 1, N>::compare(key, prefix);
+			}
+		};
+
+		template<std::size_t N>
+		struct tuple_prefix<N, N>
+		{
+			template<class K, class P>
+			static int compare(const K&, const P&)
+			{
+				return 0;
+			}
+		};
+	}
+
+	// (tenant, object, version) keys: any shorter tuple of leading elements is a prefix
+	template<class... Ts, class... Ps>
+	struct prefix_compare<std::tuple<Ts...>, std::tuple<Ps...>, std::enable_if_t<(sizeof...(Ps) <= sizeof...(Ts))>>
+	{
+		static int compare(const std::tuple<Ts...>& key, const std::tuple<Ps...>& prefix)
+		{
+			return detail::tuple_prefix<0, sizeof...(Ps)>::compare(key, prefix);
+		}
+	};
+
+	template<class A, class B, class P>
+	struct prefix_compare<std::pair<A, B>, P, std::enable_if_t<std::is_convertible<const P&, const A&>::value>>
+	{
+		static int compare(const std::pair<A, B>& key, const P& prefix)
+		{
+			if (key.first < prefix)
+				return -1;
+			return prefix < key.first ? 1 : 0;
+		}
+	};
+
+	template<class Prefix>
+	struct prefix_probe
+	{
+		const Prefix& prefix;
+	};
+
+	// Ordered index for keys that are only less-comparable.
+	// The tree holds node pointers and compares through them, so the key
+	// is not duplicated into the tree node.
+	template<class Node, class Key, class Compare = std::less<Key>>
+	class OrderedIndex
+	{
+		struct NodeLess
+		{
+			using is_transparent = void;
+
+			static const Key& keyOf(Node* n)
+			{
+				return n->key;
+			}
+
+			template<class K>
+			static const K& keyOf(const K& key)
+			{
+				return key;
+			}
+
+			template<class A, class B>
+			bool operator()(const A& a, const B& b) const
+			{
+				return comp(keyOf(a), keyOf(b));
+			}
+
+			// Every key with the prefix is "equal" to the probe, so they form one range
+			template<class P>
+			bool operator()(Node* const& n, const prefix_probe<P>& p) const
+			{
+				return prefix_compare<Key, P>::compare(n->key, p.prefix) < 0;
+			}
+
+			template<class P>
+			bool operator()(const prefix_probe<P>& p, Node* const& n) const
+			{
+				return prefix_compare<Key, P>::compare(n->key, p.prefix) > 0;
+			}
+
+			Compare comp;
+		};
+
+		using setT = std::set<Node*, NodeLess>;
+
+	public:
+		struct hook
+		{ };
+
+		using hint_type = typename setT::const_iterator;
+
+		static constexpr bool hashed = false;
+		static constexpr bool transparent = is_transparent<Compare>::value;
+
+		template<class K>
+		Node* find(const K& key) const
+		{
+			auto iter = set_.find(key);
+			return iter == set_.end() ? nullptr : *iter;
+		}
+
+		template<class K>
+		Node* probe(const K& key, hint_type& hint) const
+		{
+			hint = set_.lower_bound(key);
+			if (hint != set_.end() && !set_.key_comp()(key, *hint))
+				return *hint;
+			return nullptr;
+		}
+
+		void insert(Node* node, hint_type hint)
+		{
+			set_.emplace_hint(hint, node);
+		}
+
+		void erase(Node* node)
+		{
+			set_.erase(node);
+		}
+
+		// Keeps a pending insert hint valid when the erased node is the one it points at
+		void erase(Node* node, hint_type& hint)
+		{
+			if (hint != set_.end() && *hint == node)
+				hint = set_.erase(hint);
+			else
+				set_.erase(node);
+		}
+
+		// Visits [lo, hi) in key order
+		template<class Fn>
+		void for_range(const Key& lo, const Key& hi, Fn fn) const
+		{
+			if (!set_.key_comp()(lo, hi))
+				return;
+
+			for (auto iter = set_.lower_bound(lo), last = set_.lower_bound(hi); iter != last; ++iter)
+				fn(*iter);
+		}
+
+		// Unlinks [lo, hi) in O(log n + k), handing every node to onErase
+		template<class Fn>
+		std::size_t erase_range(const Key& lo, const Key& hi, Fn onErase)
+		{
+			if (!set_.key_comp()(lo, hi))
+				return 0;
+			return eraseSpan(set_.lower_bound(lo), set_.lower_bound(hi), onErase);
+		}
+
+		template<class P, class Fn>
+		std::size_t erase_prefix(const P& prefix, Fn onErase)
+		{
+			auto span = set_.equal_range(prefix_probe<P>{ prefix });
+			return eraseSpan(span.first, span.second, onErase);
+		}
+
+		void clear()
+		{
+			set_.clear();
+		}
+
+		std::size_t size() const
+		{
+			return set_.size();
+		}
+
+		bool empty() const
+		{
+			return set_.empty();
+		}
+
+		// Red-black tree node: colour + three links + the stored pointer
+		std::size_t memory_usage() const
+		{
+			return set_.size() * (4 * sizeof(void*) + sizeof(Node*));
+		}
+
+	private:
+		template<class Fn>
+		std::size_t eraseSpan(hint_type first, hint_type last, Fn onErase)
+		{
+			std::size_t count = 0;
+			for (auto iter = first; iter != last; ++iter, ++count)
+				onErase(*iter);
+
+			set_.erase(first, last);
+			return count;
+		}
+
+		setT set_;
+	};
+
+	template<class Node, class Key, class Hash = std::hash<Key>,
+			 class KeyEqual = std::equal_to<Key>, class Compare = std::less<Key>>
+	using select_index_t = std::conditional_t<is_integer_key<Key, Hash, KeyEqual>::value,
+								IntegerIndex<Node, Key, Hash>,
+							std::conditional_t<has_hash<Key, Hash>::value,
+								HashIndex<Node, Key, Hash, KeyEqual>,
+								OrderedIndex<Node, Key, Compare>>>;
+
+	// Index policies for basic_cache. auto_index takes select_index_t's
+	// choice; the others force one, e.g. ordered_index gives a hashable Key
+	// the range operations.
+	struct auto_index
+	{
+		template<class Node, class Key, class Hash, class KeyEqual, class Compare>
+		using index = select_index_t<Node, Key, Hash, KeyEqual, Compare>;
+	};
+
+	struct hash_index
+	{
+		template<class Node, class Key, class Hash, class KeyEqual, class Compare>
+		using index = HashIndex<Node, Key, Hash, KeyEqual>;
+	};
+
+	struct ordered_index
+	{
+		template<class Node, class Key, class Hash, class KeyEqual, class Compare>
+		using index = OrderedIndex<Node, Key, Compare>;
+	};
+}
@@ -0,0 +1,309 @@
+#pragma once
+#include "caches/cache_utils.hpp"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace cache
+{
+	enum class budget_unit
+	{
+		entries,
+		bytes   // as reported by memory_usage(): index + nodes, without value heap
+	};
+
+	struct managed_cache_report
+	{
+		const void* cache;
+		std::size_t share;     // granted part of the budget, in budget units
+		std::size_t capacity;  // resulting capacity in entries
+		std::size_t size;
+		double utility;        // capacity misses per unit of share in the last round
+	};
+
+	// Owns one process-wide budget and splits it between attached caches.
+	// Every rebalance() estimates how much each cache would gain from more
+	// room - misses it could have avoided, bounded by what it had to evict -
+	// and moves a step of the budget from the cache that gains least to the
+	// one that gains most. Hysteresis and a cooldown keep it from oscillating.
+	class CacheManager
+	{
+	public:
+		struct options
+		{
+			double step = 0.05;          // fraction of the budget moved per rebalance
+			double hysteresis = 0.25;    // receiver must beat the donor by this factor
+			unsigned cooldown = 2;       // rounds a cache sits out after a transfer
+			std::size_t min_share = 1;   // no cache is shrunk below this many units
+			std::size_t entry_bytes = 64; // bytes per entry assumed for an empty cache
+		};
+
+		explicit CacheManager(std::size_t budget, budget_unit unit = budget_unit::entries);
+		CacheManager(std::size_t budget, budget_unit unit, options opts);
+		~CacheManager();
+
+		// The cache keeps its capacity if the budget allows; detach before destroying it
+		template<class Cache>
+		void attach(Cache& cache);
+		template<class Cache>
+		void detach(Cache& cache);
+
+		void rebalance();
+		void start(std::chrono::milliseconds period);
+		void stop();
+
+		std::size_t budget() const;
+		std::size_t granted() const;
+		std::vector<managed_cache_report> report() const;
+
+	private:
+		CacheManager(const CacheManager&) = delete;
+		CacheManager& operator=(const CacheManager&) = delete;
+
+		struct Managed
+		{
+			const void* id;
+			std::function<cache_stats()> stats;
+			std::function<std::size_t()> size;
+			std::function<std::size_t()> bytes;
+			std::function<void(std::size_t)> setCapacity;
+
+			std::size_t share;
+			std::size_t lastUsed;
+			cache_stats last;
+			double utility;
+			unsigned cooldown;
+		};
+
+		std::size_t bytesPerEntry(const Managed& m) const;
+		std::size_t toEntries(const Managed& m, std::size_t units) const;
+		std::size_t usedUnits(const Managed& m) const;
+		void applyShare(Managed& m, std::size_t share);
+		void loop(std::chrono::milliseconds period);
+
+		std::size_t budget_;
+		budget_unit unit_;
+		options opts_;
+		std::size_t granted_;
+		std::vector<Managed> caches_;
+
+		mutable std::mutex mutex_;
+		std::condition_variable wake_;
+		bool running_;
+		std::thread thread_;
+	};
+
+
+	inline CacheManager::CacheManager(std::size_t budget, budget_unit unit)
+		: CacheManager(budget, unit, options())
+	{ }
+
+	inline CacheManager::CacheManager(std::size_t budget, budget_unit unit, options opts)
+		: budget_(budget), unit_(unit), opts_(opts), granted_(0), running_(false)
+	{ }
+
+	inline CacheManager::~CacheManager()
+	{
+		stop();
+	}
+
+	template<class Cache>
+	void CacheManager::attach(Cache& cache)
+	{
+		std::lock_guard<std::mutex> g(mutex_);
+
+		Managed m;
+		m.id          = &cache;
+		m.stats       = [&cache] { return cache.stats(); };
+		m.size        = [&cache] { return cache.size(); };
+		m.bytes       = [&cache] { return cache.memory_usage().total(); };
+		m.setCapacity = [&cache](std::size_t n) { cache.set_capacity(n); };
+		m.share       = 0;
+		m.lastUsed    = 0;
+		m.last        = cache.stats();
+		m.utility     = 0;
+		m.cooldown    = 0;
+
+		std::size_t wanted = cache.capacity();
+		if (unit_ == budget_unit::bytes)
+			wanted *= bytesPerEntry(m);
+
+		std::size_t share = std::min(wanted, budget_ - granted_);
+		if (share < opts_.min_share)
+		{
+			// Budget exhausted: the largest share pays for the newcomer's minimum
+			auto richest = std::max_element(caches_.begin(), caches_.end(),
+				[](const Managed& a, const Managed& b) { return a.share < b.share; });
+			std::size_t need = opts_.min_share - share;
+			if (richest != caches_.end() && richest->share >= need + opts_.min_share)
+				applyShare(*richest, richest->share - need);
+			share = std::min(opts_.min_share, budget_ - granted_);
+		}
+
+		caches_.push_back(m);
+		applyShare(caches_.back(), share);
+	}
+
+	template<class Cache>
+	void CacheManager::detach(Cache& cache)
+	{
+		std::lock_guard<std::mutex> g(mutex_);
+		for (auto it = caches_.begin(); it != caches_.end(); ++it)
+		{
+			if (it->id == &cache)
+			{
+				granted_ -= it->share;
+				caches_.erase(it);
+				return;
+			}
+		}
+	}
+
+	inline std::size_t CacheManager::bytesPerEntry(const Managed& m) const
+	{
+		std::size_t n = m.size();
+		if (n == 0)
+			return opts_.entry_bytes;
+		return std::max<std::size_t>(1, m.bytes() / n);
+	}
+
+	inline std::size_t CacheManager::toEntries(const Managed& m, std::size_t units) const
+	{
+		return unit_ == budget_unit::entries ? units : units / bytesPerEntry(m);
+	}
+
+	inline std::size_t CacheManager::usedUnits(const Managed& m) const
+	{
+		return unit_ == budget_unit::entries ? m.size() : m.bytes();
+	}
+
+	inline void CacheManager::applyShare(Managed& m, std::size_t share)
+	{
+		granted_ = granted_ - m.share + share;
+		m.share = share;
+		m.setCapacity(toEntries(m, share));
+	}
+
+	inline void CacheManager::rebalance()
+	{
+		std::lock_guard<std::mutex> g(mutex_);
+		if (caches_.empty())
+			return;
+
+		const std::size_t step = std::max<std::size_t>(1, static_cast<std::size_t>(budget_ * opts_.step));
+
+		for (Managed& m : caches_)
+		{
+			cache_stats now = m.stats();
+			std::size_t misses    = now.misses - m.last.misses;
+			std::size_t evictions = now.evictions - m.last.evictions;
+			m.last = now;
+
+			// Only misses on keys the cache had to evict could turn into hits with more room
+			std::size_t capacityMisses = m.share == 0 ? misses : std::min(misses, evictions);
+			m.utility = static_cast<double>(capacityMisses) / std::max<std::size_t>(1, m.share);
+
+			if (m.cooldown > 0)
+				--m.cooldown;
+
+			// Hand back room a cache has stopped growing into, a step at a time
+			std::size_t used = usedUnits(m);
+			std::size_t keep = std::max(opts_.min_share, used + used / 4);
+			if (evictions == 0 && used <= m.lastUsed && used < m.share / 2 && keep < m.share && m.cooldown == 0)
+				applyShare(m, m.share - std::min(step, m.share - keep));
+			m.lastUsed = used;
+		}
+
+		auto byUtility = [](const Managed& a, const Managed& b) { return a.utility < b.utility; };
+		Managed* receiver = &*std::max_element(caches_.begin(), caches_.end(), byUtility);
+		if (receiver->utility <= 0 || receiver->cooldown > 0)
+			return;
+
+		std::size_t freeUnits = budget_ - granted_;
+		if (freeUnits > 0)
+		{
+			applyShare(*receiver, receiver->share + std::min(step, freeUnits));
+			receiver->cooldown = opts_.cooldown;
+			return;
+		}
+
+		Managed* donor = nullptr;
+		for (Managed& m : caches_)
+		{
+			if (&m == receiver || m.cooldown > 0 || m.share <= opts_.min_share)
+				continue;
+			if (donor == nullptr || m.utility < donor->utility)
+				donor = &m;
+		}
+
+		if (donor == nullptr || receiver->utility <= donor->utility * (1 + opts_.hysteresis))
+			return;
+
+		std::size_t moved = std::min(step, donor->share - opts_.min_share);
+		applyShare(*donor, donor->share - moved);
+		applyShare(*receiver, receiver->share + moved);
+		donor->cooldown = receiver->cooldown = opts_.cooldown;
+	}
+
+	inline void CacheManager::start(std::chrono::milliseconds period)
+	{
+		std::lock_guard<std::mutex> g(mutex_);
+		if (running_)
+			return;
+
+		running_ = true;
+		thread_ = std::thread(&CacheManager::loop, this, period);
+	}
+
+	inline void CacheManager::stop()
+	{
+		{
+			std::lock_guard<std::mutex> g(mutex_);
+			if (!running_)
+				return;
+			running_ = false;
+		}
+		wake_.notify_one();
+		thread_.join();
+	}
+
+	inline void CacheManager::loop(std::chrono::milliseconds period)
+	{
+		std::unique_lock<std::mutex> lk(mutex_);
+		while (running_)
+		{
+			if (wake_.wait_for(lk, period, [this] { return !running_; }))
+				break;
+
+			lk.unlock();
+			rebalance();
+			lk.lock();
+		}
+	}
+
+	inline std::size_t CacheManager::budget() const
+	{
+		return budget_;
+	}
+
+	inline std::size_t CacheManager::granted() const
+	{
+		std::lock_guard<std::mutex> g(mutex_);
+		return granted_;
+	}
+
+	inline std::vector<managed_cache_report> CacheManager::report() const
+	{
+		std::lock_guard<std::mutex> g(mutex_);
+
+		std::vector<managed_cache_report> out;
+		out.reserve(caches_.size());
+		for (const Managed& m : caches_)
+			out.push_back(managed_cache_report{ m.id, m.share, toEntries(m, m.share), m.size(), m.utility });
+		return out;
+	}
+}
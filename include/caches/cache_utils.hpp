@@ -1,6 +1,13 @@
 #pragma once
 #include <stdexcept>
+#include <chrono>
 #include <functional>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 namespace cache
 {
@@ -12,6 +19,168 @@ namespace cache
 		{ }
 	};
 
+	struct memory_stats
+	{
+		std::size_t index_bytes = 0;      // lookup structure (buckets / tree nodes)
+		std::size_t node_bytes = 0;       // entries with their keys and values inline
+		std::size_t value_heap_bytes = 0; // reported by the user callback, if any
+		std::size_t pinned_bytes = 0;     // share of the above held by pinned entries
+
+		std::size_t total() const
+		{
+			return index_bytes + node_bytes + value_heap_bytes;
+		}
+	};
+
+	// Counted by get() and by evictions on insert; never reset
+	struct cache_stats
+	{
+		std::size_t hits = 0;
+		std::size_t misses = 0;
+		std::size_t evictions = 0;
+		std::size_t negative_hits = 0;  // lookup() answered known_absent
+	};
+
+	// Where a NearCache read was answered: a thread's own L1, the shared L2, or neither
+	struct near_cache_stats
+	{
+		std::size_t l1_hits = 0;
+		std::size_t l2_hits = 0;
+		std::size_t misses = 0;
+	};
+
+	// What an InstrumentedLock saw since it was created
+	struct lock_stats
+	{
+		std::size_t acquisitions = 0;
+		std::size_t contended = 0;             // acquisitions that found the lock taken
+		std::chrono::nanoseconds wait{ 0 };     // summed over the contended acquisitions
+		std::chrono::nanoseconds max_wait{ 0 };
+		std::chrono::nanoseconds hold{ 0 };     // summed over every acquisition
+	};
+
+	// What lookup() found: the value, a key recorded as absent upstream, or nothing
+	enum class lookup_status
+	{
+		hit,
+		known_absent,
+		unknown
+	};
+
+	struct negative_cache_options
+	{
+		std::size_t exact = 1024;          // most recent absent keys, remembered exactly
+		std::size_t filter_keys = 65536;   // older absent keys, as 16-bit fingerprints
+		std::chrono::milliseconds ttl{ 60000 }; // how long an absent key is believed
+	};
+
+	// Eviction classes: low entries are evicted before normal ones, normal
+	// before high. Each class is its own segment, so eviction stays O(1).
+	enum class priority : std::uint8_t
+	{
+		low,
+		normal,
+		high
+	};
+
+	constexpr std::size_t priority_classes = 3;
+
+	// What a miss on an entry costs to recompute (any unit, e.g. milliseconds)
+	// and how much of a size-aware cache's capacity it takes (see GDSF)
+	struct miss_cost
+	{
+		double cost;
+		std::size_t size;
+
+		miss_cost(double cost = 1.0, std::size_t size = 1)
+			: cost(cost), size(size)
+		{ }
+	};
+
+	// Tags name the upstream objects an entry was derived from, e.g. an id or a hash
+	using tag_type = std::uint64_t;
+
+	// Passed at insert/emplace time; see invalidate_tag()
+	struct tag_list
+	{
+		explicit tag_list(std::initializer_list<tag_type> tags)
+			: tags(tags)
+		{ }
+
+		const tag_type* begin() const
+		{
+			return tags.begin();
+		}
+
+		const tag_type* end() const
+		{
+			return tags.end();
+		}
+
+		std::initializer_list<tag_type> tags;
+	};
+
+	// One entry of a hot-key report: the key and how often it was seen
+	template<typename Key>
+	struct hot_key
+	{
+		Key key;
+		std::size_t count;
+	};
+
+	// One point of a miss-ratio curve: the predicted LRU miss ratio at a capacity
+	struct mrc_point
+	{
+		std::size_t capacity;
+		double miss_ratio;
+	};
+
+	// What a write-behind sink receives: keys with their latest values, oldest write first
+	template<typename Key, typename Value>
+	using write_batch = std::vector<std::pair<Key, Value>>;
+
+	// Called with no cache lock held and one batch at a time; must not call back into the cache
+	template<typename Key, typename Value>
+	using write_sink = std::function<void(const write_batch<Key, Value>&)>;
+
+	// Reloads one key for refresh-ahead; runs on a RefreshPool thread with no
+	// cache lock held and may throw to keep the current value
+	template<typename Key, typename Value>
+	using refresh_loader = std::function<Value(const Key&)>;
+
+	// Loads many keys in one backend call, with no cache lock held; keys left
+	// out of the result are taken as absent, and throwing fails the whole batch
+	template<typename Key, typename Value>
+	using bulk_loader = std::function<std::vector<std::pair<Key, Value>>(const std::vector<Key>&)>;
+
+	struct batch_loader_options
+	{
+		std::size_t max_batch = 128;              // a batch this large is dispatched at once
+		std::chrono::microseconds window{ 1000 }; // how long a batch's first miss waits for company
+	};
+
+	struct write_behind_options
+	{
+		std::size_t batch = 256;          // entries per sink call
+		std::size_t max_dirty = 4096;     // beyond this, inserting threads flush first
+		std::chrono::milliseconds max_staleness{ 100 }; // flush_expired() writes entries dirty this long
+	};
+
+	// Who destroys entries removed by eviction, erase, clear and set_capacity.
+	// immediate: the calling thread, right after it releases the lock.
+	// deferred:  reclaim() (e.g. from a Reclaimer thread); every mutating call
+	//            also frees a small bounded chunk so garbage cannot pile up.
+	enum class reclaim_mode
+	{
+		immediate,
+		deferred
+	};
+
+	// set_capacity() evicts at most this many entries per lock acquisition
+	constexpr std::size_t shrink_step = 1024;
+	// Entries a mutating call frees on its way out in deferred mode
+	constexpr std::size_t reclaim_chunk = 4;
+
 	class NullLock
 	{
 	public:
@@ -20,12 +189,12 @@ namespace cache
 		bool try_lock() { return true; }
 	};
 
-	template<typename T, typename = void>
+	template<typename T, typename Hash = std::hash<T>, typename = void>
 	struct has_hash : std::false_type
 	{ };
 
-	template<typename T>
-	struct has_hash<T, decltype(void(std::declval<std::hash<T>>()(std::declval<T>())))> : std::true_type
+	template<typename T, typename Hash>
+	struct has_hash<T, Hash, decltype(void(std::declval<const Hash&>()(std::declval<const T&>())))> : std::true_type
 	{ };
 
 	template<typename T, typename = void>
@@ -35,4 +204,35 @@ namespace cache
 	template<typename T>
 	struct has_less_comp<T, decltype(void(std::declval<T&>() < std::declval<T&>()))> : std::true_type
 	{ };
+
+	// Integral keys with the default functors get IntegerIndex: std::hash is
+	// the identity there, so the index can mix the key itself and keep it inline
+	template<typename T, typename Hash = std::hash<T>, typename KeyEqual = std::equal_to<T>>
+	struct is_integer_key : std::integral_constant<bool, std::is_integral<T>::value
+		&& std::is_same<Hash, std::hash<T>>::value && std::is_same<KeyEqual, std::equal_to<T>>::value>
+	{ };
+
+	// Hash / equality / comparison functors that accept any key-like type
+	template<typename T, typename = void>
+	struct is_transparent : std::false_type
+	{ };
+
+	template<typename T>
+	struct is_transparent<T, decltype(void(std::declval<typename T::is_transparent*>()))> : std::true_type
+	{ };
+
+	// Assigns an existing value in place: a lone Value argument is copied or
+	// moved straight into it, anything else constructs a Value first
+	template<typename Value, typename Arg>
+	std::enable_if_t<std::is_same<std::decay_t<Arg>, Value>::value>
+	assign_value(Value& dst, Arg&& arg)
+	{
+		dst = std::forward<Arg>(arg);
+	}
+
+	template<typename Value, typename... Args>
+	void assign_value(Value& dst, Args&&... args)
+	{
+		dst = Value(std::forward<Args>(args)...);
+	}
 }
\ No newline at end of file
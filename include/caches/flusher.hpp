@@ -0,0 +1,115 @@
+#pragma once
+#include "caches/cache_utils.hpp"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace cache
+{
+	// Background thread that bounds the staleness of write-behind caches:
+	// every period it hands each attached cache's expired dirty entries to
+	// that cache's sink (flush_expired()). A sink that throws leaves its
+	// batch queued for the next pass.
+	class Flusher
+	{
+	public:
+		explicit Flusher(std::chrono::milliseconds period = std::chrono::milliseconds(10));
+		~Flusher();
+
+		// The cache must already have write-behind enabled; detach before destroying it
+		template<class Cache>
+		void attach(Cache& cache);
+		template<class Cache>
+		void detach(Cache& cache);
+
+		// One pass over every cache; returns how many entries were written
+		std::size_t run_once();
+
+	private:
+		Flusher(const Flusher&) = delete;
+		Flusher& operator=(const Flusher&) = delete;
+
+		void loop();
+		std::size_t pass();
+
+		using flushFn = std::function<std::size_t()>;
+
+		std::chrono::milliseconds period_;
+		std::mutex mutex_;
+		std::condition_variable wake_;
+		bool stop_;
+		std::vector<std::pair<const void*, flushFn>> caches_;
+		std::thread thread_;
+	};
+
+
+	inline Flusher::Flusher(std::chrono::milliseconds period)
+		: period_(period), stop_(false)
+	{
+		thread_ = std::thread(&Flusher::loop, this);
+	}
+
+	inline Flusher::~Flusher()
+	{
+		{
+			std::lock_guard<std::mutex> g(mutex_);
+			stop_ = true;
+		}
+		wake_.notify_one();
+		thread_.join();
+	}
+
+	template<class Cache>
+	void Flusher::attach(Cache& cache)
+	{
+		std::lock_guard<std::mutex> g(mutex_);
+		caches_.emplace_back(&cache, [&cache] { return cache.flush_expired(); });
+	}
+
+	template<class Cache>
+	void Flusher::detach(Cache& cache)
+	{
+		std::lock_guard<std::mutex> g(mutex_);
+		caches_.erase(std::remove_if(caches_.begin(), caches_.end(),
+			[&cache](const std::pair<const void*, flushFn>& p) { return p.first == &cache; }),
+			caches_.end());
+	}
+
+	inline std::size_t Flusher::run_once()
+	{
+		std::lock_guard<std::mutex> g(mutex_);
+		return pass();
+	}
+
+	inline std::size_t Flusher::pass()
+	{
+		std::size_t written = 0;
+		for (auto& p : caches_)
+		{
+			try
+			{
+				written += p.second();
+			}
+			catch (...)
+			{ }
+		}
+		return written;
+	}
+
+	inline void Flusher::loop()
+	{
+		std::unique_lock<std::mutex> lk(mutex_);
+		while (!stop_)
+		{
+			wake_.wait_for(lk, period_, [this] { return stop_; });
+			if (stop_)
+				break;
+			pass();
+		}
+	}
+}
@@ -0,0 +1,292 @@
+#pragma once
+#include "caches/cache_utils.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace cache
+{
+	// Tracks the heaviest keys of an access stream in fixed memory.
+	// A Count-Min sketch (conservative update) estimates every key's count;
+	// the `k` keys with the largest estimates are kept as candidates in a
+	// min-heap, so a record() costs a few counter bumps and, for candidates,
+	// one heap fix-up. Works next to any cache: call record() on each access.
+	template<typename Key, class LockT = NullLock,
+			 class Hash = std::hash<Key>, class KeyEqual = std::equal_to<Key>>
+	class HotKeys
+	{
+		static_assert(has_hash<Key, Hash>::value, "HotKeys needs a hashable Key");
+
+	private:
+		static constexpr std::size_t depth = 4;
+		static constexpr std::uint32_t npos = std::numeric_limits<std::uint32_t>::max();
+
+		// Candidates stay in place; only their indices move inside the heap
+		struct Candidate
+		{
+			Key key;
+			std::size_t count;
+			std::uint32_t heapPos;
+		};
+
+		std::size_t cell(std::size_t row, std::size_t hash) const;
+		std::size_t bump(std::size_t hash, std::size_t weight);
+		std::size_t estimateHashed(std::size_t hash) const;
+
+		bool heapLess(std::uint32_t a, std::uint32_t b) const;
+		void heapSwap(std::size_t a, std::size_t b);
+		void siftUp(std::size_t pos);
+		void siftDown(std::size_t pos);
+
+		using Guard = std::lock_guard<LockT>;
+	public:
+		// `width` counters per sketch row; 0 picks 16 per tracked key
+		explicit HotKeys(std::size_t k, std::size_t width = 0);
+
+		void record(const Key& key, std::size_t weight = 1);
+		std::size_t estimate(const Key& key) const;
+
+		// Heaviest first. Candidates are copied `report_slice` at a time, releasing
+		// the lock in between, so a report never stalls record() for long.
+		std::vector<hot_key<Key>> report() const;
+
+		// Halves every count so old traffic fades out
+		void decay();
+		void clear();
+
+		std::size_t k() const;
+		std::size_t memory_usage() const;
+
+		static constexpr std::size_t report_slice = 64;
+
+	private:
+		HotKeys(const HotKeys&) = delete;
+		HotKeys& operator=(const HotKeys&) = delete;
+
+		mutable LockT lock_;
+		std::size_t k_;
+		std::size_t width_;
+		unsigned shift_;
+		std::vector<std::uint32_t> sketch_;
+
+		std::vector<Candidate> candidates_;
+		std::vector<std::uint32_t> heap_;
+		std::unordered_map<Key, std::uint32_t, Hash, KeyEqual> index_;
+		Hash hash_;
+	};
+
+
+	template<typename Key, class LockT, class Hash, class KeyEqual>
+	HotKeys<Key, LockT, Hash, KeyEqual>::HotKeys(std::size_t k, std::size_t width)
+		: k_(std::max<std::size_t>(1, std::min<std::size_t>(k, npos - 1))),
+		  width_(64), shift_(58)
+	{
+		std::size_t wanted = width == 0 ? k_ * 16 : width;
+		while (width_ < wanted)
+		{
+			width_ *= 2;
+			--shift_;
+		}
+
+		sketch_.assign(depth * width_, 0);
+		candidates_.reserve(k_);
+		heap_.reserve(k_);
+		index_.reserve(k_);
+	}
+
+	// Each row multiplies by its own odd constant and keeps the top bits
+	template<typename Key, class LockT, class Hash, class KeyEqual>
+	std::size_t HotKeys<Key, LockT, Hash, KeyEqual>::cell(std::size_t row, std::size_t hash) const
+	{
+		static const std::uint64_t mult[depth] = {
+			0x9E3779B97F4A7C15ull, 0xC2B2AE3D27D4EB4Full, 0x165667B19E3779F9ull, 0xD6E8FEB86659FD93ull
+		};
+		std::uint64_t h = (static_cast<std::uint64_t>(hash) ^ (static_cast<std::uint64_t>(hash) >> 29)) * mult[row];
+		return row * width_ + static_cast<std::size_t>(h >> shift_);
+	}
+
+	// Conservative update: only the counters at the current minimum grow
+	template<typename Key, class LockT, class Hash, class KeyEqual>
+	std::size_t HotKeys<Key, LockT, Hash, KeyEqual>::bump(std::size_t hash, std::size_t weight)
+	{
+		std::size_t target = estimateHashed(hash) + weight;
+		std::uint32_t capped = static_cast<std::uint32_t>(std::min<std::size_t>(target, std::size_t(npos)));
+
+		for (std::size_t row = 0; row < depth; ++row)
+		{
+			std::uint32_t& counter = sketch_[cell(row, hash)];
+			counter = std::max(counter, capped);
+		}
+		return capped;
+	}
+
+	template<typename Key, class LockT, class Hash, class KeyEqual>
+	std::size_t HotKeys<Key, LockT, Hash, KeyEqual>::estimateHashed(std::size_t hash) const
+	{
+		std::uint32_t least = npos;
+		for (std::size_t row = 0; row < depth; ++row)
+			least = std::min(least, sketch_[cell(row, hash)]);
+		return least;
+	}
+
+	template<typename Key, class LockT, class Hash, class KeyEqual>
+	bool HotKeys<Key, LockT, Hash, KeyEqual>::heapLess(std::uint32_t a, std::uint32_t b) const
+	{
+		return candidates_[a].count < candidates_[b].count;
+	}
+
+	template<typename Key, class LockT, class Hash, class KeyEqual>
+	void HotKeys<Key, LockT, Hash, KeyEqual>::heapSwap(std::size_t a, std::size_t b)
+	{
+		std::swap(heap_[a], heap_[b]);
+		candidates_[heap_[a]].heapPos = static_cast<std::uint32_t>(a);
+		candidates_[heap_[b]].heapPos = static_cast<std::uint32_t>(b);
+	}
+
+	template<typename Key, class LockT, class Hash, class KeyEqual>
+	void HotKeys<Key, LockT, Hash, KeyEqual>::siftUp(std::size_t pos)
+	{
+		while (pos > 0)
+		{
+			std::size_t parent = (pos - 1) / 2;
+			if (!heapLess(heap_[pos], heap_[parent]))
+				break;
+			heapSwap(pos, parent);
+			pos = parent;
+		}
+	}
+
+	template<typename Key, class LockT, class Hash, class KeyEqual>
+	void HotKeys<Key, LockT, Hash, KeyEqual>::siftDown(std::size_t pos)
+	{
+		for (;;)
+		{
+			std::size_t least = pos;
+			std::size_t left = 2 * pos + 1;
+			std::size_t right = left + 1;
+
+			if (left < heap_.size() && heapLess(heap_[left], heap_[least]))
+				least = left;
+			if (right < heap_.size() && heapLess(heap_[right], heap_[least]))
+				least = right;
+			if (least == pos)
+				break;
+
+			heapSwap(pos, least);
+			pos = least;
+		}
+	}
+
+	template<typename Key, class LockT, class Hash, class KeyEqual>
+	void HotKeys<Key, LockT, Hash, KeyEqual>::record(const Key& key, std::size_t weight)
+	{
+		std::size_t hash = hash_(key);
+
+		Guard g(lock_);
+		std::size_t count = bump(hash, weight);
+
+		auto iter = index_.find(key);
+		if (iter != index_.end())
+		{
+			Candidate& c = candidates_[iter->second];
+			c.count = count;
+			siftDown(c.heapPos);
+			return;
+		}
+
+		if (candidates_.size() < k_)
+		{
+			std::uint32_t slot = static_cast<std::uint32_t>(candidates_.size());
+			candidates_.push_back(Candidate{ key, count, slot });
+			heap_.push_back(slot);
+			index_.emplace(key, slot);
+			siftUp(slot);
+			return;
+		}
+
+		// Replaces the lightest candidate only if this key now outweighs it
+		std::uint32_t slot = heap_[0];
+		Candidate& lightest = candidates_[slot];
+		if (count <= lightest.count)
+			return;
+
+		index_.erase(lightest.key);
+		lightest.key = key;
+		lightest.count = count;
+		index_.emplace(key, slot);
+		siftDown(0);
+	}
+
+	template<typename Key, class LockT, class Hash, class KeyEqual>
+	std::size_t HotKeys<Key, LockT, Hash, KeyEqual>::estimate(const Key& key) const
+	{
+		std::size_t hash = hash_(key);
+		Guard g(lock_);
+		return estimateHashed(hash);
+	}
+
+	template<typename Key, class LockT, class Hash, class KeyEqual>
+	std::vector<hot_key<Key>> HotKeys<Key, LockT, Hash, KeyEqual>::report() const
+	{
+		std::vector<hot_key<Key>> out;
+		out.reserve(k_);
+
+		for (std::size_t begin = 0; ; begin += report_slice)
+		{
+			Guard g(lock_);
+			std::size_t end = std::min(begin + report_slice, candidates_.size());
+			for (std::size_t i = begin; i < end; ++i)
+				out.push_back(hot_key<Key>{ candidates_[i].key, candidates_[i].count });
+
+			if (end == candidates_.size())
+				break;
+		}
+
+		std::sort(out.begin(), out.end(), [](const hot_key<Key>& a, const hot_key<Key>& b)
+		{
+			return a.count > b.count;
+		});
+		return out;
+	}
+
+	// Floor-halving keeps the heap order, so no fix-up is needed
+	template<typename Key, class LockT, class Hash, class KeyEqual>
+	void HotKeys<Key, LockT, Hash, KeyEqual>::decay()
+	{
+		Guard g(lock_);
+		for (std::uint32_t& counter : sketch_)
+			counter >>= 1;
+		for (Candidate& c : candidates_)
+			c.count >>= 1;
+	}
+
+	template<typename Key, class LockT, class Hash, class KeyEqual>
+	void HotKeys<Key, LockT, Hash, KeyEqual>::clear()
+	{
+		Guard g(lock_);
+		std::fill(sketch_.begin(), sketch_.end(), 0);
+		candidates_.clear();
+		heap_.clear();
+		index_.clear();
+	}
+
+	template<typename Key, class LockT, class Hash, class KeyEqual>
+	std::size_t HotKeys<Key, LockT, Hash, KeyEqual>::k() const
+	{
+		return k_;
+	}
+
+	template<typename Key, class LockT, class Hash, class KeyEqual>
+	std::size_t HotKeys<Key, LockT, Hash, KeyEqual>::memory_usage() const
+	{
+		Guard g(lock_);
+		return sketch_.size() * sizeof(std::uint32_t)
+			 + candidates_.capacity() * sizeof(Candidate)
+			 + heap_.capacity() * sizeof(std::uint32_t)
+			 + index_.bucket_count() * sizeof(void*)
+			 + index_.size() * (sizeof(Key) + sizeof(std::uint32_t) + 2 * sizeof(void*));
+	}
+}
@@ -0,0 +1,101 @@
+#pragma once
+#include "caches/cache_utils.hpp"
+#include <atomic>
+#include <chrono>
+#include <mutex>
+
+namespace cache
+{
+	// A lock for the LockT parameter that measures itself: how often it is
+	// taken, how often a caller finds it taken and waits, and for how long it
+	// is waited for and held. Read it through the cache's contention().
+	// Counters are only written by the holder, so they are bumped with a
+	// relaxed load and store; stats() may read them from any thread. Every
+	// acquisition reads the clock twice, so measure with it, do not ship it.
+	template<class LockT = std::mutex>
+	class InstrumentedLock
+	{
+		using clock = std::chrono::steady_clock;
+
+	public:
+		void lock();
+		bool try_lock();
+		void unlock();
+
+		lock_stats stats() const;
+
+	private:
+		static void add(std::atomic<std::uint64_t>& counter, std::uint64_t n);
+		void acquired();
+
+		LockT lock_;
+		clock::time_point heldSince_;
+
+		std::atomic<std::uint64_t> acquisitions_{ 0 };
+		std::atomic<std::uint64_t> contended_{ 0 };
+		std::atomic<std::uint64_t> waitNs_{ 0 };
+		std::atomic<std::uint64_t> maxWaitNs_{ 0 };
+		std::atomic<std::uint64_t> holdNs_{ 0 };
+	};
+
+
+	template<class LockT>
+	void InstrumentedLock<LockT>::add(std::atomic<std::uint64_t>& counter, std::uint64_t n)
+	{
+		counter.store(counter.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+	}
+
+	template<class LockT>
+	void InstrumentedLock<LockT>::acquired()
+	{
+		add(acquisitions_, 1);
+		heldSince_ = clock::now();
+	}
+
+	// An uncontended acquisition costs one try_lock and is not timed as a wait
+	template<class LockT>
+	void InstrumentedLock<LockT>::lock()
+	{
+		if (!lock_.try_lock())
+		{
+			clock::time_point start = clock::now();
+			lock_.lock();
+			std::uint64_t waited = std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - start).count();
+
+			add(contended_, 1);
+			add(waitNs_, waited);
+			if (waited > maxWaitNs_.load(std::memory_order_relaxed))
+				maxWaitNs_.store(waited, std::memory_order_relaxed);
+		}
+		acquired();
+	}
+
+	template<class LockT>
+	bool InstrumentedLock<LockT>::try_lock()
+	{
+		if (!lock_.try_lock())
+			return false;
+
+		acquired();
+		return true;
+	}
+
+	template<class LockT>
+	void InstrumentedLock<LockT>::unlock()
+	{
+		add(holdNs_, std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - heldSince_).count());
+		lock_.unlock();
+	}
+
+	template<class LockT>
+	lock_stats InstrumentedLock<LockT>::stats() const
+	{
+		lock_stats stats;
+		stats.acquisitions = acquisitions_.load(std::memory_order_relaxed);
+		stats.contended = contended_.load(std::memory_order_relaxed);
+		stats.wait = std::chrono::nanoseconds(waitNs_.load(std::memory_order_relaxed));
+		stats.max_wait = std::chrono::nanoseconds(maxWaitNs_.load(std::memory_order_relaxed));
+		stats.hold = std::chrono::nanoseconds(holdNs_.load(std::memory_order_relaxed));
+		return stats;
+	}
+}
@@ -0,0 +1,134 @@
+#pragma once
+
+namespace cache
+{
+	struct ListHook
+	{
+		ListHook* prev = nullptr;
+		ListHook* next = nullptr;
+	};
+
+	// Circular doubly linked list over nodes derived from ListHook.
+	// The list never owns its nodes; whoever links a node frees it.
+	template<class T>
+	class IntrusiveList
+	{
+	public:
+		IntrusiveList()
+		{
+			reset();
+		}
+
+		bool empty() const
+		{
+			return head_.next == &head_;
+		}
+
+		T* front() const
+		{
+			return empty() ? nullptr : node(head_.next);
+		}
+
+		T* back() const
+		{
+			return empty() ? nullptr : node(head_.prev);
+		}
+
+		T* next(const T* n) const
+		{
+			return n->next == &head_ ? nullptr : node(n->next);
+		}
+
+		T* prev(const T* n) const
+		{
+			return n->prev == &head_ ? nullptr : node(n->prev);
+		}
+
+		void push_front(T* n)
+		{
+			link(&head_, n);
+		}
+
+		void push_back(T* n)
+		{
+			link(head_.prev, n);
+		}
+
+		void insert_after(T* pos, T* n)
+		{
+			link(pos, n);
+		}
+
+		void move_to_front(T* n)
+		{
+			if (head_.next == n)
+				return;
+
+			unlink(n);
+			push_front(n);
+		}
+
+		// Moves every node of `other` to the back of this list in O(1)
+		void splice_back(IntrusiveList& other)
+		{
+			if (other.empty())
+				return;
+
+			ListHook* first = other.head_.next;
+			ListHook* last  = other.head_.prev;
+
+			first->prev = head_.prev;
+			head_.prev->next = first;
+			last->next = &head_;
+			head_.prev = last;
+
+			other.reset();
+		}
+
+		static void unlink(T* n)
+		{
+			n->prev->next = n->next;
+			n->next->prev = n->prev;
+		}
+
+		// Forgets every node without touching them
+		void reset()
+		{
+			head_.prev = &head_;
+			head_.next = &head_;
+		}
+
+		template<class Disposer>
+		void clear_and_dispose(Disposer dispose)
+		{
+			ListHook* cur = head_.next;
+			while (cur != &head_)
+			{
+				ListHook* temp = cur;
+				cur = cur->next;
+				dispose(node(temp));
+			}
+			reset();
+		}
+
+	private:
+		IntrusiveList(const IntrusiveList&) = delete;
+		IntrusiveList& operator=(const IntrusiveList&) = delete;
+
+		static void link(ListHook* pos, ListHook* n)
+		{
+			n->prev = pos;
+			n->next = pos->next;
+
+			pos->next->prev = n;
+			pos->next		= n;
+		}
+
+		static T* node(ListHook* hook)
+		{
+			return static_cast<T*>(hook);
+		}
+
+		ListHook head_;
+	};
+}
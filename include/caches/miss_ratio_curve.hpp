@@ -0,0 +1,296 @@
+#pragma once
+#include "caches/cache_utils.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+#include <queue>
+#include <unordered_map>
+#include <vector>
+
+namespace cache
+{
+	// Estimates the LRU miss-ratio curve of a live key stream (SHARDS).
+	// Only keys whose hash falls under a threshold are tracked; their reuse
+	// distances, scaled by the sampling rate, feed a fixed histogram. Once
+	// `sample_keys` keys are tracked the threshold drops and the keys with the
+	// largest hashes leave, so memory stays fixed whatever the key space.
+	// Unsampled keys cost one hash and one relaxed load, without the lock.
+	template<typename Key, class LockT = NullLock,
+			 class Hash = std::hash<Key>, class KeyEqual = std::equal_to<Key>>
+	class MissRatioCurve
+	{
+		static_assert(has_hash<Key, Hash>::value, "MissRatioCurve needs a hashable Key");
+
+	private:
+		// Max-heap on the hash: the top is the next key to stop sampling
+		struct Candidate
+		{
+			std::uint64_t hash;
+			Key key;
+
+			bool operator<(const Candidate& other) const
+			{
+				return hash < other.hash;
+			}
+		};
+
+		static std::uint64_t mix(std::size_t hash);
+		double rate() const;
+
+		// Fenwick tree over access times: live keys accessed after a given time
+		void timeAdd(std::size_t time, long delta);
+		std::size_t timeCountUpTo(std::size_t time) const;
+		void compact();
+		void dropAbove(std::size_t limit);
+
+		using Guard = std::lock_guard<LockT>;
+	public:
+		// Curve points every max_capacity / points entries, up to max_capacity
+		MissRatioCurve(std::size_t max_capacity, std::size_t points = 64, std::size_t sample_keys = 4096);
+
+		void record(const Key& key);
+
+		// Predicted LRU miss ratio at `capacity`, rounded down to a curve point
+		double miss_ratio(std::size_t capacity) const;
+		std::vector<mrc_point> curve() const;
+
+		// Estimated references seen so far, and the current sampling rate
+		double references() const;
+		double sampling_rate() const;
+
+		// Halves the histogram so old traffic fades out
+		void decay();
+		void clear();
+
+		std::size_t memory_usage() const;
+
+	private:
+		MissRatioCurve(const MissRatioCurve&) = delete;
+		MissRatioCurve& operator=(const MissRatioCurve&) = delete;
+
+		mutable LockT lock_;
+		std::size_t step_;
+		std::size_t sampleKeys_;
+		std::atomic<std::uint64_t> threshold_;
+
+		std::vector<double> hist_;   // last slot: reuses beyond max_capacity
+		double total_;
+
+		std::unordered_map<Key, std::size_t, Hash, KeyEqual> sampled_;  // key -> last access time
+		std::priority_queue<Candidate> byHash_;
+		std::vector<long> times_;
+		std::size_t now_;
+		Hash hash_;
+	};
+
+
+	template<typename Key, class LockT, class Hash, class KeyEqual>
+	MissRatioCurve<Key, LockT, Hash, KeyEqual>::MissRatioCurve(std::size_t max_capacity, std::size_t points, std::size_t sample_keys)
+		: step_(0), sampleKeys_(std::max<std::size_t>(1, sample_keys)),
+		  threshold_(std::numeric_limits<std::uint64_t>::max()),
+		  total_(0), now_(0)
+	{
+		points = std::max<std::size_t>(1, points);
+		step_ = std::max<std::size_t>(1, (max_capacity + points - 1) / points);
+
+		hist_.assign(points + 1, 0);
+		sampled_.reserve(sampleKeys_ + 1);
+		times_.assign(2 * sampleKeys_ + 1, 0);
+	}
+
+	// One splitmix64 step: std::hash of integers is the identity, and without
+	// the offset key 0 would hash to 0 and always be sampled
+	template<typename Key, class LockT, class Hash, class KeyEqual>
+	std::uint64_t MissRatioCurve<Key, LockT, Hash, KeyEqual>::mix(std::size_t hash)
+	{
+		std::uint64_t h = static_cast<std::uint64_t>(hash) + 0x9E3779B97F4A7C15ull;
+		h = (h ^ (h >> 30)) * 0xBF58476D1CE4E5B9ull;
+		h = (h ^ (h >> 27)) * 0x94D049BB133111EBull;
+		return h ^ (h >> 31);
+	}
+
+	template<typename Key, class LockT, class Hash, class KeyEqual>
+	double MissRatioCurve<Key, LockT, Hash, KeyEqual>::rate() const
+	{
+		return (static_cast<double>(threshold_.load(std::memory_order_relaxed)) + 1.0) / 18446744073709551616.0;
+	}
+
+	template<typename Key, class LockT, class Hash, class KeyEqual>
+	void MissRatioCurve<Key, LockT, Hash, KeyEqual>::timeAdd(std::size_t time, long delta)
+	{
+		for (; time < times_.size(); time += time & (~time + 1))
+			times_[time] += delta;
+	}
+
+	template<typename Key, class LockT, class Hash, class KeyEqual>
+	std::size_t MissRatioCurve<Key, LockT, Hash, KeyEqual>::timeCountUpTo(std::size_t time) const
+	{
+		long count = 0;
+		for (; time > 0; time -= time & (~time + 1))
+			count += times_[time];
+		return static_cast<std::size_t>(count);
+	}
+
+	// Renumbers the live access times 1..n once the clock reaches the tree's end
+	template<typename Key, class LockT, class Hash, class KeyEqual>
+	void MissRatioCurve<Key, LockT, Hash, KeyEqual>::compact()
+	{
+		std::vector<std::size_t*> order;
+		order.reserve(sampled_.size());
+		for (auto& entry : sampled_)
+			order.push_back(&entry.second);
+
+		std::sort(order.begin(), order.end(), [](const std::size_t* a, const std::size_t* b)
+		{
+			return *a < *b;
+		});
+
+		std::fill(times_.begin(), times_.end(), 0);
+		now_ = 0;
+		for (std::size_t* time : order)
+		{
+			*time = ++now_;
+			timeAdd(now_, 1);
+		}
+	}
+
+	// Lowers the threshold until at most `limit` keys are sampled
+	template<typename Key, class LockT, class Hash, class KeyEqual>
+	void MissRatioCurve<Key, LockT, Hash, KeyEqual>::dropAbove(std::size_t limit)
+	{
+		while (sampled_.size() > limit)
+		{
+			std::uint64_t top = byHash_.top().hash;
+			threshold_.store(top - 1, std::memory_order_relaxed);
+
+			while (!byHash_.empty() && byHash_.top().hash >= top)
+			{
+				auto iter = sampled_.find(byHash_.top().key);
+				timeAdd(iter->second, -1);
+				sampled_.erase(iter);
+				byHash_.pop();
+			}
+		}
+	}
+
+	template<typename Key, class LockT, class Hash, class KeyEqual>
+	void MissRatioCurve<Key, LockT, Hash, KeyEqual>::record(const Key& key)
+	{
+		std::uint64_t hash = mix(hash_(key));
+		if (hash > threshold_.load(std::memory_order_relaxed))
+			return;
+
+		Guard g(lock_);
+		if (hash > threshold_.load(std::memory_order_relaxed))
+			return;
+
+		// Every sampled reference stands for 1 / rate references of the stream
+		double weight = 1.0 / rate();
+		total_ += weight;
+
+		if (now_ + 1 >= times_.size())
+			compact();
+		std::size_t now = ++now_;
+
+		auto iter = sampled_.find(key);
+		if (iter == sampled_.end())
+		{
+			sampled_.emplace(key, now);
+			byHash_.push(Candidate{ hash, key });
+			timeAdd(now, 1);
+			dropAbove(sampleKeys_);
+			return;
+		}
+
+		// Distinct sampled keys touched since the last access, scaled up
+		std::size_t last = iter->second;
+		std::size_t distance = timeCountUpTo(now - 1) - timeCountUpTo(last);
+		std::size_t bucket = static_cast<std::size_t>(distance * weight) / step_;
+		hist_[std::min(bucket, hist_.size() - 1)] += weight;
+
+		timeAdd(last, -1);
+		timeAdd(now, 1);
+		iter->second = now;
+	}
+
+	template<typename Key, class LockT, class Hash, class KeyEqual>
+	double MissRatioCurve<Key, LockT, Hash, KeyEqual>::miss_ratio(std::size_t capacity) const
+	{
+		Guard g(lock_);
+		if (total_ == 0)
+			return 0;
+
+		// A reuse at distance d hits in any LRU holding more than d other entries
+		std::size_t points = std::min(capacity / step_, hist_.size() - 1);
+		double hits = 0;
+		for (std::size_t i = 0; i < points; ++i)
+			hits += hist_[i];
+		return std::max(0.0, 1.0 - hits / total_);
+	}
+
+	template<typename Key, class LockT, class Hash, class KeyEqual>
+	std::vector<mrc_point> MissRatioCurve<Key, LockT, Hash, KeyEqual>::curve() const
+	{
+		Guard g(lock_);
+		std::vector<mrc_point> out;
+		out.reserve(hist_.size() - 1);
+
+		double hits = 0;
+		for (std::size_t i = 0; i + 1 < hist_.size(); ++i)
+		{
+			hits += hist_[i];
+			double miss = total_ == 0 ? 0 : std::max(0.0, 1.0 - hits / total_);
+			out.push_back(mrc_point{ (i + 1) * step_, miss });
+		}
+		return out;
+	}
+
+	template<typename Key, class LockT, class Hash, class KeyEqual>
+	double MissRatioCurve<Key, LockT, Hash, KeyEqual>::references() const
+	{
+		Guard g(lock_);
+		return total_;
+	}
+
+	template<typename Key, class LockT, class Hash, class KeyEqual>
+	double MissRatioCurve<Key, LockT, Hash, KeyEqual>::sampling_rate() const
+	{
+		Guard g(lock_);
+		return rate();
+	}
+
+	template<typename Key, class LockT, class Hash, class KeyEqual>
+	void MissRatioCurve<Key, LockT, Hash, KeyEqual>::decay()
+	{
+		Guard g(lock_);
+		for (double& count : hist_)
+			count /= 2;
+		total_ /= 2;
+	}
+
+	template<typename Key, class LockT, class Hash, class KeyEqual>
+	void MissRatioCurve<Key, LockT, Hash, KeyEqual>::clear()
+	{
+		Guard g(lock_);
+		std::fill(hist_.begin(), hist_.end(), 0);
+		std::fill(times_.begin(), times_.end(), 0);
+		total_ = 0;
+		now_ = 0;
+		sampled_.clear();
+		byHash_ = std::priority_queue<Candidate>();
+		threshold_.store(std::numeric_limits<std::uint64_t>::max(), std::memory_order_relaxed);
+	}
+
+	template<typename Key, class LockT, class Hash, class KeyEqual>
+	std::size_t MissRatioCurve<Key, LockT, Hash, KeyEqual>::memory_usage() const
+	{
+		Guard g(lock_);
+		return hist_.capacity() * sizeof(double)
+			 + times_.capacity() * sizeof(long)
+			 + byHash_.size() * sizeof(Candidate)
+			 + sampled_.bucket_count() * sizeof(void*)
+			 + sampled_.size() * (sizeof(Key) + sizeof(std::size_t) + 2 * sizeof(void*));
+	}
+}
@@ -0,0 +1,293 @@
+#pragma once
+#include "caches/cache_utils.hpp"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace cache
+{
+	// A per-thread L1 in front of a shared, locked L2 (an LRU or LFU).
+	// Each thread gets a small direct-mapped table of copies, so a repeated
+	// read of a hot key takes no lock and no atomic read-modify-write. Keys
+	// hash onto a fixed set of epochs; every insert or erase through the near
+	// cache bumps the key's epoch once L2 is written, and an L1 copy is used
+	// only while the epoch it was filled under is still current. L2 changes
+	// made around the near cache (direct writes, refresh-ahead reloads) are
+	// not seen until invalidate_all(). L2 evictions need no invalidation: the
+	// L1 copy is still the latest value written.
+	template<typename Key, typename Value, class Cache,
+			 class Hash = std::hash<Key>, class KeyEqual = std::equal_to<Key>>
+	class NearCache
+	{
+		static_assert(has_hash<Key, Hash>::value, "NearCache needs a hashable Key");
+		static_assert(std::is_default_constructible<Key>::value && std::is_default_constructible<Value>::value,
+			"NearCache keeps default-constructed keys and values in its L1 slots");
+
+	private:
+		static constexpr std::size_t epoch_bits = 6;
+		static constexpr std::size_t epoch_stripes = std::size_t(1) << epoch_bits;
+
+		struct Slot
+		{
+			Key key;
+			Value value;
+			std::uint64_t epoch = 0;
+			bool full = false;
+		};
+
+		// One thread's L1. Its counters have a single writer, so they are
+		// bumped with a relaxed load and store; stats() reads them from afar.
+		struct Local
+		{
+			explicit Local(std::size_t slots)
+				: slots(slots)
+			{ }
+
+			std::vector<Slot> slots;
+			std::atomic<std::size_t> l1Hits{ 0 };
+			std::atomic<std::size_t> l2Hits{ 0 };
+			std::atomic<std::size_t> misses{ 0 };
+		};
+
+		// Every thread's L1 tables for this specialization, by near-cache id
+		struct Tables
+		{
+			std::uint64_t lastId = 0;
+			Local* last = nullptr;
+			std::unordered_map<std::uint64_t, std::shared_ptr<Local>> byId;
+		};
+
+		static std::uint64_t mix(std::size_t hash);
+		static std::uint64_t nextId();
+		static Tables& tables();
+		static void bump(std::atomic<std::size_t>& counter);
+
+		Local& local();
+		Local& attach(Tables& tables);
+		const Value* fetch(const Key& key, lookup_status& status);
+
+	public:
+		// `l1_size` slots per thread, rounded up to a power of two.
+		// The shared cache must outlive the near cache.
+		explicit NearCache(Cache& shared, std::size_t l1_size = 64);
+
+		// The reference points into this thread's L1 and stays valid until
+		// this thread's next get()/lookup() on the near cache
+		const Value& get(const Key& key);
+		// As get(), without throwing; known_absent comes from L2's negative cache
+		lookup_status lookup(const Key& key, Value& out);
+
+		// Written through to L2, then every thread's copy of the key is dropped
+		void insert(const Key& key, const Value& value);
+		bool erase(const Key& key);
+		void clear();
+
+		// Drops every L1 copy in every thread, e.g. after writing L2 directly
+		void invalidate_all();
+
+		// Summed over every thread that has used the near cache
+		near_cache_stats stats() const;
+		std::size_t l1_size() const;
+
+	private:
+		NearCache(const NearCache&) = delete;
+		NearCache& operator=(const NearCache&) = delete;
+
+		Cache& shared_;
+		Hash hash_;
+		KeyEqual equal_;
+		std::size_t slots_;
+		std::uint64_t id_;
+		std::atomic<std::uint64_t> epochs_[epoch_stripes];
+
+		mutable std::mutex mutex_;
+		std::vector<std::shared_ptr<Local>> locals_;
+	};
+
+
+	// One splitmix64 step, as in MissRatioCurve: identity hashes need mixing
+	template<typename Key, typename Value, class Cache, class Hash, class KeyEqual>
+	std::uint64_t NearCache<Key, Value, Cache, Hash, KeyEqual>::mix(std::size_t hash)
+	{
+		std::uint64_t h = static_cast<std::uint64_t>(hash) + 0x9E3779B97F4A7C15ull;
+		h = (h ^ (h >> 30)) * 0xBF58476D1CE4E5B9ull;
+		h = (h ^ (h >> 27)) * 0x94D049BB133111EBull;
+		return h ^ (h >> 31);
+	}
+
+	// Ids are never reused, so a table left behind by a destroyed near cache is never picked up again
+	template<typename Key, typename Value, class Cache, class Hash, class KeyEqual>
+	std::uint64_t NearCache<Key, Value, Cache, Hash, KeyEqual>::nextId()
+	{
+		static std::atomic<std::uint64_t> next{ 0 };
+		return next.fetch_add(1, std::memory_order_relaxed) + 1;
+	}
+
+	template<typename Key, typename Value, class Cache, class Hash, class KeyEqual>
+	typename NearCache<Key, Value, Cache, Hash, KeyEqual>::Tables& NearCache<Key, Value, Cache, Hash, KeyEqual>::tables()
+	{
+		static thread_local Tables perThread;
+		return perThread;
+	}
+
+	template<typename Key, typename Value, class Cache, class Hash, class KeyEqual>
+	void NearCache<Key, Value, Cache, Hash, KeyEqual>::bump(std::atomic<std::size_t>& counter)
+	{
+		counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+	}
+
+	template<typename Key, typename Value, class Cache, class Hash, class KeyEqual>
+	typename NearCache<Key, Value, Cache, Hash, KeyEqual>::Local& NearCache<Key, Value, Cache, Hash, KeyEqual>::local()
+	{
+		Tables& perThread = tables();
+		if (perThread.lastId == id_)
+			return *perThread.last;
+		return attach(perThread);
+	}
+
+	// This thread switched near caches, or is new to this one
+	template<typename Key, typename Value, class Cache, class Hash, class KeyEqual>
+	typename NearCache<Key, Value, Cache, Hash, KeyEqual>::Local& NearCache<Key, Value, Cache, Hash, KeyEqual>::attach(Tables& perThread)
+	{
+		auto iter = perThread.byId.find(id_);
+		if (iter == perThread.byId.end())
+		{
+			// Tables only this thread still holds belong to destroyed near caches
+			for (auto dead = perThread.byId.begin(); dead != perThread.byId.end(); )
+			{
+				if (dead->second.use_count() == 1)
+					dead = perThread.byId.erase(dead);
+				else
+					++dead;
+			}
+
+			std::shared_ptr<Local> fresh = std::make_shared<Local>(slots_);
+			{
+				std::lock_guard<std::mutex> g(mutex_);
+				locals_.push_back(fresh);
+			}
+			iter = perThread.byId.emplace(id_, std::move(fresh)).first;
+		}
+
+		perThread.lastId = id_;
+		perThread.last = iter->second.get();
+		return *perThread.last;
+	}
+
+	// The epoch is read before L2: a write landing in between bumps it past
+	// the value stored with the copy, so the copy is never trusted
+	template<typename Key, typename Value, class Cache, class Hash, class KeyEqual>
+	const Value* NearCache<Key, Value, Cache, Hash, KeyEqual>::fetch(const Key& key, lookup_status& status)
+	{
+		Local& l1 = local();
+		std::uint64_t h = mix(hash_(key));
+		Slot& slot = l1.slots[h & (slots_ - 1)];
+		std::uint64_t epoch = epochs_[h >> (64 - epoch_bits)].load(std::memory_order_acquire);
+
+		if (slot.full && slot.epoch == epoch && equal_(slot.key, key))
+		{
+			bump(l1.l1Hits);
+			status = lookup_status::hit;
+			return &slot.value;
+		}
+
+		slot.full = false;
+		status = shared_.lookup(key, slot.value);
+		if (status != lookup_status::hit)
+		{
+			bump(l1.misses);
+			return nullptr;
+		}
+
+		slot.key = key;
+		slot.epoch = epoch;
+		slot.full = true;
+		bump(l1.l2Hits);
+		return &slot.value;
+	}
+
+	template<typename Key, typename Value, class Cache, class Hash, class KeyEqual>
+	NearCache<Key, Value, Cache, Hash, KeyEqual>::NearCache(Cache& shared, std::size_t l1_size)
+		: shared_(shared), slots_(1), id_(nextId())
+	{
+		while (slots_ < l1_size)
+			slots_ *= 2;
+
+		for (std::atomic<std::uint64_t>& epoch : epochs_)
+			epoch.store(0, std::memory_order_relaxed);
+	}
+
+	template<typename Key, typename Value, class Cache, class Hash, class KeyEqual>
+	const Value& NearCache<Key, Value, Cache, Hash, KeyEqual>::get(const Key& key)
+	{
+		lookup_status status;
+		const Value* value = fetch(key, status);
+		if (value == nullptr)
+			throw KeyNotFound();
+
+		return *value;
+	}
+
+	template<typename Key, typename Value, class Cache, class Hash, class KeyEqual>
+	lookup_status NearCache<Key, Value, Cache, Hash, KeyEqual>::lookup(const Key& key, Value& out)
+	{
+		lookup_status status;
+		if (const Value* value = fetch(key, status))
+			out = *value;
+		return status;
+	}
+
+	template<typename Key, typename Value, class Cache, class Hash, class KeyEqual>
+	void NearCache<Key, Value, Cache, Hash, KeyEqual>::insert(const Key& key, const Value& value)
+	{
+		shared_.insert(key, value);
+		epochs_[mix(hash_(key)) >> (64 - epoch_bits)].fetch_add(1, std::memory_order_release);
+	}
+
+	template<typename Key, typename Value, class Cache, class Hash, class KeyEqual>
+	bool NearCache<Key, Value, Cache, Hash, KeyEqual>::erase(const Key& key)
+	{
+		bool erased = shared_.erase(key);
+		epochs_[mix(hash_(key)) >> (64 - epoch_bits)].fetch_add(1, std::memory_order_release);
+		return erased;
+	}
+
+	template<typename Key, typename Value, class Cache, class Hash, class KeyEqual>
+	void NearCache<Key, Value, Cache, Hash, KeyEqual>::clear()
+	{
+		shared_.clear();
+		invalidate_all();
+	}
+
+	template<typename Key, typename Value, class Cache, class Hash, class KeyEqual>
+	void NearCache<Key, Value, Cache, Hash, KeyEqual>::invalidate_all()
+	{
+		for (std::atomic<std::uint64_t>& epoch : epochs_)
+			epoch.fetch_add(1, std::memory_order_release);
+	}
+
+	template<typename Key, typename Value, class Cache, class Hash, class KeyEqual>
+	near_cache_stats NearCache<Key, Value, Cache, Hash, KeyEqual>::stats() const
+	{
+		std::lock_guard<std::mutex> g(mutex_);
+		near_cache_stats stats;
+		for (const std::shared_ptr<Local>& l1 : locals_)
+		{
+			stats.l1_hits += l1->l1Hits.load(std::memory_order_relaxed);
+			stats.l2_hits += l1->l2Hits.load(std::memory_order_relaxed);
+			stats.misses  += l1->misses.load(std::memory_order_relaxed);
+		}
+		return stats;
+	}
+
+	template<typename Key, typename Value, class Cache, class Hash, class KeyEqual>
+	std::size_t NearCache<Key, Value, Cache, Hash, KeyEqual>::l1_size() const
+	{
+		return slots_;
+	}
+}
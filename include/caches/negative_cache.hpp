@@ -0,0 +1,314 @@
+#pragma once
+#include "caches/cache_utils.hpp"
+#include "caches/cache_index.hpp"
+#include "caches/intrusive_list.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+namespace cache
+{
+	// Keys known to be absent upstream, for a cache's negative-cache mode.
+	// The most recent ones sit in a small exact LRU with their record time;
+	// all of them also go into a cuckoo filter of 16-bit fingerprints, about
+	// two bytes a key. Filters come in two generations that rotate every
+	// ttl / 2, so a fingerprint lives between ttl / 2 and ttl. A filter can
+	// answer known-absent for a key that was never recorded, at most about
+	// 1 in 4000 when full; recording a real value removes its fingerprint.
+	// Not locked itself: the owning cache calls it under its own lock.
+	template<class Key, class Hash, class KeyEqual>
+	class NegativeCache
+	{
+		using clock = std::chrono::steady_clock;
+
+		struct Absent;
+		using indexT = HashIndex<Absent, Key, Hash, KeyEqual>;
+
+		struct Absent : ListHook, indexT::hook
+		{
+			Key key;
+			clock::time_point at;
+
+			Absent(const Key& key, clock::time_point at)
+				: key(key), at(at)
+			{ }
+		};
+
+		// Four fingerprints per bucket; 0 marks a free slot
+		struct Filter
+		{
+			std::vector<std::uint16_t> slots;
+			std::size_t count = 0;
+		};
+
+		static constexpr std::size_t bucket_slots = 4;
+		static constexpr std::size_t max_kicks = 500;
+
+	public:
+		explicit NegativeCache(negative_cache_options opts)
+			: opts_(opts), rotatedAt_(clock::now())
+		{
+			// Buckets for filter_keys at about 90% load, a power of two
+			std::size_t want = std::max<std::size_t>(2, opts_.filter_keys * 10 / 9 / bucket_slots + 1);
+			buckets_ = 2;
+			while (buckets_ < want)
+				buckets_ *= 2;
+
+			for (Filter& filter : filters_)
+				filter.slots.assign(buckets_ * bucket_slots, 0);
+		}
+
+		~NegativeCache()
+		{
+			exact_.clear_and_dispose([](Absent* absent) { delete absent; });
+		}
+
+		void record(const Key& key)
+		{
+			clock::time_point now = clock::now();
+			age(now);
+
+			typename indexT::hint_type hint;
+			if (Absent* absent = index_.probe(key, hint))
+			{
+				absent->at = now;
+				exact_.move_to_front(absent);
+			}
+			else if (opts_.exact > 0)
+			{
+				if (exactCount_ >= opts_.exact)
+				{
+					Absent* oldest = exact_.back();
+					index_.erase(oldest);
+					exact_.unlink(oldest);
+					delete oldest;
+					--exactCount_;
+				}
+
+				Absent* fresh = new Absent(key, now);
+				exact_.push_front(fresh);
+				index_.insert(fresh, hint);
+				++exactCount_;
+			}
+
+			std::uint64_t h = mix(hash_(key));
+			if (filterContains(filters_[current_], h))
+				return;
+
+			// A full generation retires early rather than lose fingerprints at random
+			if (!filterInsert(filters_[current_], h))
+			{
+				rotate(now);
+				filterInsert(filters_[current_], h);
+			}
+		}
+
+		// The key has a real value again
+		void forget(const Key& key)
+		{
+			if (Absent* absent = index_.find(key))
+			{
+				index_.erase(absent);
+				exact_.unlink(absent);
+				delete absent;
+				--exactCount_;
+			}
+
+			std::uint64_t h = mix(hash_(key));
+			for (Filter& filter : filters_)
+				filterErase(filter, h);
+		}
+
+		bool absent(const Key& key)
+		{
+			clock::time_point now = clock::now();
+			age(now);
+
+			if (Absent* absent = index_.find(key))
+			{
+				if (now - absent->at < opts_.ttl)
+				{
+					exact_.move_to_front(absent);
+					return true;
+				}
+				index_.erase(absent);
+				exact_.unlink(absent);
+				delete absent;
+				--exactCount_;
+			}
+
+			std::uint64_t h = mix(hash_(key));
+			return filterContains(filters_[0], h) || filterContains(filters_[1], h);
+		}
+
+		void clear()
+		{
+			exact_.clear_and_dispose([](Absent* absent) { delete absent; });
+			index_.clear();
+			exactCount_ = 0;
+			for (Filter& filter : filters_)
+			{
+				std::fill(filter.slots.begin(), filter.slots.end(), 0);
+				filter.count = 0;
+			}
+		}
+
+		std::size_t memory_usage() const
+		{
+			return index_.memory_usage()
+				 + exactCount_ * sizeof(Absent)
+				 + 2 * buckets_ * bucket_slots * sizeof(std::uint16_t);
+		}
+
+	private:
+		NegativeCache(const NegativeCache&) = delete;
+		NegativeCache& operator=(const NegativeCache&) = delete;
+
+		// One splitmix64 step, as in MissRatioCurve: identity hashes need mixing
+		static std::uint64_t mix(std::size_t hash)
+		{
+			std::uint64_t h = static_cast<std::uint64_t>(hash) + 0x9E3779B97F4A7C15ull;
+			h = (h ^ (h >> 30)) * 0xBF58476D1CE4E5B9ull;
+			h = (h ^ (h >> 27)) * 0x94D049BB133111EBull;
+			return h ^ (h >> 31);
+		}
+
+		static std::uint16_t fingerprint(std::uint64_t h)
+		{
+			std::uint16_t fp = static_cast<std::uint16_t>(h >> 48);
+			return fp == 0 ? 1 : fp;
+		}
+
+		// Partial-key cuckoo hashing: either bucket is found from the other and the fingerprint
+		std::size_t altBucket(std::size_t bucket, std::uint16_t fp) const
+		{
+			return (bucket ^ (static_cast<std::size_t>(fp) * 0x5BD1E995u)) & (buckets_ - 1);
+		}
+
+		bool bucketHas(const Filter& filter, std::size_t bucket, std::uint16_t fp) const
+		{
+			const std::uint16_t* slot = &filter.slots[bucket * bucket_slots];
+			return std::find(slot, slot + bucket_slots, fp) != slot + bucket_slots;
+		}
+
+		bool bucketPut(Filter& filter, std::size_t bucket, std::uint16_t fp)
+		{
+			std::uint16_t* slot = &filter.slots[bucket * bucket_slots];
+			std::uint16_t* free = std::find(slot, slot + bucket_slots, std::uint16_t(0));
+			if (free == slot + bucket_slots)
+				return false;
+
+			*free = fp;
+			++filter.count;
+			return true;
+		}
+
+		bool filterContains(const Filter& filter, std::uint64_t h) const
+		{
+			std::uint16_t fp = fingerprint(h);
+			std::size_t bucket = static_cast<std::size_t>(h) & (buckets_ - 1);
+			return bucketHas(filter, bucket, fp) || bucketHas(filter, altBucket(bucket, fp), fp);
+		}
+
+		bool filterInsert(Filter& filter, std::uint64_t h)
+		{
+			std::uint16_t fp = fingerprint(h);
+			std::size_t bucket = static_cast<std::size_t>(h) & (buckets_ - 1);
+			if (bucketPut(filter, bucket, fp) || bucketPut(filter, altBucket(bucket, fp), fp))
+				return true;
+
+			// Both full: evict a random fingerprint to its other bucket, and so on
+			std::vector<std::size_t> path;
+			path.reserve(max_kicks);
+			for (std::size_t kick = 0; kick < max_kicks; ++kick)
+			{
+				rng_ ^= rng_ << 13;
+				rng_ ^= rng_ >> 7;
+				rng_ ^= rng_ << 17;
+
+				std::size_t victim = bucket * bucket_slots + rng_ % bucket_slots;
+				std::swap(fp, filter.slots[victim]);
+				path.push_back(victim);
+				bucket = altBucket(bucket, fp);
+				if (bucketPut(filter, bucket, fp))
+					return true;
+			}
+
+			// Undo the swaps so no recorded fingerprint is silently lost
+			for (auto iter = path.rbegin(); iter != path.rend(); ++iter)
+				std::swap(fp, filter.slots[*iter]);
+			return false;
+		}
+
+		void filterErase(Filter& filter, std::uint64_t h)
+		{
+			std::uint16_t fp = fingerprint(h);
+			std::size_t bucket = static_cast<std::size_t>(h) & (buckets_ - 1);
+			for (std::size_t b : { bucket, altBucket(bucket, fp) })
+			{
+				std::uint16_t* slot = &filter.slots[b * bucket_slots];
+				std::uint16_t* hit = std::find(slot, slot + bucket_slots, fp);
+				if (hit != slot + bucket_slots)
+				{
+					*hit = 0;
+					--filter.count;
+					return;
+				}
+			}
+		}
+
+		// The older generation is dropped and the current one takes its place
+		void rotate(clock::time_point now)
+		{
+			current_ ^= 1;
+			Filter& fresh = filters_[current_];
+			std::fill(fresh.slots.begin(), fresh.slots.end(), 0);
+			fresh.count = 0;
+			rotatedAt_ = now;
+		}
+
+		void age(clock::time_point now)
+		{
+			if (now - rotatedAt_ >= opts_.ttl)
+			{
+				rotate(now);
+				rotate(now);
+			}
+			else if (now - rotatedAt_ >= opts_.ttl / 2)
+				rotate(now);
+		}
+
+		negative_cache_options opts_;
+		Hash hash_;
+
+		IntrusiveList<Absent> exact_;
+		indexT index_;
+		std::size_t exactCount_ = 0;
+
+		Filter filters_[2];
+		std::size_t buckets_ = 0;
+		std::size_t current_ = 0;
+		clock::time_point rotatedAt_;
+		std::uint64_t rng_ = 0x9E3779B97F4A7C15ull;
+	};
+
+	// Stands in for NegativeCache when Key is not hashable; the cache never enables it
+	template<class Key>
+	struct NoNegativeCache
+	{
+		explicit NoNegativeCache(negative_cache_options)
+		{ }
+
+		void record(const Key&) { }
+		void forget(const Key&) { }
+		bool absent(const Key&) { return false; }
+		void clear() { }
+		std::size_t memory_usage() const { return 0; }
+	};
+
+	template<class Key, class Hash, class KeyEqual>
+	using select_negative_cache_t = std::conditional_t<has_hash<Key, Hash>::value,
+		NegativeCache<Key, Hash, KeyEqual>, NoNegativeCache<Key>>;
+}
@@ -0,0 +1,125 @@
+#pragma once
+#include "caches/cache_utils.hpp"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace cache
+{
+	// Background thread that destroys entries removed from attached caches,
+	// so eviction, clear() and set_capacity() never pay for value destructors
+	// inside the cache lock or on the calling thread.
+	class Reclaimer
+	{
+	public:
+		explicit Reclaimer(std::chrono::milliseconds period = std::chrono::milliseconds(10),
+						   std::size_t chunk = 1024);
+		~Reclaimer();
+
+		// Switches the cache to reclaim_mode::deferred; detach before destroying it
+		template<class Cache>
+		void attach(Cache& cache);
+		// Back to reclaim_mode::immediate; leftovers go with the cache's next mutating call
+		template<class Cache>
+		void detach(Cache& cache);
+
+		// One pass over every cache, at most `chunk` entries each; returns how many were freed
+		std::size_t run_once();
+
+	private:
+		Reclaimer(const Reclaimer&) = delete;
+		Reclaimer& operator=(const Reclaimer&) = delete;
+
+		void loop();
+
+		using reclaimFn = std::function<std::size_t(std::size_t)>;
+
+		std::chrono::milliseconds period_;
+		std::size_t chunk_;
+		std::mutex mutex_;
+		std::condition_variable wake_;
+		bool stop_;
+		std::vector<std::pair<const void*, reclaimFn>> caches_;
+		std::thread thread_;
+	};
+
+
+	inline Reclaimer::Reclaimer(std::chrono::milliseconds period, std::size_t chunk)
+		: period_(period), chunk_(chunk), stop_(false)
+	{
+		thread_ = std::thread(&Reclaimer::loop, this);
+	}
+
+	inline Reclaimer::~Reclaimer()
+	{
+		{
+			std::lock_guard<std::mutex> g(mutex_);
+			stop_ = true;
+		}
+		wake_.notify_one();
+		thread_.join();
+	}
+
+	template<class Cache>
+	void Reclaimer::attach(Cache& cache)
+	{
+		cache.set_reclaim_mode(reclaim_mode::deferred);
+
+		std::lock_guard<std::mutex> g(mutex_);
+		caches_.emplace_back(&cache, [&cache](std::size_t n) { return cache.reclaim(n); });
+	}
+
+	template<class Cache>
+	void Reclaimer::detach(Cache& cache)
+	{
+		{
+			std::lock_guard<std::mutex> g(mutex_);
+			caches_.erase(std::remove_if(caches_.begin(), caches_.end(),
+				[&cache](const std::pair<const void*, reclaimFn>& p) { return p.first == &cache; }),
+				caches_.end());
+		}
+		cache.set_reclaim_mode(reclaim_mode::immediate);
+	}
+
+	inline std::size_t Reclaimer::run_once()
+	{
+		std::lock_guard<std::mutex> g(mutex_);
+
+		std::size_t freed = 0;
+		for (auto& p : caches_)
+			freed += p.second(chunk_);
+		return freed;
+	}
+
+	inline void Reclaimer::loop()
+	{
+		std::unique_lock<std::mutex> lk(mutex_);
+		while (!stop_)
+		{
+			wake_.wait_for(lk, period_, [this] { return stop_; });
+			if (stop_)
+				break;
+
+			// Keep going without sleeping while some cache still has a backlog
+			bool backlog = true;
+			while (backlog && !stop_)
+			{
+				backlog = false;
+				for (auto& p : caches_)
+					backlog |= p.second(chunk_) == chunk_;
+
+				if (backlog)
+				{
+					lk.unlock();
+					std::this_thread::yield();
+					lk.lock();
+				}
+			}
+		}
+	}
+}
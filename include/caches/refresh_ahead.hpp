@@ -0,0 +1,183 @@
+#pragma once
+#include "caches/cache_utils.hpp"
+#include "caches/refresh_pool.hpp"
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <unordered_map>
+
+namespace cache
+{
+	// Refresh-after-write bookkeeping behind a cache's refresh-ahead mode.
+	// Every write stamps its entry. A hit on an entry older than the refresh
+	// threshold still returns the cached value, but also hands one reload of
+	// that key to the pool. The reloaded value replaces the old one in place,
+	// without touching recency or frequency, unless the entry was written
+	// again meanwhile; a failed reload keeps the old value and a later hit
+	// tries again. As with WriteBack, nothing is stored per node.
+	template<class Node, class Key, class Value>
+	class RefreshAhead
+	{
+		using clock = std::chrono::steady_clock;
+
+		struct Entry
+		{
+			clock::time_point written;
+			std::uint64_t version;
+			std::uint64_t loading;  // version being reloaded, 0 if none
+		};
+
+		// Shared with queued tasks, which may run after the cache is gone
+		struct Control
+		{
+			std::mutex mutex;
+			std::condition_variable idle;
+			std::size_t running = 0;
+			bool closed = false;
+		};
+
+	public:
+		// Called by a worker with the cache unlocked; `fresh` is null if the reload failed
+		using apply_fn = std::function<void(const Key& key, std::uint64_t version, Value* fresh)>;
+
+		RefreshAhead()
+			: control_(std::make_shared<Control>())
+		{ }
+
+		~RefreshAhead()
+		{
+			close();
+		}
+
+		bool enabled() const
+		{
+			return pool_ != nullptr;
+		}
+
+		// Under the cache lock, once per cache
+		void enable(refresh_loader<Key, Value> loader, RefreshPool& pool, std::chrono::milliseconds after, apply_fn apply)
+		{
+			static_assert(std::is_copy_constructible<Key>::value, "Refresh-ahead copies keys into reload tasks");
+			loader_ = std::move(loader);
+			apply_ = std::move(apply);
+			after_ = after;
+			pool_ = &pool;
+		}
+
+		// Under the cache lock, after an insert or assignment
+		void stamp(Node* node)
+		{
+			Entry& entry = byNode_[node];
+			entry.written = clock::now();
+			entry.version = ++lastVersion_;
+		}
+
+		// Under the cache lock, once the node is out of the index
+		void retire(Node* node)
+		{
+			byNode_.erase(node);
+		}
+
+		void clear()
+		{
+			byNode_.clear();
+		}
+
+		// Under the cache lock, on a hit
+		void check(Node* node)
+		{
+			auto iter = byNode_.find(node);
+			if (iter == byNode_.end())
+				return;
+
+			Entry& entry = iter->second;
+			if (entry.loading != 0 || clock::now() - entry.written < after_)
+				return;
+
+			entry.loading = entry.version;
+			std::shared_ptr<Control> control = control_;
+			Key key = node->key;
+			std::uint64_t version = entry.version;
+			if (!pool_->submit([this, control, key, version] { run(*control, key, version); }))
+				entry.loading = 0;
+		}
+
+		// Under the cache lock, with the node the reloaded key maps to now
+		void finish(Node* node, std::uint64_t version, Value* fresh)
+		{
+			auto iter = byNode_.find(node);
+			if (iter == byNode_.end())
+				return;
+
+			Entry& entry = iter->second;
+			if (entry.loading == version)
+				entry.loading = 0;
+			if (fresh && entry.version == version)
+			{
+				node->value = std::move(*fresh);
+				entry.written = clock::now();
+			}
+		}
+
+		// Turns away tasks that have not started and waits for running ones.
+		// The cache calls it first thing in its destructor, while it is still whole.
+		void close()
+		{
+			std::unique_lock<std::mutex> lk(control_->mutex);
+			control_->closed = true;
+			control_->idle.wait(lk, [this] { return control_->running == 0; });
+		}
+
+		// Under the cache lock
+		std::size_t memory_usage() const
+		{
+			return byNode_.bucket_count() * sizeof(void*)
+				 + byNode_.size() * (sizeof(Node*) + sizeof(Entry) + 2 * sizeof(void*));
+		}
+
+	private:
+		RefreshAhead(const RefreshAhead&) = delete;
+		RefreshAhead& operator=(const RefreshAhead&) = delete;
+
+		void run(Control& control, const Key& key, std::uint64_t version)
+		{
+			{
+				std::lock_guard<std::mutex> g(control.mutex);
+				if (control.closed)
+					return;
+				++control.running;
+			}
+
+			try
+			{
+				Value fresh = loader_(key);
+				apply_(key, version, &fresh);
+			}
+			catch (...)
+			{
+				try
+				{
+					apply_(key, version, nullptr);
+				}
+				catch (...)
+				{ }
+			}
+
+			std::lock_guard<std::mutex> g(control.mutex);
+			--control.running;
+			control.idle.notify_all();
+		}
+
+		refresh_loader<Key, Value> loader_;
+		apply_fn apply_;
+		std::chrono::milliseconds after_{ 0 };
+		RefreshPool* pool_ = nullptr;
+
+		std::unordered_map<const Node*, Entry> byNode_;
+		std::uint64_t lastVersion_ = 0;
+		std::shared_ptr<Control> control_;
+	};
+}
@@ -0,0 +1,122 @@
+#pragma once
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace cache
+{
+	// A few worker threads running reloads for refresh-ahead caches.
+	// The queue is bounded: once it is full submit() turns tasks away and the
+	// cache tries again on a later read, so a slow backend cannot make work
+	// pile up. Tasks still queued when the pool is destroyed are dropped.
+	class RefreshPool
+	{
+	public:
+		explicit RefreshPool(std::size_t threads = 2, std::size_t queue_capacity = 1024);
+		~RefreshPool();
+
+		// false if the queue is full
+		bool submit(std::function<void()> task);
+
+		// Queued and running tasks
+		std::size_t pending() const;
+		// Blocks until the queue is empty and no task is running
+		void wait_idle();
+
+	private:
+		RefreshPool(const RefreshPool&) = delete;
+		RefreshPool& operator=(const RefreshPool&) = delete;
+
+		void loop();
+
+		mutable std::mutex mutex_;
+		std::condition_variable wake_;
+		std::condition_variable idle_;
+		std::deque<std::function<void()>> queue_;
+		std::size_t capacity_;
+		std::size_t running_;
+		bool stop_;
+		std::vector<std::thread> threads_;
+	};
+
+
+	inline RefreshPool::RefreshPool(std::size_t threads, std::size_t queue_capacity)
+		: capacity_(queue_capacity), running_(0), stop_(false)
+	{
+		if (threads == 0)
+			threads = 1;
+
+		threads_.reserve(threads);
+		for (std::size_t i = 0; i < threads; ++i)
+			threads_.emplace_back(&RefreshPool::loop, this);
+	}
+
+	inline RefreshPool::~RefreshPool()
+	{
+		{
+			std::lock_guard<std::mutex> g(mutex_);
+			stop_ = true;
+			queue_.clear();
+		}
+		wake_.notify_all();
+		for (std::thread& thread : threads_)
+			thread.join();
+	}
+
+	inline bool RefreshPool::submit(std::function<void()> task)
+	{
+		{
+			std::lock_guard<std::mutex> g(mutex_);
+			if (stop_ || queue_.size() >= capacity_)
+				return false;
+			queue_.push_back(std::move(task));
+		}
+		wake_.notify_one();
+		return true;
+	}
+
+	inline std::size_t RefreshPool::pending() const
+	{
+		std::lock_guard<std::mutex> g(mutex_);
+		return queue_.size() + running_;
+	}
+
+	inline void RefreshPool::wait_idle()
+	{
+		std::unique_lock<std::mutex> lk(mutex_);
+		idle_.wait(lk, [this] { return queue_.empty() && running_ == 0; });
+	}
+
+	inline void RefreshPool::loop()
+	{
+		std::unique_lock<std::mutex> lk(mutex_);
+		for (;;)
+		{
+			wake_.wait(lk, [this] { return stop_ || !queue_.empty(); });
+			if (stop_)
+				break;
+
+			std::function<void()> task = std::move(queue_.front());
+			queue_.pop_front();
+			++running_;
+			lk.unlock();
+
+			try
+			{
+				task();
+			}
+			catch (...)
+			{ }
+
+			lk.lock();
+			--running_;
+			if (queue_.empty() && running_ == 0)
+				idle_.notify_all();
+		}
+	}
+}
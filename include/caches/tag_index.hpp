@@ -0,0 +1,142 @@
+#pragma once
+#include "caches/cache_utils.hpp"
+#include "caches/intrusive_list.hpp"
+#include <unordered_map>
+
+namespace cache
+{
+	// Groups cache nodes by tag for invalidate_tag().
+	// A node carries a single pointer to the chain of its tag links, so
+	// untagged entries cost one null pointer and no allocation. Each link
+	// sits both on that chain and on its tag's intrusive list, which makes
+	// dropping a tag O(group size) and detaching a node O(its tags).
+	template<class Node>
+	class TagIndex
+	{
+		struct Group;
+
+		struct Link : ListHook
+		{
+			Node* owner;
+			Group* group;
+			Link* nextOfNode;
+		};
+
+		struct Group
+		{
+			tag_type tag;
+			std::size_t size = 0;
+			IntrusiveList<Link> links;
+		};
+
+	public:
+		struct hook
+		{
+			Link* tags = nullptr;
+
+			hook() = default;
+			hook(const hook&) = delete;
+			hook& operator=(const hook&) = delete;
+
+			// Links are unhooked from their groups under the cache lock;
+			// only the memory goes with the node, wherever it is destroyed
+			~hook()
+			{
+				while (tags)
+				{
+					Link* next = tags->nextOfNode;
+					delete tags;
+					tags = next;
+				}
+			}
+		};
+
+		TagIndex() = default;
+
+		// Adds the tags the node does not carry yet
+		void attach(Node* node, tag_list tags)
+		{
+			for (tag_type tag : tags)
+			{
+				if (hasTag(node, tag))
+					continue;
+
+				Group& group = groups_[tag];
+				group.tag = tag;
+
+				Link* link = new Link;
+				link->owner = node;
+				link->group = &group;
+				link->nextOfNode = node->tags;
+				node->tags = link;
+
+				group.links.push_back(link);
+				++group.size;
+				++linkCount_;
+			}
+		}
+
+		// Unhooks the node from every group; its links are freed with the node
+		void detach(Node* node)
+		{
+			for (Link* link = node->tags; link; link = link->nextOfNode)
+			{
+				Group* group = link->group;
+				group->links.unlink(link);
+				--linkCount_;
+				if (--group->size == 0)
+					groups_.erase(group->tag);
+			}
+		}
+
+		// Hands every node tagged with `tag` to eraseNode, which must detach it
+		template<class Fn>
+		std::size_t take(tag_type tag, Fn eraseNode)
+		{
+			std::size_t count = 0;
+			for (auto iter = groups_.find(tag); iter != groups_.end(); iter = groups_.find(tag))
+			{
+				eraseNode(iter->second.links.front()->owner);
+				++count;
+			}
+			return count;
+		}
+
+		std::size_t size(tag_type tag) const
+		{
+			auto iter = groups_.find(tag);
+			return iter == groups_.end() ? 0 : iter->second.size;
+		}
+
+		// For clear(): the nodes go away wholesale, so the groups can too
+		void clear()
+		{
+			groups_.clear();
+			linkCount_ = 0;
+		}
+
+		std::size_t memory_usage() const
+		{
+			return groups_.bucket_count() * sizeof(void*)
+				 + groups_.size() * (sizeof(tag_type) + sizeof(Group) + 2 * sizeof(void*))
+				 + linkCount_ * sizeof(Link);
+		}
+
+	private:
+		TagIndex(const TagIndex&) = delete;
+		TagIndex& operator=(const TagIndex&) = delete;
+
+		static bool hasTag(const Node* node, tag_type tag)
+		{
+			for (const Link* link = node->tags; link; link = link->nextOfNode)
+			{
+				if (link->group->tag == tag)
+					return true;
+			}
+			return false;
+		}
+
+		std::unordered_map<tag_type, Group> groups_;
+		std::size_t linkCount_ = 0;
+	};
+}
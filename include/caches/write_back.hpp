@@ -0,0 +1,245 @@
+#pragma once
+#include "caches/cache_utils.hpp"
+#include "caches/intrusive_list.hpp"
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <mutex>
+#include <unordered_map>
+
+namespace cache
+{
+	// Dirty-entry bookkeeping behind a cache's write-behind mode.
+	// Dirty nodes are kept in the order they were first written, so repeated
+	// writes to one key coalesce into a single sink write of its latest value.
+	// A dirty entry that leaves the cache (eviction, erase, clear) moves its
+	// key and value to the outbox and is written from there; the outbox always
+	// goes out before the dirty list, so every key's writes reach the sink in
+	// order. Nothing is stored per node, so caches without a sink pay one
+	// predictable branch per insert and removal.
+	template<class Node, class Key, class Value>
+	class WriteBack
+	{
+		using clock = std::chrono::steady_clock;
+
+		struct Mark : ListHook
+		{
+			Node* node;
+			clock::time_point since;
+		};
+
+		struct Parked : ListHook
+		{
+			Key key;
+			Value value;
+
+			Parked(Key&& key, Value&& value)
+				: key(std::move(key)), value(std::move(value))
+			{ }
+		};
+
+		using batchT = write_batch<Key, Value>;
+		using copyable = std::integral_constant<bool,
+			std::is_copy_constructible<Key>::value && std::is_copy_constructible<Value>::value>;
+
+	public:
+		WriteBack()
+			: pending_(0), limit_(std::numeric_limits<std::size_t>::max())
+		{ }
+
+		~WriteBack()
+		{
+			marks_.clear_and_dispose([](Mark* mark) { delete mark; });
+			outbox_.clear_and_dispose([](Parked* parked) { delete parked; });
+		}
+
+		bool enabled() const
+		{
+			return static_cast<bool>(sink_);
+		}
+
+		// Under the cache lock
+		void enable(write_sink<Key, Value> sink, write_behind_options opts)
+		{
+			static_assert(copyable::value, "Write-behind copies dirty keys and values out of the cache");
+			sink_ = std::move(sink);
+			opts_ = opts;
+			opts_.batch = std::max<std::size_t>(1, opts_.batch);
+			limit_.store(opts_.max_dirty, std::memory_order_relaxed);
+		}
+
+		// Under the cache lock, after an insert or assignment; a dirty entry keeps its first write time
+		void mark(Node* node)
+		{
+			Mark*& mark = byNode_[node];
+			if (mark)
+				return;
+
+			mark = new Mark;
+			mark->node = node;
+			mark->since = clock::now();
+			marks_.push_back(mark);
+			pending_.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		// Under the cache lock, once the node is out of the index
+		void retire(Node* node)
+		{
+			auto iter = byNode_.find(node);
+			if (iter == byNode_.end())
+				return;
+
+			park(iter->second);
+			byNode_.erase(iter);
+		}
+
+		// For clear(): every dirty node is about to go
+		void retire_all()
+		{
+			while (Mark* mark = marks_.front())
+				park(mark);
+			byNode_.clear();
+		}
+
+		// Read without the cache lock: inserting threads flush first while this holds
+		bool over_limit() const
+		{
+			return pending_.load(std::memory_order_relaxed) > limit_.load(std::memory_order_relaxed);
+		}
+
+		std::size_t size() const
+		{
+			return pending_.load(std::memory_order_relaxed);
+		}
+
+		// Writes the outbox, then dirty entries written at or before `cutoff`,
+		// and beyond that as many as it takes to leave at most `keep` pending.
+		// Takes batches under `cacheLock` and calls the sink without it; one
+		// flush runs at a time, so batches reach the sink in the order taken.
+		template<class LockT>
+		std::size_t flush(LockT& cacheLock, clock::time_point cutoff, std::size_t keep)
+		{
+			std::lock_guard<std::mutex> serial(flushMutex_);
+
+			std::size_t written = 0;
+			for (;;)
+			{
+				batchT batch;
+				{
+					std::lock_guard<LockT> g(cacheLock);
+					take(batch, cutoff, keep);
+				}
+				if (batch.empty())
+					return written;
+
+				try
+				{
+					sink_(batch);
+				}
+				catch (...)
+				{
+					// Back to the head of the outbox: the next flush retries them first
+					std::lock_guard<LockT> g(cacheLock);
+					restore(batch);
+					throw;
+				}
+				written += batch.size();
+			}
+		}
+
+		template<class LockT>
+		std::size_t flush_all(LockT& cacheLock)
+		{
+			return flush(cacheLock, clock::time_point::max(), 0);
+		}
+
+		template<class LockT>
+		std::size_t flush_expired(LockT& cacheLock)
+		{
+			return flush(cacheLock, clock::now() - opts_.max_staleness, opts_.max_dirty);
+		}
+
+		template<class LockT>
+		void relieve(LockT& cacheLock)
+		{
+			if (over_limit())
+				flush(cacheLock, clock::time_point::min(), opts_.max_dirty);
+		}
+
+		// Under the cache lock
+		std::size_t memory_usage() const
+		{
+			return byNode_.bucket_count() * sizeof(void*)
+				 + byNode_.size() * (sizeof(Node*) + sizeof(Mark*) + 2 * sizeof(void*) + sizeof(Mark))
+				 + outboxCount_ * sizeof(Parked);
+		}
+
+	private:
+		WriteBack(const WriteBack&) = delete;
+		WriteBack& operator=(const WriteBack&) = delete;
+
+		void park(Mark* mark)
+		{
+			Node* node = mark->node;
+			outbox_.push_back(new Parked(std::move(node->key), std::move(node->value)));
+			++outboxCount_;
+			marks_.unlink(mark);
+			delete mark;
+		}
+
+		void take(batchT& out, clock::time_point cutoff, std::size_t keep)
+		{
+			std::size_t taken = 0;
+			for (; taken < opts_.batch && !outbox_.empty(); ++taken)
+			{
+				Parked* parked = outbox_.front();
+				out.emplace_back(std::move(parked->key), std::move(parked->value));
+				outbox_.unlink(parked);
+				delete parked;
+				--outboxCount_;
+			}
+
+			for (; taken < opts_.batch; ++taken)
+			{
+				Mark* mark = marks_.front();
+				if (mark == nullptr || (mark->since > cutoff && pending_.load(std::memory_order_relaxed) - taken <= keep))
+					break;
+
+				copyOut(out, mark->node, copyable());
+				byNode_.erase(mark->node);
+				marks_.unlink(mark);
+				delete mark;
+			}
+			pending_.fetch_sub(taken, std::memory_order_relaxed);
+		}
+
+		void restore(batchT& batch)
+		{
+			for (auto iter = batch.rbegin(); iter != batch.rend(); ++iter)
+				outbox_.push_front(new Parked(std::move(iter->first), std::move(iter->second)));
+			outboxCount_ += batch.size();
+			pending_.fetch_add(batch.size(), std::memory_order_relaxed);
+		}
+
+		// Only reachable once enable() has checked that entries can be copied
+		static void copyOut(batchT& out, const Node* node, std::true_type)
+		{
+			out.emplace_back(node->key, node->value);
+		}
+
+		static void copyOut(batchT&, const Node*, std::false_type)
+		{ }
+
+		write_sink<Key, Value> sink_;
+		write_behind_options opts_;
+
+		IntrusiveList<Mark> marks_;
+		std::unordered_map<const Node*, Mark*> byNode_;
+		IntrusiveList<Parked> outbox_;
+		std::size_t outboxCount_ = 0;
+
+		std::atomic<std::size_t> pending_;  // dirty entries plus the outbox
+		std::atomic<std::size_t> limit_;
+		std::mutex flushMutex_;
+	};
+}
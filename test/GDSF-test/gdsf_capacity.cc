@@ -0,0 +1,118 @@
+#include <gtest/gtest.h>
+#include <caches/GDSF/GDSF.hpp>
+#include <string>
+
+TEST(GDSF_Capacity, BasicOperations)
+{
+	cache::GDSF<int, std::string> cache(3);
+	EXPECT_TRUE(cache.empty());
+
+	cache.insert(1, std::string("one"));
+	cache.insert(2, std::string("two"));
+	cache.emplace(cache::miss_cost(5.0), 3, 3, 'x');
+
+	EXPECT_TRUE(cache.full());
+	EXPECT_EQ(cache.size(), 3);
+	EXPECT_EQ(cache.get(3), "xxx");
+	EXPECT_EQ(cache.peek(1), "one");
+	EXPECT_THROW(cache.get(4), cache::KeyNotFound);
+
+	cache.insert(1, std::string("uno"));
+	EXPECT_EQ(cache[1], "uno");
+	EXPECT_EQ(cache.size(), 3);
+
+	EXPECT_TRUE(cache.erase(2));
+	EXPECT_FALSE(cache.erase(2));
+	EXPECT_FALSE(cache.contains(2));
+
+	cache.clear();
+	EXPECT_TRUE(cache.empty());
+	EXPECT_EQ(cache.weight(), 0);
+
+	cache::cache_stats stats = cache.stats();
+	EXPECT_EQ(stats.hits, 2);
+	EXPECT_EQ(stats.misses, 1);
+}
+
+TEST(GDSF_Capacity, EqualCostsEvictTheLeastFrequent)
+{
+	cache::GDSF<int, int> cache(3);
+	cache.insert(1, 1);
+	cache.insert(2, 2);
+	cache.insert(3, 3);
+	cache.get(1);
+	cache.get(1);
+	cache.get(3);
+
+	cache.insert(4, 4);
+	EXPECT_FALSE(cache.contains(2));
+
+	// 3 and 4 are now worth the same: the least recently used goes
+	cache.insert(5, 5);
+	EXPECT_FALSE(cache.contains(3));
+	EXPECT_TRUE(cache.contains(4));
+	EXPECT_TRUE(cache.contains(1));
+	EXPECT_EQ(cache.stats().evictions, 2);
+}
+
+TEST(GDSF_Capacity, SizesShareTheCapacity)
+{
+	cache::GDSF<int, int> cache(100);
+	cache.insert(1, 1, { 1.0, 60 });
+	cache.insert(2, 2, { 1.0, 30 });
+	EXPECT_EQ(cache.weight(), 90);
+	EXPECT_FALSE(cache.full());
+
+	// Needs 20: the larger entry is worth less per unit and goes first
+	cache.insert(3, 3, { 1.0, 20 });
+	EXPECT_FALSE(cache.contains(1));
+	EXPECT_EQ(cache.weight(), 50);
+
+	// Growing an entry in place makes room around it
+	cache.insert(2, 2, { 1.0, 90 });
+	EXPECT_TRUE(cache.contains(2));
+	EXPECT_FALSE(cache.contains(3));
+	EXPECT_EQ(cache.weight(), 90);
+
+	// Larger than the whole cache: not cached, and the stale copy goes
+	cache.insert(2, 2, { 1.0, 101 });
+	EXPECT_FALSE(cache.contains(2));
+	EXPECT_EQ(cache.weight(), 0);
+
+	// Size 0 counts as 1
+	cache.insert(4, 4, { 1.0, 0 });
+	EXPECT_EQ(cache.weight(), 1);
+}
+
+TEST(GDSF_Capacity, SetCapacity)
+{
+	cache::GDSF<int, int> cache(100);
+	for (int i = 0; i < 100; ++i)
+		cache.insert(i, i, static_cast<double>(i));
+
+	cache.set_capacity(10);
+	EXPECT_EQ(cache.size(), 10);
+	EXPECT_EQ(cache.capacity(), 10);
+	for (int i = 90; i < 100; ++i)
+		EXPECT_TRUE(cache.contains(i));
+
+	cache.set_capacity(0);
+	EXPECT_TRUE(cache.empty());
+	cache.insert(1, 1);
+	EXPECT_TRUE(cache.empty());
+}
+
+TEST(GDSF_Capacity, MemoryUsage)
+{
+	cache::GDSF<int, std::string> cache(1000);
+	for (int i = 0; i < 500; ++i)
+		cache.insert(i, std::string(64, 'v'));
+
+	cache::memory_stats stats = cache.memory_usage([](const std::string& s) { return s.capacity(); });
+	EXPECT_GT(stats.node_bytes, 500 * sizeof(std::string));
+	EXPECT_GE(stats.index_bytes, 500 * sizeof(void*));
+	EXPECT_GE(stats.value_heap_bytes, 500 * 64);
+
+	cache.clear();
+	EXPECT_EQ(cache.memory_usage().node_bytes, 0);
+}
@@ -0,0 +1,196 @@
+#include <gtest/gtest.h>
+#include <caches/GDSF/GDSF.hpp>
+#include <caches/LRU/LRU.hpp>
+#include <cmath>
+#include <cstdint>
+#include <map>
+#include <random>
+#include <vector>
+
+namespace
+{
+	// Linear-scan GDSF with the same tie-breaking, as a reference for the heap
+	class NaiveGDSF
+	{
+	public:
+		explicit NaiveGDSF(std::size_t capacity)
+			: capacity_(capacity)
+		{ }
+
+		void insert(int key, double cost, std::size_t size)
+		{
+			auto iter = entries_.find(key);
+			std::size_t frequency = 1;
+			if (iter != entries_.end())
+			{
+				frequency = iter->second.frequency + 1;
+				weight_ -= iter->second.size;
+				entries_.erase(iter);
+			}
+			if (size > capacity_)
+				return;
+
+			while (weight_ + size > capacity_)
+				evict();
+			entries_[key] = Entry{ clock_ + frequency * cost / size, cost, size, frequency, ++tick_ };
+			weight_ += size;
+		}
+
+		bool get(int key)
+		{
+			auto iter = entries_.find(key);
+			if (iter == entries_.end())
+				return false;
+
+			Entry& entry = iter->second;
+			++entry.frequency;
+			entry.priority = clock_ + entry.frequency * entry.cost / entry.size;
+			entry.stamp = ++tick_;
+			return true;
+		}
+
+		void erase(int key)
+		{
+			auto iter = entries_.find(key);
+			if (iter != entries_.end())
+			{
+				weight_ -= iter->second.size;
+				entries_.erase(iter);
+			}
+		}
+
+		bool contains(int key) const
+		{
+			return entries_.count(key) != 0;
+		}
+
+		std::size_t weight() const
+		{
+			return weight_;
+		}
+
+	private:
+		struct Entry
+		{
+			double priority;
+			double cost;
+			std::size_t size;
+			std::size_t frequency;
+			std::uint64_t stamp;
+		};
+
+		void evict()
+		{
+			auto victim = entries_.begin();
+			for (auto iter = entries_.begin(); iter != entries_.end(); ++iter)
+			{
+				const Entry& a = iter->second;
+				const Entry& b = victim->second;
+				if (a.priority < b.priority || (a.priority == b.priority && a.stamp < b.stamp))
+					victim = iter;
+			}
+			clock_ = victim->second.priority;
+			weight_ -= victim->second.size;
+			entries_.erase(victim);
+		}
+
+		std::map<int, Entry> entries_;
+		std::size_t capacity_;
+		std::size_t weight_ = 0;
+		double clock_ = 0;
+		std::uint64_t tick_ = 0;
+	};
+
+	double costOf(int key)
+	{
+		return key % 10 == 0 ? 100.0 : 1.0;
+	}
+
+	// Total recomputation cost of the misses; cheap keys are the hot ones
+	template<class Insert, class Cache>
+	double missCost(Cache& cache, Insert insert)
+	{
+		std::mt19937 rng(3);
+		std::uniform_real_distribution<double> uniform(0, 1);
+
+		double cost = 0;
+		for (int i = 0; i < 200000; ++i)
+		{
+			int key = static_cast<int>(2000 * std::pow(uniform(rng), 2));
+			if (!cache.contains(key))
+			{
+				cost += costOf(key);
+				insert(cache, key);
+			}
+			else
+				cache.get(key);
+		}
+		return cost;
+	}
+}
+
+TEST(GDSF_Cost, MatchesReferenceModel)
+{
+	cache::GDSF<int, int> cache(200);
+	NaiveGDSF model(200);
+
+	std::mt19937 rng(5);
+	for (int i = 0; i < 50000; ++i)
+	{
+		int key = static_cast<int>(rng() % 400);
+		switch (rng() % 5)
+		{
+		case 0:
+			cache.erase(key);
+			model.erase(key);
+			break;
+		case 1:
+		case 2:
+		{
+			bool hit = model.get(key);
+			ASSERT_EQ(cache.contains(key), hit);
+			if (hit)
+			{
+				cache.get(key);
+			}
+			break;
+		}
+		default:
+		{
+			double cost = static_cast<double>(1 + rng() % 50);
+			std::size_t size = 1 + rng() % 8;
+			cache.insert(key, i, { cost, size });
+			model.insert(key, cost, size);
+		}
+		}
+		ASSERT_EQ(cache.weight(), model.weight());
+	}
+
+	for (int key = 0; key < 400; ++key)
+		EXPECT_EQ(cache.contains(key), model.contains(key)) << "key " << key;
+}
+
+TEST(GDSF_Cost, SavesMoreRecomputationThanLRU)
+{
+	cache::GDSF<int, int> gdsf(300);
+	cache::LRU<int, int> lru(300);
+
+	double gdsfCost = missCost(gdsf, [](cache::GDSF<int, int>& c, int key) { c.insert(key, key, costOf(key)); });
+	double lruCost = missCost(lru, [](cache::LRU<int, int>& c, int key) { c.insert(key, key); });
+
+	EXPECT_LT(gdsfCost, lruCost * 0.7);
+}
+
+TEST(GDSF_Cost, UntouchedExpensiveEntriesAgeOut)
+{
+	cache::GDSF<int, int> cache(2);
+	cache.insert(-1, 0, 1000.0);
+
+	for (int i = 0; i < 100; ++i)
+		cache.insert(i, i);
+	EXPECT_TRUE(cache.contains(-1));
+
+	for (int i = 100; i < 5000; ++i)
+		cache.insert(i, i);
+	EXPECT_FALSE(cache.contains(-1));
+}
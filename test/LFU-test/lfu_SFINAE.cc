@@ -26,3 +26,28 @@ TEST(LFU_SFINAE, NonHashableKey)
 	cds.insert(NoHash{94}, 13);
 	EXPECT_FALSE(cds.contains(NoHash{2}));
 }
+
+TEST(LFU_SFINAE, NonHashableEvictsInsertPosition)
+{
+	struct NoHash
+	{
+		int x;
+		bool operator<(const NoHash& other) const
+		{
+			return x < other.x;
+		}
+	};
+
+	cache::LFU<NoHash, int> cds(2);
+
+	cds.insert(NoHash{3}, 3);
+	cds.insert(NoHash{1}, 1);
+	cds.get(NoHash{1});
+
+	// 3 is both the victim and the neighbour the new key is inserted next to
+	cds.insert(NoHash{2}, 2);
+	EXPECT_FALSE(cds.contains(NoHash{3}));
+	EXPECT_TRUE(cds.contains(NoHash{1}));
+	EXPECT_TRUE(cds.contains(NoHash{2}));
+	EXPECT_EQ(cds.size(), 2);
+}
@@ -0,0 +1,29 @@
+#include <gtest/gtest.h>
+#include <caches/LFU/LFU.hpp>
+#include <string>
+#include <type_traits>
+
+TEST(LFU_BasicCache, AliasOfTheCore)
+{
+	static_assert(std::is_same<cache::LFU<int, int>,
+		cache::basic_cache<int, int, cache::lfu_policy, cache::auto_index, cache::NullLock>>::value, "");
+}
+
+TEST(LFU_BasicCache, OrderedIndexKeepsFrequencies)
+{
+	cache::basic_cache<std::string, int, cache::lfu_policy, cache::ordered_index> cache(10);
+	cache.insert("post:1", 1);
+	cache.insert("user:1", 2);
+	cache.insert("user:2", 3);
+	cache.get("user:2");
+	cache.get("user:2");
+	cache.get("post:1");
+
+	auto top = cache.top_k(2);
+	ASSERT_EQ(top.size(), 2);
+	EXPECT_EQ(top[0].key, "user:2");
+	EXPECT_EQ(top[1].key, "post:1");
+
+	EXPECT_EQ(cache.erase_range("user:", "user;"), 2);
+	EXPECT_EQ(cache.top_k(5).size(), 1);
+}
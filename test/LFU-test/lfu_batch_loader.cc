@@ -0,0 +1,220 @@
+#include <gtest/gtest.h>
+#include <caches/LFU/LFU.hpp>
+#include <caches/batch_loader.hpp>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace
+{
+	using Shared = cache::LFU<int, int, std::mutex>;
+	using Loader = cache::BatchLoader<int, int, Shared>;
+
+	// Backend that answers key * 10 and remembers every call
+	struct Backend
+	{
+		std::mutex mutex;
+		std::vector<std::vector<int>> calls;
+
+		cache::bulk_loader<int, int> loader()
+		{
+			return [this](const std::vector<int>& keys)
+			{
+				std::lock_guard<std::mutex> g(mutex);
+				calls.push_back(keys);
+
+				std::vector<std::pair<int, int>> values;
+				for (int key : keys)
+					values.emplace_back(key, key * 10);
+				return values;
+			};
+		}
+	};
+
+	cache::batch_loader_options options(std::size_t max_batch, std::chrono::milliseconds window)
+	{
+		cache::batch_loader_options opts;
+		opts.max_batch = max_batch;
+		opts.window = window;
+		return opts;
+	}
+
+	bool ready(const std::shared_future<int>& future)
+	{
+		return future.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+	}
+}
+
+TEST(LFU_BatchLoader, CoalescesConcurrentMisses)
+{
+	Shared shared(100);
+	Backend backend;
+	// A window this long never runs out: only the ninth distinct key dispatches
+	Loader loader(shared, backend.loader(), options(9, std::chrono::hours(1)));
+
+	std::vector<std::thread> callers;
+	for (int t = 0; t < 8; ++t)
+	{
+		callers.emplace_back([&loader, t]
+		{
+			std::shared_future<int> own = loader.get(t);
+			std::shared_future<int> common = loader.get(100);
+			EXPECT_EQ(own.get(), t * 10);
+			EXPECT_EQ(common.get(), 1000);
+		});
+	}
+	for (std::thread& caller : callers)
+		caller.join();
+
+	ASSERT_EQ(backend.calls.size(), 1);
+	EXPECT_EQ(backend.calls[0].size(), 9);
+	EXPECT_EQ(loader.batches(), 1);
+	EXPECT_EQ(loader.pending(), 0);
+	EXPECT_EQ(shared.size(), 9);
+
+	// Now a hit, answered without the backend
+	std::shared_future<int> hit = loader.get(3);
+	EXPECT_TRUE(ready(hit));
+	EXPECT_EQ(hit.get(), 30);
+	EXPECT_EQ(loader.batches(), 1);
+}
+
+TEST(LFU_BatchLoader, WindowDispatchesPartialBatch)
+{
+	Shared shared(100);
+	Backend backend;
+	Loader loader(shared, backend.loader(), options(100, std::chrono::milliseconds(5)));
+
+	std::shared_future<int> first = loader.get(1);
+	std::shared_future<int> again = loader.get(1);
+	EXPECT_EQ(first.get(), 10);
+	EXPECT_EQ(again.get(), 10);
+	EXPECT_EQ(loader.batches(), 1);
+	EXPECT_TRUE(shared.contains(1));
+}
+
+TEST(LFU_BatchLoader, OversizedBatchesSplit)
+{
+	Shared shared(100);
+	Backend backend;
+	Loader loader(shared, backend.loader(), options(4, std::chrono::milliseconds(20)));
+
+	std::vector<std::shared_future<int>> futures;
+	for (int key = 0; key < 10; ++key)
+		futures.push_back(loader.get(key));
+	for (int key = 0; key < 10; ++key)
+		EXPECT_EQ(futures[key].get(), key * 10);
+
+	EXPECT_EQ(loader.batches(), 3);
+	for (const std::vector<int>& call : backend.calls)
+		EXPECT_LE(call.size(), 4);
+}
+
+TEST(LFU_BatchLoader, KeysLeftOutFail)
+{
+	Shared shared(100);
+	shared.enable_negative_cache();
+	Loader loader(shared, [](const std::vector<int>& keys)
+	{
+		std::vector<std::pair<int, int>> values;
+		for (int key : keys)
+			if (key % 2 == 0)
+				values.emplace_back(key, key);
+		return values;
+	}, options(2, std::chrono::hours(1)));
+
+	std::shared_future<int> even = loader.get(2);
+	std::shared_future<int> odd = loader.get(1);
+	EXPECT_EQ(even.get(), 2);
+	EXPECT_THROW(odd.get(), cache::KeyNotFound);
+
+	// The negative cache answers the next time, without a batch
+	std::shared_future<int> known = loader.get(1);
+	EXPECT_TRUE(ready(known));
+	EXPECT_THROW(known.get(), cache::KeyNotFound);
+	EXPECT_EQ(loader.batches(), 1);
+}
+
+TEST(LFU_BatchLoader, BackendErrorFailsTheBatch)
+{
+	Shared shared(100);
+	std::atomic<int> calls{ 0 };
+	Loader loader(shared, [&calls](const std::vector<int>&) -> std::vector<std::pair<int, int>>
+	{
+		if (calls++ == 0)
+			throw std::runtime_error("backend down");
+		return { { 1, 10 } };
+	}, options(1, std::chrono::hours(1)));
+
+	EXPECT_THROW(loader.get(1).get(), std::runtime_error);
+	EXPECT_TRUE(shared.empty());
+
+	// Nothing is remembered about the failure: the next miss tries again
+	EXPECT_EQ(loader.get(1).get(), 10);
+	EXPECT_EQ(loader.batches(), 2);
+}
+
+TEST(LFU_BatchLoader, DestructorLoadsWhatIsQueued)
+{
+	Shared shared(100);
+	Backend backend;
+	std::shared_future<int> future;
+	{
+		Loader loader(shared, backend.loader(), options(100, std::chrono::hours(1)));
+		future = loader.get(7);
+	}
+
+	EXPECT_TRUE(ready(future));
+	EXPECT_EQ(future.get(), 70);
+	EXPECT_TRUE(shared.contains(7));
+}
+
+#if CACHES_HAS_COROUTINES
+namespace
+{
+	struct Task
+	{
+		struct promise_type
+		{
+			Task get_return_object() { return {}; }
+			std::suspend_never initial_suspend() { return {}; }
+			std::suspend_never final_suspend() noexcept { return {}; }
+			void return_void() { }
+			void unhandled_exception() { std::terminate(); }
+		};
+	};
+
+	Task fetch(Loader& loader, int key, std::atomic<int>& out)
+	{
+		out = co_await loader.get_async(key);
+	}
+}
+
+TEST(LFU_BatchLoader, CoroutinesAwaitTheBatch)
+{
+	Shared shared(100);
+	Backend backend;
+	Loader loader(shared, backend.loader(), options(2, std::chrono::hours(1)));
+
+	std::atomic<int> first{ 0 };
+	std::atomic<int> second{ 0 };
+	fetch(loader, 1, first);
+	EXPECT_EQ(first, 0);
+
+	// The second key fills the batch; both coroutines resume on the loader thread
+	fetch(loader, 2, second);
+	while (first == 0 || second == 0)
+		std::this_thread::yield();
+	EXPECT_EQ(first, 10);
+	EXPECT_EQ(second, 20);
+
+	// A hit does not suspend at all
+	std::atomic<int> hit{ 0 };
+	fetch(loader, 1, hit);
+	EXPECT_EQ(hit, 10);
+	EXPECT_EQ(loader.batches(), 1);
+}
+#endif
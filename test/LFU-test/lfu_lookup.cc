@@ -0,0 +1,103 @@
+#include <gtest/gtest.h>
+#include <caches/LFU/LFU.hpp>
+#include <cstring>
+#include <string>
+#include <tuple>
+
+namespace
+{
+	// FNV-1a over raw bytes so std::string and const char* hash alike
+	struct StringHash
+	{
+		using is_transparent = void;
+
+		std::size_t operator()(const char* s, std::size_t n) const
+		{
+			std::size_t h = 14695981039346656037ull;
+			for (std::size_t i = 0; i < n; ++i)
+				h = (h ^ static_cast<unsigned char>(s[i])) * 1099511628211ull;
+			return h;
+		}
+
+		std::size_t operator()(const std::string& s) const { return (*this)(s.data(), s.size()); }
+		std::size_t operator()(const char* s) const { return (*this)(s, std::strlen(s)); }
+	};
+
+	struct StringEqual
+	{
+		using is_transparent = void;
+
+		bool operator()(const std::string& a, const std::string& b) const { return a == b; }
+		bool operator()(const std::string& a, const char* b) const { return a == b; }
+		bool operator()(const char* a, const std::string& b) const { return b == a; }
+	};
+
+	using StringLFU = cache::LFU<std::string, int, cache::NullLock, StringHash, StringEqual>;
+}
+
+TEST(LFU_Lookup, TransparentHash)
+{
+	StringLFU cache(2);
+
+	cache.insert("a rather long key that does not fit into SSO", 1);
+	cache.insert("short", 2);
+
+	const char* longKey = "a rather long key that does not fit into SSO";
+	EXPECT_TRUE(cache.contains(longKey));
+	EXPECT_EQ(cache.peek(longKey), 1);
+	EXPECT_EQ(cache.get("short"), 2);
+	EXPECT_FALSE(cache.contains("missing"));
+	EXPECT_THROW(cache.get("missing"), cache::KeyNotFound);
+
+	EXPECT_TRUE(cache.erase(longKey));
+	EXPECT_FALSE(cache.erase(longKey));
+	EXPECT_EQ(cache.size(), 1);
+}
+
+TEST(LFU_Lookup, PrecomputedHash)
+{
+	StringLFU cache(2);
+
+	std::string key = "routed by hash";
+	std::size_t hash = cache.hash_function()(key);
+
+	cache.insert(key, hash, 7);
+	EXPECT_TRUE(cache.contains(key, hash));
+	EXPECT_TRUE(cache.contains(key.c_str(), hash));
+	EXPECT_EQ(cache.get(key, hash), 7);
+	EXPECT_EQ(cache.peek(key), 7);
+
+	cache.insert(key, hash, 8);
+	EXPECT_EQ(cache.size(), 1);
+	EXPECT_EQ(cache.peek(key, hash), 8);
+
+	EXPECT_TRUE(cache.erase(key, hash));
+	EXPECT_TRUE(cache.empty());
+}
+
+TEST(LFU_Lookup, PrecomputedHashDefaultHasher)
+{
+	cache::LFU<std::string, int> cache(4);
+
+	std::string key = "plain std::hash";
+	std::size_t hash = std::hash<std::string>()(key);
+
+	cache.insert(key, hash, 1);
+	EXPECT_TRUE(cache.contains(key));
+	EXPECT_EQ(cache.get(key, hash), 1);
+}
+
+TEST(LFU_Lookup, TransparentOrderedKeys)
+{
+	using Key = std::tuple<int, int>;
+	cache::LFU<Key, int, cache::NullLock, std::hash<Key>, std::equal_to<Key>, std::less<>> cache(4);
+
+	cache.insert(Key(1, 2), 12);
+	cache.insert(Key(3, 4), 34);
+
+	// Looked up through std::less<> without building a Key
+	EXPECT_TRUE(cache.contains(std::tuple<long, long>(1, 2)));
+	EXPECT_EQ(cache.get(std::tuple<long, long>(3, 4)), 34);
+	EXPECT_TRUE(cache.erase(std::tuple<long, long>(1, 2)));
+	EXPECT_FALSE(cache.contains(Key(1, 2)));
+}
@@ -0,0 +1,181 @@
+#include <gtest/gtest.h>
+#include <caches/LFU/LFU.hpp>
+#include <caches/cache_manager.hpp>
+#include <chrono>
+#include <thread>
+
+namespace
+{
+	// Reads keys [0, n) through the cache, loading every miss
+	template<class Cache>
+	void sweep(Cache& cache, int n)
+	{
+		for (int i = 0; i < n; ++i)
+		{
+			try
+			{
+				cache.get(i);
+			}
+			catch (const cache::KeyNotFound&)
+			{
+				cache.insert(i, i);
+			}
+		}
+	}
+}
+
+TEST(LFU_Stats, CountsHitsMissesEvictions)
+{
+	cache::LFU<int, int> cache(2);
+
+	cache.insert(1, 1);
+	cache.insert(2, 2);
+	cache.insert(3, 3);
+	cache.get(3);
+	EXPECT_THROW(cache.get(1), cache::KeyNotFound);
+	cache.peek(2);
+
+	cache::cache_stats stats = cache.stats();
+	EXPECT_EQ(stats.hits, 1);
+	EXPECT_EQ(stats.misses, 1);
+	EXPECT_EQ(stats.evictions, 1);
+}
+
+TEST(LFU_Manager, AttachWithinBudget)
+{
+	cache::CacheManager manager(100);
+	cache::LFU<int, int> a(30), b(50), c(40);
+
+	manager.attach(a);
+	manager.attach(b);
+	EXPECT_EQ(a.capacity(), 30);
+	EXPECT_EQ(b.capacity(), 50);
+
+	// Only what is left of the budget
+	manager.attach(c);
+	EXPECT_EQ(c.capacity(), 20);
+	EXPECT_EQ(manager.granted(), 100);
+
+	manager.detach(b);
+	EXPECT_EQ(manager.granted(), 50);
+}
+
+TEST(LFU_Manager, ExhaustedBudgetStillGivesMinimum)
+{
+	cache::CacheManager manager(10);
+	cache::LFU<int, int> a(10), b(5);
+
+	manager.attach(a);
+	manager.attach(b);
+	EXPECT_EQ(a.capacity(), 9);
+	EXPECT_EQ(b.capacity(), 1);
+	EXPECT_EQ(manager.granted(), 10);
+}
+
+TEST(LFU_Manager, MovesBudgetToThrashingCache)
+{
+	cache::CacheManager::options opts;
+	opts.step = 0.1;
+	opts.cooldown = 0;
+
+	cache::CacheManager manager(100, cache::budget_unit::entries, opts);
+	cache::LFU<int, int> idle(50), busy(50);
+	manager.attach(idle);
+	manager.attach(busy);
+
+	for (int round = 0; round < 20; ++round)
+	{
+		sweep(idle, 10);
+		sweep(busy, 80);
+		manager.rebalance();
+	}
+
+	// The idle cache gave back what it never used, the busy one now fits its working set
+	EXPECT_GE(busy.capacity(), 80);
+	EXPECT_GE(idle.capacity(), 10);
+	EXPECT_LE(idle.capacity() + busy.capacity(), 100);
+	EXPECT_EQ(idle.size(), 10);
+}
+
+TEST(LFU_Manager, HysteresisKeepsEqualCachesStill)
+{
+	cache::CacheManager::options opts;
+	opts.cooldown = 0;
+
+	cache::CacheManager manager(100, cache::budget_unit::entries, opts);
+	cache::LFU<int, int> a(50), b(50);
+	manager.attach(a);
+	manager.attach(b);
+
+	for (int round = 0; round < 5; ++round)
+	{
+		sweep(a, 80);
+		sweep(b, 80);
+		manager.rebalance();
+	}
+	EXPECT_EQ(a.capacity(), 50);
+	EXPECT_EQ(b.capacity(), 50);
+}
+
+TEST(LFU_Manager, CooldownAfterTransfer)
+{
+	cache::CacheManager manager(100);
+	cache::LFU<int, int> full(50), busy(50);
+	manager.attach(full);
+	manager.attach(busy);
+	sweep(full, 50);
+
+	sweep(busy, 80);
+	manager.rebalance();
+	EXPECT_EQ(busy.capacity(), 55);
+	EXPECT_EQ(full.capacity(), 45);
+
+	sweep(busy, 80);
+	manager.rebalance();
+	EXPECT_EQ(busy.capacity(), 55);
+
+	sweep(busy, 80);
+	manager.rebalance();
+	EXPECT_EQ(busy.capacity(), 60);
+	EXPECT_EQ(manager.granted(), 100);
+}
+
+TEST(LFU_Manager, ByteBudget)
+{
+	cache::LFU<int, int> cache(100);
+	for (int i = 0; i < 100; ++i)
+		cache.insert(i, i);
+
+	const std::size_t perEntry = cache.memory_usage().total() / 100;
+	cache::CacheManager manager(50 * perEntry, cache::budget_unit::bytes);
+	manager.attach(cache);
+
+	EXPECT_EQ(manager.granted(), 50 * perEntry);
+	EXPECT_EQ(cache.capacity(), 50);
+	EXPECT_EQ(cache.size(), 50);
+
+	std::vector<cache::managed_cache_report> report = manager.report();
+	ASSERT_EQ(report.size(), 1);
+	EXPECT_EQ(report[0].cache, &cache);
+	EXPECT_EQ(report[0].share, 50 * perEntry);
+}
+
+TEST(LFU_Manager, BackgroundRebalance)
+{
+	cache::CacheManager manager(100);
+	cache::LFU<int, int, std::mutex> a(50), b(50);
+	manager.attach(a);
+	manager.attach(b);
+	sweep(a, 50);
+
+	manager.start(std::chrono::milliseconds(1));
+	for (int i = 0; i < 200 && b.capacity() == 50; ++i)
+	{
+		sweep(b, 80);
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	manager.stop();
+
+	EXPECT_GT(b.capacity(), 50);
+	EXPECT_EQ(manager.granted(), 100);
+}
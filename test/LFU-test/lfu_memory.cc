@@ -0,0 +1,58 @@
+#include <gtest/gtest.h>
+#include <caches/LFU/LFU.hpp>
+#include <string>
+#include <vector>
+
+TEST(LFU_Memory, Empty)
+{
+	cache::LFU<int, int> cache(16);
+
+	cache::memory_stats stats = cache.memory_usage();
+	EXPECT_EQ(stats.node_bytes, 0);
+	EXPECT_EQ(stats.value_heap_bytes, 0);
+}
+
+// A non-default hash keeps int keys on the chained HashIndex
+struct ChainedHash
+{
+	std::size_t operator()(int key) const
+	{
+		return std::hash<int>()(key);
+	}
+};
+
+TEST(LFU_Memory, GrowsAndShrinksWithEntries)
+{
+	cache::LFU<int, int, cache::NullLock, ChainedHash> cache(1024);
+
+	for (int i = 0; i < 1000; ++i)
+		cache.insert(i, i);
+
+	cache::memory_stats full = cache.memory_usage();
+	EXPECT_GT(full.node_bytes, 1000 * 2 * sizeof(int));
+
+	// All entries share one frequency bucket; the rest is per-node links
+	std::size_t overhead = (full.node_bytes + full.index_bytes) / 1000 - 2 * sizeof(int);
+	EXPECT_LE(overhead, 5 * sizeof(void*) + 2 * sizeof(void*));
+
+	cache.set_capacity(10);
+	EXPECT_LT(cache.memory_usage().node_bytes, full.node_bytes);
+
+	cache.clear();
+	EXPECT_EQ(cache.memory_usage().node_bytes, 0);
+}
+
+TEST(LFU_Memory, ValueHeapCallback)
+{
+	cache::LFU<int, std::vector<int>> cache(4);
+
+	cache.insert(1, std::vector<int>(10));
+	cache.insert(2, std::vector<int>(20));
+	cache.get(2);
+
+	cache::memory_stats stats = cache.memory_usage([](const std::vector<int>& v)
+	{
+		return v.capacity() * sizeof(int);
+	});
+	EXPECT_EQ(stats.value_heap_bytes, 30 * sizeof(int));
+}
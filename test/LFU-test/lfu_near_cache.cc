@@ -0,0 +1,185 @@
+#include <gtest/gtest.h>
+#include <caches/LFU/LFU.hpp>
+#include <caches/near_cache.hpp>
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+	using Shared = cache::LFU<int, std::string, std::mutex>;
+	using Near = cache::NearCache<int, std::string, Shared>;
+}
+
+TEST(LFU_NearCache, RepeatedReadsStayInL1)
+{
+	Shared shared(100);
+	Near near(shared);
+	near.insert(1, "one");
+
+	EXPECT_EQ(near.get(1), "one");
+	EXPECT_EQ(near.get(1), "one");
+	EXPECT_EQ(near.get(1), "one");
+	EXPECT_THROW(near.get(2), cache::KeyNotFound);
+
+	cache::near_cache_stats stats = near.stats();
+	EXPECT_EQ(stats.l1_hits, 2);
+	EXPECT_EQ(stats.l2_hits, 1);
+	EXPECT_EQ(stats.misses, 1);
+
+	// L2 saw only the first read and the miss
+	EXPECT_EQ(shared.stats().hits, 1);
+	EXPECT_EQ(shared.stats().misses, 1);
+}
+
+TEST(LFU_NearCache, WritesDropOtherThreadsCopies)
+{
+	Shared shared(100);
+	Near near(shared);
+	near.insert(1, "one");
+
+	std::atomic<int> step{ 0 };
+	std::thread reader([&]
+	{
+		EXPECT_EQ(near.get(1), "one");
+		EXPECT_EQ(near.get(1), "one");
+		step = 1;
+		while (step != 2)
+			std::this_thread::yield();
+
+		EXPECT_EQ(near.get(1), "uno");
+		step = 3;
+		while (step != 4)
+			std::this_thread::yield();
+
+		EXPECT_THROW(near.get(1), cache::KeyNotFound);
+	});
+
+	while (step != 1)
+		std::this_thread::yield();
+	near.insert(1, "uno");
+	step = 2;
+
+	while (step != 3)
+		std::this_thread::yield();
+	EXPECT_TRUE(near.erase(1));
+	step = 4;
+	reader.join();
+
+	cache::near_cache_stats stats = near.stats();
+	EXPECT_EQ(stats.l1_hits, 1);
+	EXPECT_EQ(stats.l2_hits, 2);
+	EXPECT_EQ(stats.misses, 1);
+}
+
+TEST(LFU_NearCache, DirectL2WritesNeedInvalidateAll)
+{
+	Shared shared(100);
+	Near near(shared);
+	near.insert(1, "one");
+	EXPECT_EQ(near.get(1), "one");
+
+	shared.insert(1, std::string("uno"));
+	EXPECT_EQ(near.get(1), "one");
+
+	near.invalidate_all();
+	EXPECT_EQ(near.get(1), "uno");
+
+	near.clear();
+	EXPECT_TRUE(shared.empty());
+	EXPECT_THROW(near.get(1), cache::KeyNotFound);
+}
+
+TEST(LFU_NearCache, CollidingKeysShareASlot)
+{
+	Shared shared(100);
+	Near near(shared, 1);
+	EXPECT_EQ(near.l1_size(), 1);
+
+	near.insert(1, "one");
+	near.insert(2, "two");
+	near.get(1);
+	near.get(2);
+	near.get(1);
+	EXPECT_EQ(near.stats().l1_hits, 0);
+	EXPECT_EQ(near.stats().l2_hits, 3);
+
+	Near rounded(shared, 100);
+	EXPECT_EQ(rounded.l1_size(), 128);
+}
+
+TEST(LFU_NearCache, LookupPassesAbsenceThrough)
+{
+	Shared shared(100);
+	shared.enable_negative_cache();
+	Near near(shared);
+
+	near.insert(1, "one");
+	shared.insert_absent(2);
+
+	std::string out;
+	EXPECT_EQ(near.lookup(1, out), cache::lookup_status::hit);
+	EXPECT_EQ(out, "one");
+	EXPECT_EQ(near.lookup(1, out), cache::lookup_status::hit);
+	EXPECT_EQ(near.lookup(2, out), cache::lookup_status::known_absent);
+	EXPECT_EQ(near.lookup(3, out), cache::lookup_status::unknown);
+
+	EXPECT_EQ(near.stats().l1_hits, 1);
+	EXPECT_EQ(near.stats().misses, 2);
+}
+
+TEST(LFU_NearCache, StatsSumOverThreads)
+{
+	Shared shared(100);
+	Near near(shared);
+	near.insert(1, "one");
+
+	std::vector<std::thread> readers;
+	for (int t = 0; t < 4; ++t)
+	{
+		readers.emplace_back([&]
+		{
+			for (int i = 0; i < 100; ++i)
+				near.get(1);
+		});
+	}
+	for (std::thread& reader : readers)
+		reader.join();
+
+	cache::near_cache_stats stats = near.stats();
+	EXPECT_EQ(stats.l2_hits, 4);
+	EXPECT_EQ(stats.l1_hits, 396);
+}
+
+TEST(LFU_NearCache, ReadersNeverGoBackInTime)
+{
+	cache::LFU<int, int, std::mutex> shared(16);
+	cache::NearCache<int, int, cache::LFU<int, int, std::mutex>> near(shared, 4);
+	near.insert(0, 0);
+
+	std::atomic<bool> done{ false };
+	std::vector<std::thread> readers;
+	for (int t = 0; t < 3; ++t)
+	{
+		readers.emplace_back([&]
+		{
+			int last = 0;
+			while (!done)
+			{
+				int seen = near.get(0);
+				EXPECT_GE(seen, last);
+				last = seen;
+			}
+		});
+	}
+
+	for (int value = 1; value <= 20000; ++value)
+		near.insert(0, value);
+	done = true;
+	for (std::thread& reader : readers)
+		reader.join();
+
+	EXPECT_EQ(near.get(0), 20000);
+}
@@ -0,0 +1,148 @@
+#include <gtest/gtest.h>
+#include <caches/LFU/LFU.hpp>
+#include <chrono>
+#include <string>
+#include <thread>
+
+TEST(LFU_Negative, TellsHitAbsentAndUnknownApart)
+{
+	cache::LFU<int, std::string> cache(10);
+	cache.insert(1, std::string("one"));
+
+	// Off by default: absences are not recorded
+	cache.insert_absent(2);
+	std::string out;
+	EXPECT_EQ(cache.lookup(2, out), cache::lookup_status::unknown);
+
+	cache.enable_negative_cache();
+	cache.insert_absent(2);
+
+	EXPECT_EQ(cache.lookup(1, out), cache::lookup_status::hit);
+	EXPECT_EQ(out, "one");
+	EXPECT_EQ(cache.lookup(2, out), cache::lookup_status::known_absent);
+	EXPECT_EQ(cache.lookup(3, out), cache::lookup_status::unknown);
+	EXPECT_EQ(out, "one");
+
+	cache::cache_stats stats = cache.stats();
+	EXPECT_EQ(stats.hits, 1);
+	EXPECT_EQ(stats.negative_hits, 1);
+	EXPECT_EQ(stats.misses, 2);
+}
+
+TEST(LFU_Negative, ValuesAndAbsenceReplaceEachOther)
+{
+	cache::LFU<int, int> cache(10);
+	cache.enable_negative_cache();
+	int out = 0;
+
+	cache.insert_absent(5);
+	cache.insert(5, 50);
+	EXPECT_EQ(cache.lookup(5, out), cache::lookup_status::hit);
+	EXPECT_EQ(out, 50);
+
+	// Neither the exact list nor the filter still claims it is absent
+	cache.erase(5);
+	EXPECT_EQ(cache.lookup(5, out), cache::lookup_status::unknown);
+
+	cache.insert(6, 60);
+	cache.insert_absent(6);
+	EXPECT_FALSE(cache.contains(6));
+	EXPECT_EQ(cache.lookup(6, out), cache::lookup_status::known_absent);
+
+	cache.clear();
+	EXPECT_EQ(cache.lookup(6, out), cache::lookup_status::unknown);
+}
+
+TEST(LFU_Negative, AbsentKeysTakeNoCapacity)
+{
+	cache::LFU<int, int> cache(2);
+	cache.enable_negative_cache();
+	cache.insert(1, 1);
+	cache.insert(2, 2);
+
+	for (int key = 100; key < 200; ++key)
+		cache.insert_absent(key);
+
+	EXPECT_EQ(cache.size(), 2);
+	EXPECT_TRUE(cache.contains(1));
+	EXPECT_TRUE(cache.contains(2));
+	int out;
+	for (int key = 100; key < 200; ++key)
+		EXPECT_EQ(cache.lookup(key, out), cache::lookup_status::known_absent);
+}
+
+TEST(LFU_Negative, FilterCoversOlderKeys)
+{
+	cache::negative_cache_options opts;
+	opts.exact = 16;
+	opts.filter_keys = 10000;
+
+	cache::LFU<int, int> cache(10);
+	cache.enable_negative_cache(opts);
+	for (int key = 0; key < 5000; ++key)
+		cache.insert_absent(key);
+
+	int out;
+	for (int key = 0; key < 5000; ++key)
+		ASSERT_EQ(cache.lookup(key, out), cache::lookup_status::known_absent) << "key " << key;
+
+	// Keys never recorded only rarely look absent
+	std::size_t falsePositives = 0;
+	for (int key = 100000; key < 200000; ++key)
+		falsePositives += cache.lookup(key, out) == cache::lookup_status::known_absent;
+	EXPECT_LT(falsePositives, 100);
+}
+
+TEST(LFU_Negative, FullFilterRotates)
+{
+	cache::negative_cache_options opts;
+	opts.exact = 16;
+	opts.filter_keys = 64;
+
+	cache::LFU<int, int> cache(10);
+	cache.enable_negative_cache(opts);
+	for (int key = 0; key < 10000; ++key)
+		cache.insert_absent(key);
+
+	int out;
+	for (int key = 10000 - 16; key < 10000; ++key)
+		EXPECT_EQ(cache.lookup(key, out), cache::lookup_status::known_absent);
+
+	std::size_t stillAbsent = 0;
+	for (int key = 0; key < 10000; ++key)
+		stillAbsent += cache.lookup(key, out) == cache::lookup_status::known_absent;
+	EXPECT_LT(stillAbsent, 500);
+}
+
+TEST(LFU_Negative, AbsenceExpires)
+{
+	cache::negative_cache_options opts;
+	opts.ttl = std::chrono::milliseconds(20);
+
+	cache::LFU<int, int> cache(10);
+	cache.enable_negative_cache(opts);
+	cache.insert_absent(1);
+
+	int out;
+	EXPECT_EQ(cache.lookup(1, out), cache::lookup_status::known_absent);
+	std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	EXPECT_EQ(cache.lookup(1, out), cache::lookup_status::unknown);
+}
+
+TEST(LFU_Negative, FilterMemoryIsFixed)
+{
+	cache::LFU<int, int> cache(10);
+	std::size_t before = cache.memory_usage().index_bytes;
+
+	cache::negative_cache_options opts;
+	opts.exact = 0;
+	opts.filter_keys = 10000;
+	cache.enable_negative_cache(opts);
+	std::size_t enabled = cache.memory_usage().index_bytes;
+	EXPECT_GE(enabled - before, 2 * 10000 * sizeof(std::uint16_t));
+	EXPECT_LE(enabled - before, 8 * 10000 * sizeof(std::uint16_t));
+
+	for (int key = 0; key < 9000; ++key)
+		cache.insert_absent(key);
+	EXPECT_EQ(cache.memory_usage().index_bytes, enabled);
+}
@@ -0,0 +1,89 @@
+#include <gtest/gtest.h>
+#include <caches/LFU/LFU.hpp>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace
+{
+	using TenantKey = std::tuple<int, int, int>; // tenant, object, version
+
+	void fill(cache::LFU<TenantKey, int>& cache)
+	{
+		for (int tenant = 0; tenant < 3; ++tenant)
+			for (int object = 0; object < 4; ++object)
+				for (int version = 0; version < 2; ++version)
+					cache.insert(TenantKey(tenant, object, version), tenant * 100 + object * 10 + version);
+	}
+}
+
+TEST(LFU_Range, ErasePrefixDropsOneTenant)
+{
+	cache::LFU<TenantKey, int> cache(100);
+	fill(cache);
+
+	EXPECT_EQ(cache.erase_prefix(std::make_tuple(1)), 8);
+	EXPECT_EQ(cache.size(), 16);
+	EXPECT_FALSE(cache.contains(TenantKey(1, 0, 0)));
+	EXPECT_FALSE(cache.contains(TenantKey(1, 3, 1)));
+	EXPECT_TRUE(cache.contains(TenantKey(0, 3, 1)));
+	EXPECT_TRUE(cache.contains(TenantKey(2, 0, 0)));
+
+	EXPECT_EQ(cache.erase_prefix(std::make_tuple(2, 3)), 2);
+	EXPECT_EQ(cache.erase_prefix(std::make_tuple(7)), 0);
+	EXPECT_EQ(cache.size(), 14);
+
+	// Removed entries are gone from the frequency buckets as well
+	for (int i = 0; i < 100; ++i)
+		cache.insert(TenantKey(9, i, 0), i);
+	EXPECT_EQ(cache.size(), 100);
+}
+
+TEST(LFU_Range, EraseRangeIsHalfOpen)
+{
+	cache::LFU<TenantKey, int> cache(100);
+	fill(cache);
+
+	EXPECT_EQ(cache.erase_range(TenantKey(0, 2, 0), TenantKey(1, 1, 0)), 6);
+	EXPECT_TRUE(cache.contains(TenantKey(0, 1, 1)));
+	EXPECT_FALSE(cache.contains(TenantKey(0, 2, 0)));
+	EXPECT_FALSE(cache.contains(TenantKey(1, 0, 1)));
+	EXPECT_TRUE(cache.contains(TenantKey(1, 1, 0)));
+
+	EXPECT_EQ(cache.erase_range(TenantKey(2, 0, 0), TenantKey(1, 0, 0)), 0);
+	EXPECT_EQ(cache.erase_range(TenantKey(2, 0, 0), TenantKey(2, 0, 0)), 0);
+	EXPECT_EQ(cache.size(), 18);
+}
+
+TEST(LFU_Range, ForEachInRangeInKeyOrder)
+{
+	cache::LFU<TenantKey, int> cache(100);
+	fill(cache);
+
+	std::vector<int> seen;
+	cache.for_each_in_range(TenantKey(2, 2, 0), TenantKey(3, 0, 0), [&](const TenantKey&, int& value)
+	{
+		seen.push_back(value);
+		value = -value;
+	});
+
+	EXPECT_EQ(seen, (std::vector<int>{ 220, 221, 230, 231 }));
+	EXPECT_EQ(cache.peek(TenantKey(2, 3, 1)), -231);
+}
+
+TEST(LFU_Range, PairPrefixAndDeferredReclaim)
+{
+	cache::LFU<std::pair<std::string, int>, int> cache(100);
+	cache.set_reclaim_mode(cache::reclaim_mode::deferred);
+
+	for (int i = 0; i < 20; ++i)
+	{
+		cache.insert(std::make_pair(std::string("a"), i), i);
+		cache.insert(std::make_pair(std::string("b"), i), i);
+	}
+
+	EXPECT_EQ(cache.erase_prefix(std::string("a")), 20);
+	EXPECT_EQ(cache.size(), 20);
+	EXPECT_EQ(cache.pending_reclaim(), 20 - cache::reclaim_chunk);
+}
@@ -0,0 +1,112 @@
+#include <gtest/gtest.h>
+#include <caches/LFU/LFU.hpp>
+#include <caches/reclaimer.hpp>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+
+namespace
+{
+	std::atomic<int> destroyed(0);
+
+	struct Counted
+	{
+		int v;
+
+		Counted(int v) : v(v) { }
+		Counted(const Counted& other) : v(other.v) { }
+		Counted& operator=(const Counted&) = default;
+		~Counted() { ++destroyed; }
+	};
+}
+
+TEST(LFU_Reclaim, ImmediateByDefault)
+{
+	cache::LFU<int, Counted> cache(4);
+
+	for (int i = 0; i < 4; ++i)
+		cache.emplace(i, i);
+
+	destroyed = 0;
+	cache.clear();
+	EXPECT_EQ(destroyed, 4);
+	EXPECT_EQ(cache.pending_reclaim(), 0);
+}
+
+TEST(LFU_Reclaim, DeferredClear)
+{
+	cache::LFU<int, Counted> cache(100);
+	cache.set_reclaim_mode(cache::reclaim_mode::deferred);
+
+	for (int i = 0; i < 100; ++i)
+		cache.emplace(i, i);
+
+	destroyed = 0;
+	cache.clear();
+	EXPECT_TRUE(cache.empty());
+
+	// Every mutating call frees only a bounded chunk on its way out
+	const std::size_t pending = 100 - cache::reclaim_chunk;
+	EXPECT_EQ(destroyed, cache::reclaim_chunk);
+	EXPECT_EQ(cache.pending_reclaim(), pending);
+	EXPECT_GE(cache.memory_usage().node_bytes, pending * sizeof(Counted));
+
+	EXPECT_EQ(cache.reclaim(30), 30);
+	EXPECT_EQ(destroyed, cache::reclaim_chunk + 30);
+
+	cache.emplace(1, 1);
+	EXPECT_EQ(cache.pending_reclaim(), pending - 30 - cache::reclaim_chunk);
+
+	EXPECT_EQ(cache.reclaim(), pending - 30 - cache::reclaim_chunk);
+	EXPECT_EQ(cache.pending_reclaim(), 0);
+	EXPECT_EQ(destroyed, 100);
+}
+
+TEST(LFU_Reclaim, DeferredEviction)
+{
+	cache::LFU<int, Counted> cache(1);
+	cache.set_reclaim_mode(cache::reclaim_mode::deferred);
+
+	destroyed = 0;
+	cache.emplace(1, 1);
+	cache.emplace(2, 2);
+	EXPECT_FALSE(cache.contains(1));
+
+	// The evicted node was retired under the lock and freed on the way out
+	EXPECT_EQ(cache.pending_reclaim(), 0);
+	EXPECT_EQ(destroyed, 1);
+}
+
+TEST(LFU_Reclaim, ShrinkInSteps)
+{
+	const std::size_t total = 3 * cache::shrink_step + 7;
+	cache::LFU<std::size_t, Counted> cache(total);
+
+	for (std::size_t i = 0; i < total; ++i)
+		cache.emplace(i, 0);
+
+	cache.get(0);
+	cache.set_capacity(5);
+	EXPECT_EQ(cache.size(), 5);
+	EXPECT_TRUE(cache.contains(0));
+	EXPECT_EQ(cache.pending_reclaim(), 0);
+}
+
+TEST(LFU_Reclaim, BackgroundReclaimer)
+{
+	cache::LFU<int, Counted, std::mutex> cache(1000);
+	cache::Reclaimer reclaimer(std::chrono::milliseconds(1), 64);
+	reclaimer.attach(cache);
+
+	for (int i = 0; i < 1000; ++i)
+		cache.emplace(i, i);
+	cache.clear();
+
+	auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+	while (cache.pending_reclaim() != 0 && std::chrono::steady_clock::now() < deadline)
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+	EXPECT_EQ(cache.pending_reclaim(), 0);
+	reclaimer.detach(cache);
+}
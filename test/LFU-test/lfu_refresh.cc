@@ -0,0 +1,213 @@
+#include <gtest/gtest.h>
+#include <caches/LFU/LFU.hpp>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+namespace
+{
+	// Holds reloads back until the test lets them through
+	struct Gate
+	{
+		void wait()
+		{
+			std::unique_lock<std::mutex> lk(mutex);
+			cv.wait(lk, [this] { return open; });
+		}
+
+		void release()
+		{
+			{
+				std::lock_guard<std::mutex> g(mutex);
+				open = true;
+			}
+			cv.notify_all();
+		}
+
+		std::mutex mutex;
+		std::condition_variable cv;
+		bool open = false;
+	};
+
+	const std::chrono::milliseconds always(0);
+	const std::chrono::milliseconds never = std::chrono::hours(1);
+}
+
+TEST(LFU_Refresh, StaleHitReturnsCachedValueAndReloads)
+{
+	cache::RefreshPool pool(1);
+	Gate gate;
+	std::atomic<int> loads(0);
+	cache::LFU<int, std::string, std::mutex> cache(10);
+	cache.enable_refresh_ahead([&](const int& key)
+	{
+		gate.wait();
+		return "fresh " + std::to_string(key) + "#" + std::to_string(++loads);
+	}, pool, always);
+
+	cache.insert(1, std::string("old"));
+	EXPECT_EQ(cache.get(1), "old");
+	gate.release();
+	pool.wait_idle();
+
+	EXPECT_EQ(loads, 1);
+	EXPECT_EQ(cache.peek(1), "fresh 1#1");
+	EXPECT_THROW(cache.get(2), cache::KeyNotFound);
+	pool.wait_idle();
+	EXPECT_EQ(loads, 1);
+}
+
+TEST(LFU_Refresh, FreshEntriesAreNotReloaded)
+{
+	cache::RefreshPool pool(1);
+	std::atomic<int> loads(0);
+	cache::LFU<int, int, std::mutex> cache(10);
+	cache.insert(1, 1);   // written before enabling: never refreshed
+	cache.enable_refresh_ahead([&loads](const int&) { return ++loads; }, pool, never);
+
+	cache.insert(2, 2);
+	for (int i = 0; i < 10; ++i)
+	{
+		cache.get(1);
+		cache.get(2);
+	}
+	pool.wait_idle();
+	EXPECT_EQ(loads, 0);
+}
+
+TEST(LFU_Refresh, OneReloadPerKeyAtATime)
+{
+	cache::RefreshPool pool(2);
+	Gate gate;
+	std::atomic<int> loads(0);
+	cache::LFU<int, int, std::mutex> cache(10);
+	cache.enable_refresh_ahead([&](const int&) { ++loads; gate.wait(); return 42; }, pool, always);
+
+	cache.insert(1, 1);
+	for (int i = 0; i < 100; ++i)
+		EXPECT_EQ(cache.get(1), 1);
+
+	gate.release();
+	pool.wait_idle();
+	EXPECT_EQ(loads, 1);
+	EXPECT_EQ(cache.peek(1), 42);
+}
+
+TEST(LFU_Refresh, ReloadDoesNotCountAsUse)
+{
+	cache::RefreshPool pool(1);
+	Gate gate;
+	cache::LFU<int, int, std::mutex> cache(3);
+	cache.enable_refresh_ahead([&](const int& key) { gate.wait(); return key * 10; }, pool, always);
+
+	cache.insert(1, 1);
+	cache.insert(2, 2);
+	cache.insert(3, 3);
+	cache.get(1);
+	cache.get(2);
+	cache.get(2);
+	cache.get(3);
+	cache.get(3);
+
+	gate.release();
+	pool.wait_idle();
+	EXPECT_EQ(cache.peek(1), 10);
+
+	cache.insert(4, 4);
+	EXPECT_FALSE(cache.contains(1));
+	EXPECT_TRUE(cache.contains(2));
+	EXPECT_TRUE(cache.contains(3));
+}
+
+TEST(LFU_Refresh, FailedReloadKeepsValue)
+{
+	cache::RefreshPool pool(1);
+	std::atomic<int> loads(0);
+	cache::LFU<int, std::string, std::mutex> cache(10);
+	cache.enable_refresh_ahead([&loads](const int&) -> std::string
+	{
+		if (++loads == 1)
+			throw std::runtime_error("backend down");
+		return "fresh";
+	}, pool, always);
+
+	cache.insert(1, std::string("old"));
+	cache.get(1);
+	pool.wait_idle();
+	EXPECT_EQ(cache.peek(1), "old");
+
+	// The next hit tries again
+	cache.get(1);
+	pool.wait_idle();
+	EXPECT_EQ(loads, 2);
+	EXPECT_EQ(cache.peek(1), "fresh");
+}
+
+TEST(LFU_Refresh, WritesAndErasesDuringReloadWin)
+{
+	cache::RefreshPool pool(1);
+	Gate gate;
+	cache::LFU<int, std::string, std::mutex> cache(10);
+	cache.enable_refresh_ahead([&](const int&) { gate.wait(); return std::string("reloaded"); }, pool, always);
+
+	cache.insert(1, std::string("a"));
+	cache.insert(2, std::string("b"));
+	cache.get(1);
+	cache.get(2);
+	cache.insert(1, std::string("written"));
+	cache.erase(2);
+
+	gate.release();
+	pool.wait_idle();
+	EXPECT_EQ(cache.peek(1), "written");
+	EXPECT_FALSE(cache.contains(2));
+}
+
+TEST(LFU_Refresh, DestroyedCacheSkipsQueuedReloads)
+{
+	cache::RefreshPool pool(1);
+	Gate gate;
+	std::atomic<int> loads(0);
+	pool.submit([&gate] { gate.wait(); });
+
+	{
+		cache::LFU<int, int, std::mutex> cache(10);
+		cache.enable_refresh_ahead([&loads](const int&) { return ++loads; }, pool, always);
+		cache.insert(1, 1);
+		cache.get(1);
+		EXPECT_EQ(pool.pending(), 2);
+	}
+
+	gate.release();
+	pool.wait_idle();
+	EXPECT_EQ(loads, 0);
+}
+
+TEST(LFU_Refresh, FullQueueRetriesLater)
+{
+	cache::RefreshPool pool(1, 1);
+	Gate gate;
+	std::atomic<int> loads(0);
+	std::atomic<bool> busy(false);
+	pool.submit([&] { busy = true; gate.wait(); });
+	while (!busy)
+		std::this_thread::yield();
+	pool.submit([] { });   // busy worker, full queue
+
+	cache::LFU<int, int, std::mutex> cache(10);
+	cache.enable_refresh_ahead([&loads](const int&) { return 100 + ++loads; }, pool, always);
+	cache.insert(1, 1);
+	cache.get(1);
+
+	gate.release();
+	pool.wait_idle();
+	EXPECT_EQ(loads, 0);
+
+	cache.get(1);
+	pool.wait_idle();
+	EXPECT_EQ(cache.peek(1), 101);
+}
@@ -0,0 +1,50 @@
+#include <gtest/gtest.h>
+#include <caches/LFU/LFU.hpp>
+#include <string>
+#include <vector>
+
+TEST(LFU_TopK, HighestFrequencyFirst)
+{
+	cache::LFU<std::string, int> cache(10);
+
+	cache.insert("a", 1);
+	cache.insert("b", 2);
+	cache.insert("c", 3);
+	cache.insert("d", 4);
+
+	for (int i = 0; i < 5; ++i)
+		cache.get("c");
+	for (int i = 0; i < 3; ++i)
+		cache.get("a");
+	cache.get("d");
+
+	std::vector<cache::hot_key<std::string>> top = cache.top_k(3);
+	ASSERT_EQ(top.size(), 3);
+	EXPECT_EQ(top[0].key, "c");
+	EXPECT_EQ(top[0].count, 5);
+	EXPECT_EQ(top[1].key, "a");
+	EXPECT_EQ(top[1].count, 3);
+	EXPECT_EQ(top[2].key, "d");
+	EXPECT_EQ(top[2].count, 1);
+}
+
+TEST(LFU_TopK, MoreThanSize)
+{
+	cache::LFU<int, int> cache(4);
+	cache.insert(1, 1);
+	cache.insert(2, 2);
+	cache.get(2);
+
+	std::vector<cache::hot_key<int>> top = cache.top_k(10);
+	ASSERT_EQ(top.size(), 2);
+	EXPECT_EQ(top[0].key, 2);
+	EXPECT_EQ(top[1].key, 1);
+
+	EXPECT_TRUE(cache.top_k(0).empty());
+}
+
+TEST(LFU_TopK, Empty)
+{
+	cache::LFU<int, int> cache(4);
+	EXPECT_TRUE(cache.top_k(5).empty());
+}
@@ -27,3 +27,27 @@ TEST(LRU_SFINAE, NonHashableKey)
 	EXPECT_FALSE(cds.contains(NoHash{2}));
 }
 
+TEST(LRU_SFINAE, NonHashableEvictsInsertPosition)
+{
+	struct NoHash
+	{
+		int x;
+		bool operator<(const NoHash& other) const
+		{
+			return x < other.x;
+		}
+	};
+
+	cache::LRU<NoHash, int> cds(2);
+
+	cds.insert(NoHash{3}, 3);
+	cds.insert(NoHash{1}, 1);
+	cds.get(NoHash{1});
+
+	// 3 is both the victim and the neighbour the new key is inserted next to
+	cds.insert(NoHash{2}, 2);
+	EXPECT_FALSE(cds.contains(NoHash{3}));
+	EXPECT_TRUE(cds.contains(NoHash{1}));
+	EXPECT_TRUE(cds.contains(NoHash{2}));
+	EXPECT_EQ(cds.size(), 2);
+}
@@ -0,0 +1,79 @@
+#include <gtest/gtest.h>
+#include <caches/LRU/LRU.hpp>
+#include <string>
+#include <type_traits>
+
+namespace
+{
+	// A lock with state, unlike NullLock, cannot be folded away
+	struct ByteLock
+	{
+		void lock() { }
+		void unlock() { }
+		bool try_lock() { return true; }
+
+		char state = 0;
+	};
+
+	// First in, first out: uses do not reorder anything
+	struct fifo_policy
+	{
+		static constexpr bool counts_uses = false;
+
+		template<class Node>
+		struct hook
+		{ };
+
+		template<class Node>
+		class order : public cache::lru_policy::order<Node>
+		{
+		public:
+			void touch(Node*, std::size_t)
+			{ }
+		};
+	};
+}
+
+TEST(LRU_BasicCache, AliasOfTheCore)
+{
+	static_assert(std::is_same<cache::LRU<int, int>,
+		cache::basic_cache<int, int, cache::lru_policy, cache::auto_index, cache::NullLock>>::value, "");
+}
+
+TEST(LRU_BasicCache, StatelessLockTakesNoSpace)
+{
+	EXPECT_LT(sizeof(cache::LRU<int, int>), sizeof(cache::LRU<int, int, ByteLock>));
+}
+
+TEST(LRU_BasicCache, OrderedIndexForHashableKey)
+{
+	cache::basic_cache<std::string, int, cache::lru_policy, cache::ordered_index> cache(10);
+	cache.insert("post:1", 1);
+	cache.insert("user:1", 2);
+	cache.insert("user:2", 3);
+
+	EXPECT_EQ(cache.erase_range("user:", "user;"), 2);
+	EXPECT_TRUE(cache.contains("post:1"));
+	EXPECT_EQ(cache.size(), 1);
+}
+
+TEST(LRU_BasicCache, CustomPolicy)
+{
+	cache::basic_cache<int, int, fifo_policy> fifo(2);
+	cache::LRU<int, int> lru(2);
+	for (int key = 1; key <= 2; ++key)
+	{
+		fifo.insert(key, key);
+		lru.insert(key, key);
+	}
+
+	EXPECT_EQ(fifo.get(1), 1);
+	EXPECT_EQ(lru.get(1), 1);
+	fifo.insert(3, 3);
+	lru.insert(3, 3);
+
+	EXPECT_FALSE(fifo.contains(1));
+	EXPECT_TRUE(fifo.contains(2));
+	EXPECT_TRUE(lru.contains(1));
+	EXPECT_FALSE(lru.contains(2));
+}
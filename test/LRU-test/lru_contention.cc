@@ -0,0 +1,45 @@
+#include <gtest/gtest.h>
+#include <caches/LRU/LRU.hpp>
+#include <caches/instrumented_lock.hpp>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+
+TEST(LRU_Contention, CountsEveryAcquisition)
+{
+	cache::LRU<int, int, cache::InstrumentedLock<std::mutex>> cache(10);
+	cache.insert(1, 1);
+	cache.get(1);
+	cache.contains(2);
+
+	cache::lock_stats stats = cache.contention();
+	EXPECT_EQ(stats.acquisitions, 3);
+	EXPECT_EQ(stats.contended, 0);
+	EXPECT_EQ(stats.wait.count(), 0);
+}
+
+TEST(LRU_Contention, MeasuresWaitAndHold)
+{
+	cache::InstrumentedLock<std::mutex> lock;
+	lock.lock();
+
+	std::atomic<bool> started{ false };
+	std::thread waiter([&]
+	{
+		started = true;
+		std::lock_guard<cache::InstrumentedLock<std::mutex>> g(lock);
+	});
+	while (!started)
+		std::this_thread::yield();
+	std::this_thread::sleep_for(std::chrono::milliseconds(20));
+	lock.unlock();
+	waiter.join();
+
+	cache::lock_stats stats = lock.stats();
+	EXPECT_EQ(stats.acquisitions, 2);
+	EXPECT_EQ(stats.contended, 1);
+	EXPECT_GE(stats.max_wait, std::chrono::milliseconds(10));
+	EXPECT_EQ(stats.wait, stats.max_wait);
+	EXPECT_GE(stats.hold, std::chrono::milliseconds(20));
+}
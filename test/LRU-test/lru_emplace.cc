@@ -0,0 +1,87 @@
+#include <gtest/gtest.h>
+#include <caches/LRU/LRU.hpp>
+#include <string>
+#include <utility>
+
+namespace
+{
+	struct CountedKey
+	{
+		static int copies;
+		int id;
+
+		explicit CountedKey(int id) : id(id) { }
+		CountedKey(const CountedKey& other) : id(other.id) { ++copies; }
+		CountedKey(CountedKey&& other) noexcept : id(other.id) { }
+		CountedKey& operator=(const CountedKey&) = default;
+
+		bool operator==(const CountedKey& other) const { return id == other.id; }
+	};
+	int CountedKey::copies = 0;
+
+	struct CountedKeyHash
+	{
+		std::size_t operator()(const CountedKey& key) const { return std::hash<int>()(key.id); }
+	};
+
+	struct Tracked
+	{
+		static int constructed;
+		int v;
+
+		Tracked(int v) : v(v) { ++constructed; }
+	};
+	int Tracked::constructed = 0;
+}
+
+TEST(LRU_Emplace, RvalueKeyIsMoved)
+{
+	cache::LRU<CountedKey, int, cache::NullLock, CountedKeyHash> cache(2);
+	CountedKey::copies = 0;
+
+	cache.insert(CountedKey(1), 10);
+	cache.emplace(CountedKey(2), 20);
+	EXPECT_TRUE(cache.insert_or_assign(CountedKey(3), 30));
+	EXPECT_TRUE(cache.try_emplace(CountedKey(4), 40));
+
+	EXPECT_EQ(CountedKey::copies, 0);
+	EXPECT_EQ(cache.size(), 2);
+	EXPECT_EQ(cache.get(CountedKey(4)), 40);
+}
+
+TEST(LRU_Emplace, TryEmplaceLeavesPresentEntry)
+{
+	cache::LRU<int, Tracked> cache(2);
+
+	EXPECT_TRUE(cache.try_emplace(1, 10));
+	Tracked::constructed = 0;
+
+	EXPECT_FALSE(cache.try_emplace(1, 99));
+	EXPECT_EQ(Tracked::constructed, 0);
+	EXPECT_EQ(cache.peek(1).v, 10);
+
+	// A rejected try_emplace is not an access: 1 stays the eviction victim
+	cache.insert(2, Tracked(20));
+	EXPECT_FALSE(cache.try_emplace(1, 11));
+	cache.insert(3, Tracked(30));
+	EXPECT_FALSE(cache.contains(1));
+}
+
+TEST(LRU_Emplace, InsertOrAssign)
+{
+	cache::LRU<int, std::string> cache(2);
+
+	EXPECT_TRUE(cache.insert_or_assign(1, "one"));
+	EXPECT_FALSE(cache.insert_or_assign(1, std::string("uno")));
+	EXPECT_EQ(cache.get(1), "uno");
+	EXPECT_EQ(cache.size(), 1);
+}
+
+TEST(LRU_Emplace, ZeroCapacity)
+{
+	cache::LRU<int, int> cache(0);
+
+	EXPECT_FALSE(cache.try_emplace(1, 1));
+	EXPECT_FALSE(cache.insert_or_assign(1, 1));
+	EXPECT_TRUE(cache.empty());
+}
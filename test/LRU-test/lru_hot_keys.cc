@@ -0,0 +1,88 @@
+#include <gtest/gtest.h>
+#include <caches/LRU/LRU.hpp>
+#include <caches/hot_keys.hpp>
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+TEST(LRU_HotKeys, FindsHeavyHitters)
+{
+	cache::LRU<int, int> cache(100);
+	cache::HotKeys<int> hot(5);
+
+	// Keys 0..4 are hammered, everything else shows up once
+	for (int i = 0; i < 20000; ++i)
+	{
+		int key = i % 4 == 0 ? (i / 4) % 5 : 1000 + i;
+		hot.record(key);
+		cache.insert(key, key);
+	}
+
+	std::vector<cache::hot_key<int>> top = hot.report();
+	ASSERT_EQ(top.size(), 5);
+	for (const cache::hot_key<int>& entry : top)
+	{
+		EXPECT_LT(entry.key, 5);
+		EXPECT_GE(entry.count, 1000);
+	}
+	for (std::size_t i = 1; i < top.size(); ++i)
+		EXPECT_GE(top[i - 1].count, top[i].count);
+}
+
+TEST(LRU_HotKeys, EstimateNeverUndercounts)
+{
+	cache::HotKeys<std::string> hot(4, 64);
+
+	for (int i = 0; i < 1000; ++i)
+		hot.record("key" + std::to_string(i % 100));
+
+	for (int i = 0; i < 100; ++i)
+		EXPECT_GE(hot.estimate("key" + std::to_string(i)), 10);
+}
+
+TEST(LRU_HotKeys, WeightsAndDecay)
+{
+	cache::HotKeys<int> hot(2);
+
+	hot.record(1, 100);
+	hot.record(2, 10);
+	hot.record(3);
+
+	std::vector<cache::hot_key<int>> top = hot.report();
+	ASSERT_EQ(top.size(), 2);
+	EXPECT_EQ(top[0].key, 1);
+	EXPECT_EQ(top[0].count, 100);
+	EXPECT_EQ(top[1].key, 2);
+
+	hot.decay();
+	EXPECT_EQ(hot.report()[0].count, 50);
+	EXPECT_EQ(hot.estimate(1), 50);
+
+	hot.clear();
+	EXPECT_TRUE(hot.report().empty());
+	EXPECT_EQ(hot.estimate(1), 0);
+}
+
+TEST(LRU_HotKeys, ReportWhileRecording)
+{
+	cache::HotKeys<int, std::mutex> hot(200);
+	std::atomic<bool> done(false);
+
+	std::thread writer([&]
+	{
+		for (int i = 0; i < 100000; ++i)
+			hot.record(i % 500);
+		done = true;
+	});
+
+	while (!done)
+	{
+		std::vector<cache::hot_key<int>> top = hot.report();
+		EXPECT_LE(top.size(), 200);
+	}
+	writer.join();
+
+	EXPECT_EQ(hot.report().size(), 200);
+}
@@ -0,0 +1,131 @@
+#include <gtest/gtest.h>
+#include <caches/LRU/LRU.hpp>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <string>
+
+namespace
+{
+	// Same keys through the chained HashIndex, as a reference
+	struct ChainedHash
+	{
+		std::size_t operator()(std::uint64_t key) const
+		{
+			return std::hash<std::uint64_t>()(key);
+		}
+	};
+
+	static_assert(cache::is_integer_key<std::uint64_t>::value, "uint64_t keys take the integer index");
+	static_assert(cache::is_integer_key<std::int32_t>::value, "int32_t keys take the integer index");
+	static_assert(!cache::is_integer_key<std::string>::value, "strings keep the chained index");
+	static_assert(!cache::is_integer_key<std::uint64_t, ChainedHash>::value, "a custom hash keeps the chained index");
+}
+
+TEST(LRU_Integer, MatchesChainedIndex)
+{
+	cache::LRU<std::uint64_t, int> fast(300);
+	cache::LRU<std::uint64_t, int, cache::NullLock, ChainedHash> chained(300);
+
+	std::mt19937_64 rng(7);
+	auto pick = [&rng]() -> std::uint64_t
+	{
+		std::uint64_t low = rng() % 512;
+		switch (rng() % 3)
+		{
+		case 0:  return low;
+		case 1:  return low << 40;          // differ only in the high bits
+		default: return ~std::uint64_t(0) - low;
+		}
+	};
+
+	for (int i = 0; i < 200000; ++i)
+	{
+		std::uint64_t key = pick();
+		switch (rng() % 4)
+		{
+		case 0:
+			ASSERT_EQ(fast.erase(key), chained.erase(key));
+			break;
+		case 1:
+		{
+			bool hit = chained.contains(key);
+			ASSERT_EQ(fast.contains(key), hit);
+			if (hit)
+			{
+				ASSERT_EQ(fast.get(key), chained.get(key));
+			}
+			break;
+		}
+		default:
+			fast.insert(key, i);
+			chained.insert(key, i);
+		}
+		ASSERT_EQ(fast.size(), chained.size());
+	}
+
+	for (std::uint64_t low = 0; low < 512; ++low)
+	{
+		EXPECT_EQ(fast.contains(low), chained.contains(low));
+		EXPECT_EQ(fast.contains(low << 40), chained.contains(low << 40));
+		EXPECT_EQ(fast.contains(~std::uint64_t(0) - low), chained.contains(~std::uint64_t(0) - low));
+	}
+}
+
+TEST(LRU_Integer, EveryKeyValueIsUsable)
+{
+	cache::LRU<std::int64_t, int> cache(8);
+	const std::int64_t keys[] = { 0, -1, 1, std::numeric_limits<std::int64_t>::min(), std::numeric_limits<std::int64_t>::max() };
+
+	for (std::int64_t key : keys)
+		cache.insert(key, static_cast<int>(key & 0xff));
+
+	for (std::int64_t key : keys)
+	{
+		ASSERT_TRUE(cache.contains(key));
+		EXPECT_EQ(cache.get(key), static_cast<int>(key & 0xff));
+	}
+
+	EXPECT_TRUE(cache.erase(0));
+	EXPECT_FALSE(cache.contains(0));
+	EXPECT_TRUE(cache.contains(-1));
+	EXPECT_EQ(cache.size(), 4);
+}
+
+TEST(LRU_Integer, PrecomputedHash)
+{
+	cache::LRU<std::uint32_t, int> cache(4);
+	std::uint32_t key = 0xdeadbeef;
+	std::size_t hash = cache.hash_function()(key);
+
+	cache.insert(key, hash, 7);
+	EXPECT_TRUE(cache.contains(key, hash));
+	EXPECT_EQ(cache.get(key, hash), 7);
+	EXPECT_EQ(cache.peek(key), 7);
+	EXPECT_TRUE(cache.erase(key, hash));
+	EXPECT_FALSE(cache.contains(key));
+}
+
+TEST(LRU_Integer, NodesCarryNoChainLink)
+{
+	cache::LRU<std::uint64_t, std::uint64_t> fast(1024);
+	cache::LRU<std::uint64_t, std::uint64_t, cache::NullLock, ChainedHash> chained(1024);
+
+	for (std::uint64_t i = 0; i < 1000; ++i)
+	{
+		fast.insert(i, i);
+		chained.insert(i, i);
+	}
+
+	cache::memory_stats full = fast.memory_usage();
+	EXPECT_EQ(full.node_bytes + 1000 * sizeof(void*), chained.memory_usage().node_bytes);
+
+	// Key and node pointer per slot, at most 3/4 full
+	std::size_t slot = sizeof(std::uint64_t) + sizeof(void*);
+	EXPECT_GE(full.index_bytes, 1000 * slot * 4 / 3);
+	EXPECT_LE(full.index_bytes, 1000 * slot * 8 / 3);
+
+	for (std::uint64_t i = 0; i < 1000; ++i)
+		fast.erase(i);
+	EXPECT_EQ(fast.memory_usage().node_bytes, 0);
+}
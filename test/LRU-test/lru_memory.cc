@@ -0,0 +1,79 @@
+#include <gtest/gtest.h>
+#include <caches/LRU/LRU.hpp>
+#include <string>
+#include <vector>
+
+TEST(LRU_Memory, Empty)
+{
+	cache::LRU<int, int> cache(16);
+
+	cache::memory_stats stats = cache.memory_usage();
+	EXPECT_EQ(stats.node_bytes, 0);
+	EXPECT_EQ(stats.value_heap_bytes, 0);
+}
+
+// A non-default hash keeps int keys on the chained HashIndex
+struct ChainedHash
+{
+	std::size_t operator()(int key) const
+	{
+		return std::hash<int>()(key);
+	}
+};
+
+TEST(LRU_Memory, GrowsAndShrinksWithEntries)
+{
+	cache::LRU<int, int, cache::NullLock, ChainedHash> cache(1024);
+
+	for (int i = 0; i < 1000; ++i)
+		cache.insert(i, i);
+
+	cache::memory_stats full = cache.memory_usage();
+	EXPECT_GT(full.node_bytes, 1000 * 2 * sizeof(int));
+	EXPECT_GE(full.index_bytes, 1000 * sizeof(void*));
+
+	// Two list links, one chain link and a bucket slot on top of key and value
+	std::size_t overhead = (full.node_bytes + full.index_bytes) / 1000 - 2 * sizeof(int);
+	EXPECT_LE(overhead, 4 * sizeof(void*) + 2 * sizeof(void*));
+
+	cache.set_capacity(10);
+	EXPECT_LT(cache.memory_usage().node_bytes, full.node_bytes);
+
+	cache.clear();
+	EXPECT_EQ(cache.memory_usage().node_bytes, 0);
+}
+
+TEST(LRU_Memory, ValueHeapCallback)
+{
+	cache::LRU<int, std::vector<int>> cache(4);
+
+	cache.insert(1, std::vector<int>(10));
+	cache.insert(2, std::vector<int>(20));
+
+	cache::memory_stats stats = cache.memory_usage([](const std::vector<int>& v)
+	{
+		return v.capacity() * sizeof(int);
+	});
+	EXPECT_EQ(stats.value_heap_bytes, 30 * sizeof(int));
+	EXPECT_EQ(stats.total(), stats.index_bytes + stats.node_bytes + stats.value_heap_bytes);
+}
+
+TEST(LRU_Memory, OrderedKeys)
+{
+	struct NoHash
+	{
+		int x;
+		bool operator<(const NoHash& other) const
+		{
+			return x < other.x;
+		}
+	};
+
+	cache::LRU<NoHash, std::string> cache(8);
+	cache.insert(NoHash{1}, "one");
+	cache.insert(NoHash{2}, "two");
+
+	cache::memory_stats stats = cache.memory_usage();
+	EXPECT_GT(stats.index_bytes, 0);
+	EXPECT_GT(stats.node_bytes, 2 * sizeof(std::string));
+}
@@ -0,0 +1,112 @@
+#include <gtest/gtest.h>
+#include <caches/LRU/LRU.hpp>
+#include <caches/miss_ratio_curve.hpp>
+#include <cmath>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+TEST(LRU_MissRatioCurve, CyclicLoopHasAKnee)
+{
+	// 1000 keys in a loop: LRU misses everything below 1000 entries and nothing above
+	cache::MissRatioCurve<int> mrc(2000, 20);
+	for (int round = 0; round < 20; ++round)
+	{
+		for (int key = 0; key < 1000; ++key)
+			mrc.record(key);
+	}
+
+	EXPECT_DOUBLE_EQ(mrc.sampling_rate(), 1.0);
+	EXPECT_DOUBLE_EQ(mrc.references(), 20000);
+	EXPECT_DOUBLE_EQ(mrc.miss_ratio(900), 1.0);
+	EXPECT_NEAR(mrc.miss_ratio(1000), 0.05, 1e-9);
+	EXPECT_NEAR(mrc.miss_ratio(5000), 0.05, 1e-9);
+
+	std::vector<cache::mrc_point> curve = mrc.curve();
+	ASSERT_EQ(curve.size(), 20);
+	EXPECT_EQ(curve.front().capacity, 100);
+	EXPECT_EQ(curve.back().capacity, 2000);
+	for (std::size_t i = 1; i < curve.size(); ++i)
+		EXPECT_LE(curve[i].miss_ratio, curve[i - 1].miss_ratio);
+}
+
+TEST(LRU_MissRatioCurve, TracksSimulatedLRU)
+{
+	const std::size_t capacities[] = { 500, 2000, 8000 };
+	cache::MissRatioCurve<int> mrc(10000, 100, 1024);
+
+	std::vector<cache::LRU<int, int>*> caches;
+	std::vector<std::size_t> misses(3, 0);
+	for (std::size_t capacity : capacities)
+		caches.push_back(new cache::LRU<int, int>(capacity));
+
+	// Skewed stream over 50k keys
+	std::mt19937 rng(11);
+	std::uniform_real_distribution<double> uniform(0, 1);
+	const int references = 400000;
+	for (int i = 0; i < references; ++i)
+	{
+		int key = static_cast<int>(50000 * std::pow(uniform(rng), 3));
+		mrc.record(key);
+		for (std::size_t c = 0; c < caches.size(); ++c)
+		{
+			if (!caches[c]->contains(key))
+			{
+				++misses[c];
+				caches[c]->insert(key, i);
+			}
+		}
+	}
+
+	EXPECT_LT(mrc.sampling_rate(), 0.1);
+	for (std::size_t c = 0; c < caches.size(); ++c)
+	{
+		double actual = static_cast<double>(misses[c]) / references;
+		EXPECT_NEAR(mrc.miss_ratio(capacities[c]), actual, 0.05) << "capacity " << capacities[c];
+		delete caches[c];
+	}
+}
+
+TEST(LRU_MissRatioCurve, MemoryStaysFixed)
+{
+	cache::MissRatioCurve<std::uint64_t> mrc(100000, 64, 512);
+	for (std::uint64_t key = 0; key < 20000; ++key)
+		mrc.record(key);
+	std::size_t early = mrc.memory_usage();
+
+	for (std::uint64_t key = 20000; key < 1000000; ++key)
+		mrc.record(key);
+
+	EXPECT_LE(mrc.memory_usage(), early + early / 4);
+	EXPECT_LT(mrc.sampling_rate(), 0.01);
+	EXPECT_NEAR(mrc.references(), 1000000, 250000);
+	EXPECT_DOUBLE_EQ(mrc.miss_ratio(100000), 1.0);
+
+	mrc.clear();
+	EXPECT_DOUBLE_EQ(mrc.references(), 0);
+	EXPECT_DOUBLE_EQ(mrc.sampling_rate(), 1.0);
+}
+
+TEST(LRU_MissRatioCurve, ConcurrentRecord)
+{
+	cache::MissRatioCurve<int, std::mutex> mrc(1000, 10);
+
+	std::vector<std::thread> threads;
+	for (int t = 0; t < 4; ++t)
+	{
+		threads.emplace_back([&mrc]
+		{
+			for (int i = 0; i < 50000; ++i)
+				mrc.record(i % 100);
+		});
+	}
+	for (std::thread& thread : threads)
+		thread.join();
+
+	EXPECT_DOUBLE_EQ(mrc.references(), 200000);
+	EXPECT_NEAR(mrc.miss_ratio(100), 100.0 / 200000, 1e-9);
+
+	mrc.decay();
+	EXPECT_DOUBLE_EQ(mrc.references(), 100000);
+}
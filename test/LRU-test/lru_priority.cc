@@ -0,0 +1,137 @@
+#include <gtest/gtest.h>
+#include <caches/LRU/LRU.hpp>
+#include <string>
+
+TEST(LRU_Priority, PinnedEntriesSurviveEviction)
+{
+	cache::LRU<int, std::string> cache(3);
+	cache.insert(1, std::string("config"));
+	cache.insert(2, std::string("b"));
+	cache.insert(3, std::string("c"));
+
+	EXPECT_TRUE(cache.pin(1));
+	EXPECT_FALSE(cache.pin(99));
+	EXPECT_EQ(cache.pinned_count(), 1);
+
+	for (int i = 4; i < 20; ++i)
+		cache.insert(i, std::to_string(i));
+
+	// Pinned entries come on top of the capacity
+	EXPECT_TRUE(cache.contains(1));
+	EXPECT_EQ(cache.size(), 4);
+	EXPECT_EQ(cache.peek(1), "config");
+
+	cache.insert(1, std::string("config v2"));
+	EXPECT_EQ(cache.pinned_count(), 1);
+	EXPECT_EQ(cache.peek(1), "config v2");
+
+	EXPECT_TRUE(cache.erase(1));
+	EXPECT_EQ(cache.pinned_count(), 0);
+}
+
+TEST(LRU_Priority, UnpinEvictsOverflow)
+{
+	cache::LRU<int, int> cache(2);
+	cache.insert(1, 1);
+	cache.insert(2, 2);
+	cache.pin(1);
+	cache.pin(2);
+	cache.insert(3, 3);
+	cache.insert(4, 4);
+	EXPECT_EQ(cache.size(), 4);
+	EXPECT_TRUE(cache.full());
+
+	EXPECT_TRUE(cache.unpin(1));
+	EXPECT_EQ(cache.pinned_count(), 1);
+	EXPECT_EQ(cache.size(), 3);
+	EXPECT_FALSE(cache.contains(3));
+	EXPECT_TRUE(cache.contains(1));
+	EXPECT_EQ(cache.stats().evictions, 1);
+
+	EXPECT_TRUE(cache.unpin(1));   // already unpinned
+	EXPECT_FALSE(cache.unpin(3));
+	EXPECT_EQ(cache.size(), 3);
+}
+
+TEST(LRU_Priority, LowClassIsEvictedFirst)
+{
+	cache::LRU<int, int> cache(3);
+	cache.insert(2, 2);
+	cache.insert(3, 3);
+	cache.insert(1, 1, cache::priority::low);
+
+	cache.insert(4, 4);
+	EXPECT_FALSE(cache.contains(1));
+	EXPECT_TRUE(cache.contains(2));
+
+	// A high entry outlives any amount of normal traffic
+	EXPECT_TRUE(cache.set_priority(2, cache::priority::high));
+	EXPECT_FALSE(cache.set_priority(1, cache::priority::high));
+	for (int i = 5; i < 50; ++i)
+		cache.insert(i, i);
+	EXPECT_TRUE(cache.contains(2));
+	EXPECT_EQ(cache.size(), 3);
+
+	// With no normal entries left, high ones go too
+	cache.insert(100, 100, cache::priority::high);
+	cache.insert(101, 101, cache::priority::high);
+	cache.insert(102, 102, cache::priority::high);
+	EXPECT_FALSE(cache.contains(2));
+	EXPECT_TRUE(cache.contains(100));
+}
+
+TEST(LRU_Priority, PinnedEntriesKeepTheirClass)
+{
+	cache::LRU<int, int> cache(2);
+	cache.insert(1, 1, cache::priority::low);
+	cache.pin(1);
+	cache.set_priority(1, cache::priority::high);
+	cache.insert(2, 2);
+	cache.insert(3, 3);
+	cache.unpin(1);
+
+	// Back among the high entries, so a normal one makes room
+	EXPECT_TRUE(cache.contains(1));
+	EXPECT_FALSE(cache.contains(2));
+	EXPECT_TRUE(cache.contains(3));
+}
+
+TEST(LRU_Priority, ShrinkingSparesPinned)
+{
+	cache::LRU<int, int> cache(4);
+	for (int i = 1; i <= 4; ++i)
+		cache.insert(i, i);
+	cache.pin(1);
+	cache.pin(2);
+
+	cache.set_capacity(1);
+	EXPECT_EQ(cache.size(), 3);
+	EXPECT_TRUE(cache.contains(1));
+	EXPECT_TRUE(cache.contains(2));
+	EXPECT_TRUE(cache.contains(4));
+
+	cache.clear();
+	EXPECT_EQ(cache.pinned_count(), 0);
+	cache.insert(5, 5);
+	cache.insert(6, 6);
+	EXPECT_EQ(cache.size(), 1);
+}
+
+TEST(LRU_Priority, PinnedBytesAreReported)
+{
+	cache::LRU<int, int> cache(8);
+	for (int i = 0; i < 4; ++i)
+		cache.insert(i, i);
+	EXPECT_EQ(cache.memory_usage().pinned_bytes, 0);
+
+	cache.pin(0);
+	std::size_t one = cache.memory_usage().pinned_bytes;
+	EXPECT_GT(one, 0);
+	cache.pin(1);
+	EXPECT_EQ(cache.memory_usage().pinned_bytes, 2 * one);
+
+	cache::memory_stats stats = cache.memory_usage([](int) { return std::size_t(100); });
+	EXPECT_EQ(stats.value_heap_bytes, 400);
+	EXPECT_EQ(stats.pinned_bytes, 2 * one + 200);
+	EXPECT_LE(stats.pinned_bytes, stats.node_bytes + stats.value_heap_bytes);
+}
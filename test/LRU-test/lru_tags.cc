@@ -0,0 +1,108 @@
+#include <gtest/gtest.h>
+#include <caches/LRU/LRU.hpp>
+#include <atomic>
+#include <string>
+
+namespace
+{
+	std::atomic<int> alive(0);
+
+	struct Counted
+	{
+		int v;
+
+		Counted(int v) : v(v) { ++alive; }
+		Counted(const Counted& other) : v(other.v) { ++alive; }
+		Counted& operator=(const Counted&) = default;
+		~Counted() { --alive; }
+	};
+}
+
+TEST(LRU_Tags, InvalidateRemovesOnlyTheGroup)
+{
+	cache::LRU<std::string, int> cache(10);
+
+	cache.insert("a", 1, cache::tag_list{ 1 });
+	cache.insert("b", 2, cache::tag_list{ 1, 2 });
+	cache.insert("c", 3, cache::tag_list{ 2 });
+	cache.insert("d", 4);
+
+	EXPECT_EQ(cache.tag_size(1), 2);
+	EXPECT_EQ(cache.tag_size(2), 2);
+
+	EXPECT_EQ(cache.invalidate_tag(1), 2);
+	EXPECT_FALSE(cache.contains("a"));
+	EXPECT_FALSE(cache.contains("b"));
+	EXPECT_TRUE(cache.contains("c"));
+	EXPECT_TRUE(cache.contains("d"));
+
+	// "b" left group 2 as well
+	EXPECT_EQ(cache.tag_size(1), 0);
+	EXPECT_EQ(cache.tag_size(2), 1);
+	EXPECT_EQ(cache.invalidate_tag(1), 0);
+	EXPECT_EQ(cache.invalidate_tag(2), 1);
+	EXPECT_EQ(cache.size(), 1);
+}
+
+TEST(LRU_Tags, ReinsertAddsTags)
+{
+	cache::LRU<int, int> cache(10);
+
+	cache.insert(1, 1, cache::tag_list{ 7 });
+	cache.insert(1, 2, cache::tag_list{ 7, 8 });
+	cache.insert(1, 3);
+
+	EXPECT_EQ(cache.tag_size(7), 1);
+	EXPECT_EQ(cache.tag_size(8), 1);
+	EXPECT_EQ(cache.get(1), 3);
+
+	EXPECT_EQ(cache.invalidate_tag(8), 1);
+	EXPECT_EQ(cache.tag_size(7), 0);
+	EXPECT_TRUE(cache.empty());
+}
+
+TEST(LRU_Tags, EvictionAndEraseLeaveTheGroup)
+{
+	cache::LRU<int, int> cache(2);
+
+	cache.emplace(cache::tag_list{ 5 }, 1, 1);
+	cache.emplace(cache::tag_list{ 5 }, 2, 2);
+	cache.insert(3, 3);
+	EXPECT_EQ(cache.tag_size(5), 1);
+
+	cache.erase(2);
+	EXPECT_EQ(cache.tag_size(5), 0);
+	EXPECT_EQ(cache.invalidate_tag(5), 0);
+	EXPECT_TRUE(cache.contains(3));
+}
+
+TEST(LRU_Tags, ClearAndDestroyFreeTaggedEntries)
+{
+	{
+		cache::LRU<int, Counted> cache(100);
+		for (int i = 0; i < 50; ++i)
+			cache.emplace(cache::tag_list{ static_cast<cache::tag_type>(i % 3), 100 }, i, i);
+
+		cache.clear();
+		EXPECT_EQ(alive, 0);
+		EXPECT_EQ(cache.tag_size(100), 0);
+
+		for (int i = 0; i < 10; ++i)
+			cache.emplace(cache::tag_list{ 1 }, i, i);
+		EXPECT_EQ(cache.tag_size(1), 10);
+	}
+	EXPECT_EQ(alive, 0);
+}
+
+TEST(LRU_Tags, UntaggedEntriesCostNoTagMemory)
+{
+	cache::LRU<int, int> plain(100), tagged(100);
+	for (int i = 0; i < 100; ++i)
+	{
+		plain.insert(i, i);
+		tagged.insert(i, i, cache::tag_list{ 1 });
+	}
+
+	EXPECT_EQ(plain.memory_usage().node_bytes, tagged.memory_usage().node_bytes);
+	EXPECT_GT(tagged.memory_usage().index_bytes, plain.memory_usage().index_bytes);
+}
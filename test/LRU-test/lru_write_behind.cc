@@ -0,0 +1,193 @@
+#include <gtest/gtest.h>
+#include <caches/LRU/LRU.hpp>
+#include <caches/flusher.hpp>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace
+{
+	// Slow-store stand-in: remembers every write and every batch size
+	struct MemoryStore
+	{
+		cache::write_sink<int, std::string> sink()
+		{
+			return [this](const cache::write_batch<int, std::string>& batch)
+			{
+				std::lock_guard<std::mutex> g(mutex);
+				if (failures > 0)
+				{
+					--failures;
+					throw std::runtime_error("store unavailable");
+				}
+
+				batches.push_back(batch.size());
+				for (const auto& entry : batch)
+				{
+					writes.push_back(entry);
+					data[entry.first] = entry.second;
+				}
+			};
+		}
+
+		std::size_t size()
+		{
+			std::lock_guard<std::mutex> g(mutex);
+			return data.size();
+		}
+
+		std::mutex mutex;
+		std::map<int, std::string> data;
+		std::vector<std::pair<int, std::string>> writes;
+		std::vector<std::size_t> batches;
+		int failures = 0;
+	};
+}
+
+TEST(LRU_WriteBehind, CoalescesAndFlushesInBatches)
+{
+	MemoryStore store;
+	cache::LRU<int, std::string> cache(100);
+
+	cache::write_behind_options opts;
+	opts.batch = 4;
+	cache.enable_write_behind(store.sink(), opts);
+
+	for (int i = 0; i < 10; ++i)
+		cache.insert(i, "v" + std::to_string(i));
+	cache.insert(1, std::string("latest"));
+	cache.insert_or_assign(1, std::string("really latest"));
+
+	EXPECT_EQ(cache.dirty_count(), 10);
+	EXPECT_TRUE(store.data.empty());
+
+	EXPECT_EQ(cache.flush(), 10);
+	EXPECT_EQ(cache.dirty_count(), 0);
+	EXPECT_EQ(store.writes.size(), 10);
+	EXPECT_EQ(store.batches, (std::vector<std::size_t>{ 4, 4, 2 }));
+	EXPECT_EQ(store.data[1], "really latest");
+	EXPECT_EQ(store.data[9], "v9");
+
+	// Clean entries stay cached and are not written again
+	EXPECT_EQ(cache.flush(), 0);
+	EXPECT_EQ(cache.get(1), "really latest");
+}
+
+TEST(LRU_WriteBehind, RemovedDirtyEntriesAreStillWritten)
+{
+	MemoryStore store;
+	cache::LRU<int, std::string> cache(2);
+	cache.enable_write_behind(store.sink());
+
+	cache.insert(1, std::string("a"));
+	cache.insert(2, std::string("b"));
+	cache.insert(3, std::string("c"));   // evicts 1
+	cache.erase(2);
+	cache.insert(4, std::string("d"));
+	cache.insert(1, std::string("a2"));  // evicts 3, 1 is dirty again
+
+	EXPECT_FALSE(cache.contains(3));
+	EXPECT_EQ(cache.dirty_count(), 5);
+	EXPECT_EQ(cache.flush(), 5);
+
+	// The evicted write of key 1 goes out before the newer one
+	std::vector<std::pair<int, std::string>> expected = {
+		{ 1, "a" }, { 2, "b" }, { 3, "c" }, { 4, "d" }, { 1, "a2" }
+	};
+	EXPECT_EQ(store.writes, expected);
+	EXPECT_EQ(store.data[1], "a2");
+}
+
+TEST(LRU_WriteBehind, ClearAndDestructionFlush)
+{
+	MemoryStore store;
+	{
+		cache::LRU<int, std::string> cache(10);
+		cache.enable_write_behind(store.sink());
+
+		cache.insert(1, std::string("one"));
+		cache.insert(2, std::string("two"));
+		cache.clear();
+		EXPECT_EQ(store.size(), 2);
+		EXPECT_EQ(cache.dirty_count(), 0);
+
+		cache.insert(3, std::string("three"));
+	}
+	EXPECT_EQ(store.size(), 3);
+	EXPECT_EQ(store.data[3], "three");
+}
+
+TEST(LRU_WriteBehind, BackPressureBoundsDirtySet)
+{
+	MemoryStore store;
+	cache::LRU<int, std::string> cache(1000);
+
+	cache::write_behind_options opts;
+	opts.batch = 4;
+	opts.max_dirty = 8;
+	cache.enable_write_behind(store.sink(), opts);
+
+	for (int i = 0; i < 100; ++i)
+	{
+		cache.insert(i, std::to_string(i));
+		ASSERT_LE(cache.dirty_count(), opts.max_dirty + 1);
+	}
+	EXPECT_GE(store.size(), 90);
+	EXPECT_EQ(cache.size(), 100);
+}
+
+TEST(LRU_WriteBehind, FailedBatchIsRetried)
+{
+	MemoryStore store;
+	store.failures = 1;
+	cache::LRU<int, std::string> cache(10);
+	cache.enable_write_behind(store.sink());
+
+	cache.insert(1, std::string("one"));
+	cache.insert(2, std::string("two"));
+
+	EXPECT_THROW(cache.flush(), std::runtime_error);
+	EXPECT_EQ(cache.dirty_count(), 2);
+
+	EXPECT_EQ(cache.flush(), 2);
+	EXPECT_EQ(store.data[1], "one");
+	EXPECT_EQ(store.data[2], "two");
+}
+
+TEST(LRU_WriteBehind, FlusherBoundsStaleness)
+{
+	MemoryStore store;
+	cache::LRU<int, std::string, std::mutex> cache(100);
+
+	cache::write_behind_options opts;
+	opts.max_staleness = std::chrono::milliseconds(20);
+	cache.enable_write_behind(store.sink(), opts);
+
+	cache::Flusher flusher(std::chrono::milliseconds(5));
+	flusher.attach(cache);
+
+	cache.insert(1, std::string("one"));
+
+	auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+	while (store.size() == 0 && std::chrono::steady_clock::now() < deadline)
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+	EXPECT_EQ(store.size(), 1);
+	EXPECT_EQ(cache.dirty_count(), 0);
+	flusher.detach(cache);
+}
+
+TEST(LRU_WriteBehind, OffByDefault)
+{
+	cache::LRU<int, std::string> cache(4);
+	cache.insert(1, std::string("one"));
+
+	EXPECT_EQ(cache.dirty_count(), 0);
+	EXPECT_EQ(cache.flush(), 0);
+	EXPECT_EQ(cache.flush_expired(), 0);
+}
@@ -0,0 +1,118 @@
+#include <gtest/gtest.h>
+#include <caches/SLRU/SLRU.hpp>
+#include <string>
+
+TEST(SLRU_Capacity, BasicOperations)
+{
+	cache::SLRU<int, std::string> cache(3);
+	EXPECT_TRUE(cache.empty());
+
+	cache.insert(1, std::string("one"));
+	cache.insert(2, std::string("two"));
+	cache.emplace(3, 3, 'x');
+
+	EXPECT_TRUE(cache.full());
+	EXPECT_EQ(cache.size(), 3);
+	EXPECT_EQ(cache.get(3), "xxx");
+	EXPECT_EQ(cache.peek(1), "one");
+	EXPECT_THROW(cache.get(4), cache::KeyNotFound);
+
+	cache.insert(1, std::string("uno"));
+	EXPECT_EQ(cache[1], "uno");
+	EXPECT_EQ(cache.size(), 3);
+
+	EXPECT_TRUE(cache.erase(2));
+	EXPECT_FALSE(cache.erase(2));
+	EXPECT_FALSE(cache.contains(2));
+
+	cache.clear();
+	EXPECT_TRUE(cache.empty());
+	EXPECT_EQ(cache.protected_size(), 0);
+
+	cache::cache_stats stats = cache.stats();
+	EXPECT_EQ(stats.hits, 2);
+	EXPECT_EQ(stats.misses, 1);
+}
+
+TEST(SLRU_Capacity, SecondUseProtects)
+{
+	cache::SLRU<int, int> cache(4, 0.5);
+	for (int i = 1; i <= 4; ++i)
+		cache.insert(i, i);
+
+	// 1 is the oldest entry, but it was used twice
+	cache.get(1);
+	EXPECT_EQ(cache.protected_size(), 1);
+
+	cache.insert(5, 5);
+	EXPECT_TRUE(cache.contains(1));
+	EXPECT_FALSE(cache.contains(2));
+	EXPECT_EQ(cache.stats().evictions, 1);
+}
+
+TEST(SLRU_Capacity, ProtectedOverflowDemotes)
+{
+	cache::SLRU<int, int> cache(4, 0.5);
+	for (int i = 1; i <= 4; ++i)
+		cache.insert(i, i);
+
+	cache.get(1);
+	cache.get(2);
+	cache.get(3);
+	EXPECT_EQ(cache.protected_size(), 2);
+
+	// 1 fell back to the front of probation, ahead of 4
+	cache.insert(5, 5);
+	EXPECT_TRUE(cache.contains(1));
+	EXPECT_FALSE(cache.contains(4));
+
+	// Probation is drained before any protected entry goes
+	cache.insert(6, 6);
+	cache.insert(7, 7);
+	EXPECT_FALSE(cache.contains(1));
+	EXPECT_TRUE(cache.contains(2));
+	EXPECT_TRUE(cache.contains(3));
+}
+
+TEST(SLRU_Capacity, SetCapacityTrimsBothSegments)
+{
+	cache::SLRU<int, int> cache(10);
+	for (int i = 0; i < 10; ++i)
+		cache.insert(i, i);
+	for (int i = 0; i < 5; ++i)
+		cache.get(i);
+	EXPECT_EQ(cache.protected_size(), 5);
+
+	cache.set_capacity(4);
+	EXPECT_EQ(cache.size(), 4);
+	EXPECT_EQ(cache.protected_size(), 3);
+	for (int i = 1; i < 5; ++i)
+		EXPECT_TRUE(cache.contains(i));
+
+	cache.set_capacity(0);
+	EXPECT_TRUE(cache.empty());
+	cache.insert(1, 1);
+	EXPECT_TRUE(cache.empty());
+}
+
+TEST(SLRU_Capacity, OrderedKeys)
+{
+	struct Point
+	{
+		int x, y;
+		bool operator<(const Point& other) const
+		{
+			return x < other.x || (x == other.x && y < other.y);
+		}
+	};
+
+	cache::SLRU<Point, int> cache(2, 0.5);
+	cache.insert(Point{ 0, 0 }, 1);
+	cache.insert(Point{ 0, 1 }, 2);
+	cache.get(Point{ 0, 0 });
+	cache.insert(Point{ 1, 0 }, 3);
+
+	EXPECT_TRUE(cache.contains(Point{ 0, 0 }));
+	EXPECT_FALSE(cache.contains(Point{ 0, 1 }));
+	EXPECT_EQ(cache.peek(Point{ 1, 0 }), 3);
+}
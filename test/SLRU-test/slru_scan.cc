@@ -0,0 +1,85 @@
+#include <gtest/gtest.h>
+#include <caches/SLRU/SLRU.hpp>
+#include <caches/LRU/LRU.hpp>
+#include <cstdint>
+#include <vector>
+
+namespace
+{
+	// A skewed working set of 80 keys, broken up by short scans of keys seen once
+	std::vector<int> scannedTrace(int rounds)
+	{
+		std::vector<int> trace;
+		std::uint64_t state = 7;
+		int fresh = 1000;
+		for (int round = 0; round < rounds; ++round)
+		{
+			for (int i = 0; i < 300; ++i)
+			{
+				state = state * 6364136223846793005ull + 1442695040888963407ull;
+				double u = static_cast<double>(state >> 11) / static_cast<double>(1ull << 53);
+				trace.push_back(static_cast<int>(u * u * 80));
+			}
+			for (int i = 0; i < 50; ++i)
+				trace.push_back(fresh++);
+		}
+		return trace;
+	}
+
+	template<class Cache>
+	double hitRatio(Cache& cache, const std::vector<int>& trace)
+	{
+		for (int key : trace)
+		{
+			try
+			{
+				cache.get(key);
+			}
+			catch (const cache::KeyNotFound&)
+			{
+				cache.insert(key, key);
+			}
+		}
+
+		cache::cache_stats stats = cache.stats();
+		return static_cast<double>(stats.hits) / static_cast<double>(stats.hits + stats.misses);
+	}
+}
+
+TEST(SLRU_Scan, ScanLeavesProtectedKeys)
+{
+	cache::SLRU<int, int> slru(100);
+	cache::LRU<int, int> lru(100);
+	for (int key = 0; key < 50; ++key)
+	{
+		slru.insert(key, key);
+		slru.get(key);
+		lru.insert(key, key);
+		lru.get(key);
+	}
+
+	for (int key = 1000; key < 2000; ++key)
+	{
+		slru.insert(key, key);
+		lru.insert(key, key);
+	}
+
+	for (int key = 0; key < 50; ++key)
+	{
+		EXPECT_TRUE(slru.contains(key));
+		EXPECT_FALSE(lru.contains(key));
+	}
+}
+
+TEST(SLRU_Scan, BeatsLRUUnderScans)
+{
+	const std::vector<int> trace = scannedTrace(200);
+
+	cache::LRU<int, int> lru(100);
+	cache::SLRU<int, int> slru(100);
+
+	double lruRatio = hitRatio(lru, trace);
+	double slruRatio = hitRatio(slru, trace);
+
+	EXPECT_GT(slruRatio, lruRatio + 0.05);
+}
@@ -0,0 +1,157 @@
+#include <gtest/gtest.h>
+#include <caches/SampledLRU/SampledLRU.hpp>
+#include <caches/cache_manager.hpp>
+#include <memory>
+#include <string>
+
+TEST(SampledLRU_Capacity, InsertAndGet)
+{
+	cache::SampledLRU<int, std::string> cache(3);
+
+	cache.insert(1, "one");
+	cache.insert(2, "two");
+	cache.emplace(3, 5, 'x');
+
+	EXPECT_EQ(cache.size(), 3);
+	EXPECT_TRUE(cache.full());
+	EXPECT_EQ(cache.get(1), "one");
+	EXPECT_EQ(cache.peek(3), "xxxxx");
+	EXPECT_THROW(cache.get(4), cache::KeyNotFound);
+
+	cache.insert(2, "TWO");
+	EXPECT_EQ(cache[2], "TWO");
+	EXPECT_EQ(cache.size(), 3);
+}
+
+TEST(SampledLRU_Capacity, NeverExceedsCapacity)
+{
+	cache::SampledLRU<int, int> cache(100);
+
+	for (int i = 0; i < 10000; ++i)
+	{
+		cache.insert(i, i);
+		ASSERT_LE(cache.size(), 100);
+		ASSERT_TRUE(cache.contains(i));
+	}
+	EXPECT_EQ(cache.stats().evictions, 10000 - 100);
+
+	// Every surviving key still maps to its own value after all the slot moves
+	int found = 0;
+	for (int i = 0; i < 10000; ++i)
+	{
+		if (cache.contains(i))
+		{
+			EXPECT_EQ(cache.peek(i), i);
+			++found;
+		}
+	}
+	EXPECT_EQ(found, 100);
+}
+
+TEST(SampledLRU_Capacity, KeepsRecentlyUsed)
+{
+	// Enough samples to see every slot makes eviction exact
+	cache::SampledLRU<int, int> cache(8, 64);
+
+	for (int i = 0; i < 8; ++i)
+		cache.insert(i, i);
+	for (int i = 1; i < 8; ++i)
+		cache.get(i);
+
+	cache.insert(8, 8);
+	EXPECT_FALSE(cache.contains(0));
+	for (int i = 1; i <= 8; ++i)
+		EXPECT_TRUE(cache.contains(i));
+}
+
+TEST(SampledLRU_Capacity, EraseMovesLastSlot)
+{
+	cache::SampledLRU<int, std::unique_ptr<int>> cache(10);
+
+	for (int i = 0; i < 10; ++i)
+		cache.emplace(i, new int(i));
+
+	EXPECT_TRUE(cache.erase(0));
+	EXPECT_FALSE(cache.erase(0));
+	EXPECT_TRUE(cache.erase(5));
+
+	EXPECT_EQ(cache.size(), 8);
+	for (int i = 1; i < 10; ++i)
+	{
+		if (i == 5)
+			continue;
+		EXPECT_EQ(*cache.peek(i), i);
+	}
+}
+
+TEST(SampledLRU_Capacity, TryEmplaceAndInsertOrAssign)
+{
+	cache::SampledLRU<std::string, int> cache(4);
+
+	EXPECT_TRUE(cache.try_emplace("a", 1));
+	EXPECT_FALSE(cache.try_emplace("a", 2));
+	EXPECT_EQ(cache.get("a"), 1);
+
+	EXPECT_FALSE(cache.insert_or_assign("a", 3));
+	EXPECT_TRUE(cache.insert_or_assign(std::string("b"), 4));
+	EXPECT_EQ(cache.get("a"), 3);
+	EXPECT_EQ(cache.get("b"), 4);
+}
+
+TEST(SampledLRU_Capacity, PrecomputedHash)
+{
+	cache::SampledLRU<std::string, int> cache(4);
+	const std::string key = "key";
+	const std::size_t hash = cache.hash_function()(key);
+
+	cache.insert(key, hash, 7);
+	EXPECT_TRUE(cache.contains(key, hash));
+	EXPECT_EQ(cache.get(key, hash), 7);
+	EXPECT_TRUE(cache.erase(key, hash));
+	EXPECT_TRUE(cache.empty());
+}
+
+TEST(SampledLRU_Capacity, SetCapacityAndClear)
+{
+	cache::SampledLRU<int, int> cache(5000);
+	for (int i = 0; i < 5000; ++i)
+		cache.insert(i, i);
+
+	cache.set_capacity(10);
+	EXPECT_EQ(cache.size(), 10);
+	EXPECT_EQ(cache.capacity(), 10);
+
+	cache.clear();
+	EXPECT_TRUE(cache.empty());
+	EXPECT_FALSE(cache.contains(1));
+
+	cache.insert(1, 1);
+	EXPECT_EQ(cache.get(1), 1);
+
+	cache.set_capacity(0);
+	cache.insert(2, 2);
+	EXPECT_TRUE(cache.empty());
+}
+
+TEST(SampledLRU_Capacity, DeferredReclaim)
+{
+	cache::SampledLRU<int, std::string> cache(100);
+	cache.set_reclaim_mode(cache::reclaim_mode::deferred);
+
+	for (int i = 0; i < 100; ++i)
+		cache.insert(i, std::string(32, 'x'));
+
+	cache.clear();
+	EXPECT_EQ(cache.pending_reclaim(), 100 - cache::reclaim_chunk);
+	EXPECT_EQ(cache.reclaim(), 100 - cache::reclaim_chunk);
+	EXPECT_EQ(cache.pending_reclaim(), 0);
+}
+
+TEST(SampledLRU_Capacity, WorksWithCacheManager)
+{
+	cache::CacheManager manager(64);
+	cache::SampledLRU<int, int> cache(100);
+
+	manager.attach(cache);
+	EXPECT_EQ(cache.capacity(), 64);
+}
@@ -0,0 +1,70 @@
+#include <gtest/gtest.h>
+#include <caches/SampledLRU/SampledLRU.hpp>
+#include <caches/LRU/LRU.hpp>
+#include <cstdint>
+#include <vector>
+
+namespace
+{
+	// Skewed key stream: low keys are much hotter than high ones
+	std::vector<int> skewedTrace(std::size_t length, int keys)
+	{
+		std::vector<int> trace;
+		trace.reserve(length);
+
+		std::uint64_t state = 42;
+		for (std::size_t i = 0; i < length; ++i)
+		{
+			state = state * 6364136223846793005ull + 1442695040888963407ull;
+			double u = static_cast<double>(state >> 11) / static_cast<double>(1ull << 53);
+			trace.push_back(static_cast<int>(u * u * u * keys));
+		}
+		return trace;
+	}
+
+	template<class Cache>
+	double hitRatio(Cache& cache, const std::vector<int>& trace)
+	{
+		for (int key : trace)
+		{
+			try
+			{
+				cache.get(key);
+			}
+			catch (const cache::KeyNotFound&)
+			{
+				cache.insert(key, key);
+			}
+		}
+
+		cache::cache_stats stats = cache.stats();
+		return static_cast<double>(stats.hits) / static_cast<double>(stats.hits + stats.misses);
+	}
+}
+
+TEST(SampledLRU_HitRatio, CloseToExactLRU)
+{
+	const std::vector<int> trace = skewedTrace(200000, 20000);
+
+	cache::LRU<int, int> exact(1000);
+	cache::SampledLRU<int, int> sampled(1000);
+
+	double exactRatio = hitRatio(exact, trace);
+	double sampledRatio = hitRatio(sampled, trace);
+
+	EXPECT_GT(sampledRatio, exactRatio - 0.03);
+}
+
+TEST(SampledLRU_HitRatio, SmallerThanExactLRU)
+{
+	cache::LRU<int, int> exact(1000);
+	cache::SampledLRU<int, int> sampled(1000);
+
+	for (int i = 0; i < 1000; ++i)
+	{
+		exact.insert(i, i);
+		sampled.insert(i, i);
+	}
+
+	EXPECT_LT(sampled.memory_usage().total(), exact.memory_usage().total());
+}
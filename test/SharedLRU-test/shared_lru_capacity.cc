@@ -0,0 +1,108 @@
+#include <gtest/gtest.h>
+#include <caches/SharedLRU/SharedLRU.hpp>
+#include <string>
+#include <unistd.h>
+
+namespace
+{
+	std::string segmentName(const char* test)
+	{
+		return "/caches-" + std::string(test) + "-" + std::to_string(getpid());
+	}
+
+	struct Point
+	{
+		int x;
+		int y;
+	};
+}
+
+TEST(SharedLRU_Capacity, InsertGetErase)
+{
+	const std::string name = segmentName("basic");
+	cache::SharedLRU<int, Point> cache(name, 100, 4);
+	EXPECT_TRUE(cache.created());
+
+	cache.insert(1, Point{ 1, 2 });
+	cache.insert(2, Point{ 3, 4 });
+	EXPECT_EQ(cache.size(), 2);
+	EXPECT_EQ(cache.get(1).y, 2);
+	EXPECT_EQ(cache.peek(2).x, 3);
+	EXPECT_THROW(cache.get(3), cache::KeyNotFound);
+
+	cache.insert(1, Point{ 5, 6 });
+	EXPECT_EQ(cache.get(1).x, 5);
+	EXPECT_EQ(cache.size(), 2);
+
+	EXPECT_TRUE(cache.update(2, [](Point& p) { p.x += 10; }));
+	EXPECT_FALSE(cache.update(9, [](Point&) { }));
+	EXPECT_EQ(cache.peek(2).x, 13);
+
+	EXPECT_TRUE(cache.erase(1));
+	EXPECT_FALSE(cache.erase(1));
+	EXPECT_FALSE(cache.contains(1));
+
+	cache.clear();
+	EXPECT_TRUE(cache.empty());
+
+	cache::cache_stats stats = cache.stats();
+	EXPECT_EQ(stats.hits, 2);
+	EXPECT_EQ(stats.misses, 1);
+	EXPECT_TRUE((cache::SharedLRU<int, Point>::remove(name)));
+}
+
+TEST(SharedLRU_Capacity, EvictsLeastRecentlyUsedPerShard)
+{
+	const std::string name = segmentName("evict");
+	cache::SharedLRU<int, int> cache(name, 3, 1);
+
+	cache.insert(1, 1);
+	cache.insert(2, 2);
+	cache.insert(3, 3);
+	cache.get(1);
+	cache.insert(4, 4);
+
+	EXPECT_TRUE(cache.contains(1));
+	EXPECT_FALSE(cache.contains(2));
+	EXPECT_TRUE(cache.contains(3));
+	EXPECT_TRUE(cache.contains(4));
+	EXPECT_EQ(cache.stats().evictions, 1);
+
+	for (int i = 0; i < 1000; ++i)
+		cache.insert(i, i);
+	EXPECT_EQ(cache.size(), 3);
+	cache::SharedLRU<int, int>::remove(name);
+}
+
+TEST(SharedLRU_Capacity, CapacitySplitAcrossShards)
+{
+	const std::string name = segmentName("shards");
+	cache::SharedLRU<int, int> cache(name, 1000, 16);
+	EXPECT_EQ(cache.capacity(), 1000);
+
+	for (int i = 0; i < 5000; ++i)
+		cache.insert(i, i);
+	EXPECT_LE(cache.size(), 1000);
+	EXPECT_GT(cache.size(), 900);
+
+	for (int i = 4990; i < 5000; ++i)
+		EXPECT_EQ(cache.peek(i), i);
+	cache::SharedLRU<int, int>::remove(name);
+}
+
+TEST(SharedLRU_Capacity, SecondHandleSharesTheSegment)
+{
+	const std::string name = segmentName("attach");
+	cache::SharedLRU<int, int> first(name, 64, 2);
+	cache::SharedLRU<int, int> second(name, 1, 1);
+
+	EXPECT_FALSE(second.created());
+	EXPECT_EQ(second.capacity(), 64);
+
+	first.insert(7, 70);
+	EXPECT_EQ(second.get(7), 70);
+
+	// A different value layout must not attach
+	EXPECT_THROW((cache::SharedLRU<int, double>(name, 64)), std::runtime_error);
+	cache::SharedLRU<int, int>::remove(name);
+}
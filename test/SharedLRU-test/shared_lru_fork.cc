@@ -0,0 +1,97 @@
+#include <gtest/gtest.h>
+#include <caches/SharedLRU/SharedLRU.hpp>
+#include <string>
+#include <vector>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace
+{
+	std::string segmentName(const char* test)
+	{
+		return "/caches-fork-" + std::string(test) + "-" + std::to_string(getpid());
+	}
+
+	// Runs fn in a child process and returns its exit code
+	template<class Fn>
+	int inChild(Fn fn)
+	{
+		pid_t pid = fork();
+		if (pid == 0)
+			_exit(fn());
+
+		int status = 0;
+		waitpid(pid, &status, 0);
+		return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+	}
+}
+
+TEST(SharedLRU_Fork, WorkersShareOneCache)
+{
+	const std::string name = segmentName("share");
+	cache::SharedLRU<int, int> cache(name, 4096, 8);
+	for (int i = 0; i < 100; ++i)
+		cache.insert(-1 - i, 0);
+
+	std::vector<pid_t> workers;
+	for (int w = 0; w < 4; ++w)
+	{
+		pid_t pid = fork();
+		if (pid == 0)
+		{
+			// Each worker maps the segment on its own, as an unrelated process would
+			cache::SharedLRU<int, int> mine(name, 0);
+			for (int i = 0; i < 500; ++i)
+				mine.insert(w * 1000 + i, w);
+			for (int i = 0; i < 100; ++i)
+				mine.update(-1 - i, [](int& v) { ++v; });
+			_exit(0);
+		}
+		workers.push_back(pid);
+	}
+
+	for (pid_t pid : workers)
+	{
+		int status = 0;
+		waitpid(pid, &status, 0);
+		ASSERT_TRUE(WIFEXITED(status));
+		ASSERT_EQ(WEXITSTATUS(status), 0);
+	}
+
+	EXPECT_EQ(cache.size(), 2100);
+	for (int w = 0; w < 4; ++w)
+		EXPECT_EQ(cache.peek(w * 1000 + 499), w);
+
+	// Shared counters were bumped by every worker under the shard locks
+	for (int i = 0; i < 100; ++i)
+		ASSERT_EQ(cache.peek(-1 - i), 4);
+
+	cache::SharedLRU<int, int>::remove(name);
+}
+
+TEST(SharedLRU_Fork, RecoversFromWorkerDyingUnderLock)
+{
+	const std::string name = segmentName("crash");
+	cache::SharedLRU<int, int> cache(name, 64, 1);
+
+	cache.insert(1, 10);
+	cache.insert(2, 20);
+
+	int code = inChild([&cache]
+	{
+		cache.update(1, [](int&) { _exit(3); });
+		return 0;
+	});
+	ASSERT_EQ(code, 3);
+
+	// The next locker resets the dead worker's shard and carries on
+	EXPECT_FALSE(cache.contains(1));
+	EXPECT_EQ(cache.recoveries(), 1);
+	EXPECT_TRUE(cache.empty());
+
+	cache.insert(3, 30);
+	EXPECT_EQ(cache.get(3), 30);
+
+	EXPECT_EQ(inChild([&name] { return cache::SharedLRU<int, int>(name, 0).peek(3) == 30 ? 0 : 1; }), 0);
+	cache::SharedLRU<int, int>::remove(name);
+}
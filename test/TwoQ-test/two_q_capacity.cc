@@ -0,0 +1,109 @@
+#include <gtest/gtest.h>
+#include <caches/TwoQ/TwoQ.hpp>
+#include <string>
+
+TEST(TwoQ_Capacity, BasicOperations)
+{
+	cache::TwoQ<int, std::string> cache(3);
+	EXPECT_TRUE(cache.empty());
+
+	cache.insert(1, std::string("one"));
+	cache.insert(2, std::string("two"));
+	cache.emplace(3, 3, 'x');
+
+	EXPECT_TRUE(cache.full());
+	EXPECT_EQ(cache.size(), 3);
+	EXPECT_EQ(cache.get(3), "xxx");
+	EXPECT_EQ(cache.peek(1), "one");
+	EXPECT_THROW(cache.get(4), cache::KeyNotFound);
+
+	cache.insert(1, std::string("uno"));
+	EXPECT_EQ(cache[1], "uno");
+	EXPECT_EQ(cache.size(), 3);
+
+	EXPECT_TRUE(cache.erase(2));
+	EXPECT_FALSE(cache.erase(2));
+	EXPECT_FALSE(cache.contains(2));
+
+	cache.clear();
+	EXPECT_TRUE(cache.empty());
+
+	cache::cache_stats stats = cache.stats();
+	EXPECT_EQ(stats.hits, 2);
+	EXPECT_EQ(stats.misses, 1);
+}
+
+TEST(TwoQ_Capacity, HitsInFifoDoNotPromote)
+{
+	cache::TwoQ<int, int> cache(4, 0.25, 0.5);
+	for (int i = 1; i <= 4; ++i)
+		cache.insert(i, i);
+	for (int i = 0; i < 10; ++i)
+		cache.get(1);
+
+	// Still first in, first out
+	cache.insert(5, 5);
+	EXPECT_FALSE(cache.contains(1));
+	EXPECT_EQ(cache.main_size(), 0);
+	EXPECT_EQ(cache.ghost_size(), 1);
+	EXPECT_EQ(cache.stats().evictions, 1);
+}
+
+TEST(TwoQ_Capacity, GhostHitGoesToMain)
+{
+	cache::TwoQ<int, int> cache(4, 0.25, 0.5);
+	for (int i = 1; i <= 5; ++i)
+		cache.insert(i, i);
+
+	cache.insert(1, 1);
+	EXPECT_EQ(cache.main_size(), 1);
+	EXPECT_FALSE(cache.contains(2));
+
+	// A1in is over its share, so it keeps giving way while Am holds 1
+	cache.insert(6, 6);
+	cache.insert(7, 7);
+	cache.insert(8, 8);
+	EXPECT_TRUE(cache.contains(1));
+	EXPECT_EQ(cache.size(), 4);
+}
+
+TEST(TwoQ_Capacity, GhostsAreBounded)
+{
+	cache::TwoQ<int, int> cache(10, 0.25, 0.5);
+	for (int i = 0; i < 1000; ++i)
+		cache.insert(i, i);
+	EXPECT_EQ(cache.ghost_size(), 5);
+
+	cache.set_capacity(4);
+	EXPECT_EQ(cache.size(), 4);
+	EXPECT_EQ(cache.ghost_size(), 2);
+
+	cache.clear();
+	EXPECT_EQ(cache.ghost_size(), 0);
+
+	cache.set_capacity(0);
+	cache.insert(1, 1);
+	EXPECT_TRUE(cache.empty());
+}
+
+TEST(TwoQ_Capacity, OrderedKeys)
+{
+	struct Point
+	{
+		int x, y;
+		bool operator<(const Point& other) const
+		{
+			return x < other.x || (x == other.x && y < other.y);
+		}
+	};
+
+	cache::TwoQ<Point, int> cache(2, 0.5, 1.0);
+	cache.insert(Point{ 0, 0 }, 1);
+	cache.insert(Point{ 0, 1 }, 2);
+	cache.insert(Point{ 1, 0 }, 3);
+	EXPECT_FALSE(cache.contains(Point{ 0, 0 }));
+
+	cache.insert(Point{ 0, 0 }, 1);
+	EXPECT_EQ(cache.main_size(), 1);
+	EXPECT_EQ(cache.peek(Point{ 0, 0 }), 1);
+}
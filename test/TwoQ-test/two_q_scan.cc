@@ -0,0 +1,101 @@
+#include <gtest/gtest.h>
+#include <caches/TwoQ/TwoQ.hpp>
+#include <caches/LRU/LRU.hpp>
+#include <cstdint>
+#include <vector>
+
+namespace
+{
+	// A skewed working set of 80 keys, broken up by short scans of keys seen once
+	std::vector<int> scannedTrace(int rounds)
+	{
+		std::vector<int> trace;
+		std::uint64_t state = 7;
+		int fresh = 1000;
+		for (int round = 0; round < rounds; ++round)
+		{
+			for (int i = 0; i < 300; ++i)
+			{
+				state = state * 6364136223846793005ull + 1442695040888963407ull;
+				double u = static_cast<double>(state >> 11) / static_cast<double>(1ull << 53);
+				trace.push_back(static_cast<int>(u * u * 80));
+			}
+			for (int i = 0; i < 50; ++i)
+				trace.push_back(fresh++);
+		}
+		return trace;
+	}
+
+	template<class Cache>
+	double hitRatio(Cache& cache, const std::vector<int>& trace)
+	{
+		for (int key : trace)
+		{
+			try
+			{
+				cache.get(key);
+			}
+			catch (const cache::KeyNotFound&)
+			{
+				cache.insert(key, key);
+			}
+		}
+
+		cache::cache_stats stats = cache.stats();
+		return static_cast<double>(stats.hits) / static_cast<double>(stats.hits + stats.misses);
+	}
+}
+
+TEST(TwoQ_Scan, ScanLeavesMainKeys)
+{
+	cache::TwoQ<int, int> twoq(100);
+	cache::LRU<int, int> lru(100);
+
+	// Push 0..49 out of A1in so that only their keys are remembered...
+	for (int key = 0; key < 50; ++key)
+	{
+		twoq.insert(key, key);
+		lru.insert(key, key);
+	}
+	for (int key = 1000; key < 1100; ++key)
+	{
+		twoq.insert(key, key);
+		lru.insert(key, key);
+	}
+	EXPECT_EQ(twoq.ghost_size(), 50);
+
+	// ...so that they come back straight into Am
+	for (int key = 0; key < 50; ++key)
+	{
+		twoq.insert(key, key);
+		lru.insert(key, key);
+	}
+	EXPECT_EQ(twoq.main_size(), 50);
+
+	for (int key = 2000; key < 3000; ++key)
+	{
+		twoq.insert(key, key);
+		lru.insert(key, key);
+	}
+
+	for (int key = 0; key < 50; ++key)
+	{
+		EXPECT_TRUE(twoq.contains(key));
+		EXPECT_FALSE(lru.contains(key));
+	}
+	EXPECT_EQ(twoq.main_size(), 50);
+	EXPECT_EQ(twoq.ghost_size(), 50);
+}
+
+TEST(TwoQ_Scan, BeatsLRUUnderScans)
+{
+	const std::vector<int> trace = scannedTrace(200);
+
+	cache::LRU<int, int> lru(100);
+	cache::TwoQ<int, int> twoq(100);
+
+	double lruRatio = hitRatio(lru, trace);
+	double twoqRatio = hitRatio(twoq, trace);
+
+	EXPECT_GT(twoqRatio, lruRatio + 0.05);
+}
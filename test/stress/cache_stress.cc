@@ -0,0 +1,271 @@
+// Concurrency harness for LRU and LFU over an InstrumentedLock<std::mutex>.
+// Every thread runs a read/write/erase mix against one shared cache; a run
+// reports throughput, per-operation latency percentiles and the lock's wait
+// and hold times, then checks the cache against what the threads wrote.
+//
+//   caches_stress [--cache lru|lfu|all] [--threads 1,8,16,32,64] [--ops N]
+//                 [--keys N] [--capacity N] [--mix read:write:erase]
+//
+// Writes and erases of a key come from one owning thread only, so the final
+// state of every key is known: after each run the harness checks that
+// size() <= capacity(), that no erased key came back, that every present key
+// holds its owner's last write and, while the capacity covers every key (no
+// evictions), that no written key went missing. Exits with 1 if any check fails.
+#include <caches/LFU/LFU.hpp>
+#include <caches/LRU/LRU.hpp>
+#include <caches/instrumented_lock.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+	using clock_type = std::chrono::steady_clock;
+
+	struct Options
+	{
+		std::string cache = "all";
+		std::vector<std::size_t> threads{ 1, 8, 16, 32, 64 };
+		std::size_t ops = 200000;      // per thread
+		std::size_t keys = 65536;
+		std::size_t capacity = 65536;
+		unsigned read = 80, write = 15, erase = 5;
+	};
+
+	// What one thread did, and what it left in the cache
+	struct Worker
+	{
+		std::vector<std::uint32_t> latencyNs;
+		std::vector<std::uint64_t> last;   // last value written per owned key, 0 once erased
+		std::size_t reads = 0;
+	};
+
+	std::uint64_t nextRandom(std::uint64_t& state)
+	{
+		state ^= state >> 12;
+		state ^= state << 25;
+		state ^= state >> 27;
+		return state * 0x2545F4914F6CDD1Dull;
+	}
+
+	std::vector<std::size_t> parseList(const char* text)
+	{
+		std::vector<std::size_t> values;
+		for (const char* p = text; *p; )
+		{
+			char* end;
+			std::size_t value = std::strtoull(p, &end, 10);
+			if (end == p)
+				return std::vector<std::size_t>();
+
+			values.push_back(value);
+			p = *end == ',' ? end + 1 : end;
+		}
+		return values;
+	}
+
+	bool parse(int argc, char** argv, Options& opts)
+	{
+		for (int i = 1; i + 1 < argc; i += 2)
+		{
+			const char* flag = argv[i];
+			const char* value = argv[i + 1];
+			if (std::strcmp(flag, "--cache") == 0)
+				opts.cache = value;
+			else if (std::strcmp(flag, "--threads") == 0)
+				opts.threads = parseList(value);
+			else if (std::strcmp(flag, "--ops") == 0)
+				opts.ops = std::strtoull(value, nullptr, 10);
+			else if (std::strcmp(flag, "--keys") == 0)
+				opts.keys = std::strtoull(value, nullptr, 10);
+			else if (std::strcmp(flag, "--capacity") == 0)
+				opts.capacity = std::strtoull(value, nullptr, 10);
+			else if (std::strcmp(flag, "--mix") == 0)
+			{
+				if (std::sscanf(value, "%u:%u:%u", &opts.read, &opts.write, &opts.erase) != 3)
+					return false;
+			}
+			else
+				return false;
+		}
+		return argc % 2 == 1 && !opts.threads.empty() && opts.read + opts.write + opts.erase > 0;
+	}
+
+	double percentile(std::vector<std::uint32_t>& samples, double p)
+	{
+		if (samples.empty())
+			return 0;
+
+		std::size_t at = std::min(samples.size() - 1, static_cast<std::size_t>(p * samples.size()));
+		std::nth_element(samples.begin(), samples.begin() + at, samples.end());
+		return samples[at];
+	}
+
+	// Thread `t` of `threads` owns keys t, t + threads, t + 2 * threads, ...
+	template<class Cache>
+	void work(Cache& cache, const Options& opts, std::size_t t, std::size_t threads,
+		const std::atomic<bool>& go, Worker& worker)
+	{
+		std::size_t owned = opts.keys / threads;
+		unsigned mix = opts.read + opts.write + opts.erase;
+		std::uint64_t rng = 0x9E3779B97F4A7C15ull * (t + 1);
+		std::uint64_t seq = 0;
+		std::uint64_t out;
+
+		worker.latencyNs.reserve(opts.ops);
+		worker.last.assign(owned, 0);
+		while (!go.load(std::memory_order_acquire))
+			std::this_thread::yield();
+
+		for (std::size_t i = 0; i < opts.ops; ++i)
+		{
+			std::uint64_t r = nextRandom(rng);
+			unsigned op = static_cast<unsigned>(r % mix);
+			std::size_t slot = static_cast<std::size_t>((r >> 16) % owned);
+			std::uint64_t key = t + threads * slot;
+
+			clock_type::time_point start = clock_type::now();
+			if (op < opts.read)
+			{
+				cache.lookup((r >> 24) % (owned * threads), out);
+				++worker.reads;
+			}
+			else if (op < opts.read + opts.write)
+			{
+				worker.last[slot] = ++seq;
+				cache.insert(key, seq);
+			}
+			else
+			{
+				worker.last[slot] = 0;
+				cache.erase(key);
+			}
+			std::chrono::nanoseconds took = clock_type::now() - start;
+			worker.latencyNs.push_back(static_cast<std::uint32_t>(std::min<std::int64_t>(took.count(), UINT32_MAX)));
+		}
+	}
+
+	// Returns how many checks failed
+	template<class Cache>
+	std::size_t verify(Cache& cache, const Options& opts, std::size_t threads,
+		const std::vector<Worker>& workers, std::size_t reads)
+	{
+		std::size_t failures = 0;
+		auto fail = [&failures](const char* what, std::uint64_t key)
+		{
+			if (++failures <= 5)
+				std::fprintf(stderr, "  FAILED: %s (key %llu)\n", what, static_cast<unsigned long long>(key));
+		};
+
+		if (cache.size() > cache.capacity())
+			fail("size() exceeds capacity()", 0);
+
+		cache::cache_stats stats = cache.stats();
+		if (stats.hits + stats.misses != reads)
+			fail("hits + misses differ from the reads made", 0);
+		if (cache.contention().acquisitions < opts.ops * threads)
+			fail("fewer lock acquisitions than operations", 0);
+
+		bool evicting = opts.capacity < (opts.keys / threads) * threads;
+		for (std::size_t t = 0; t < threads; ++t)
+		{
+			for (std::size_t slot = 0; slot < workers[t].last.size(); ++slot)
+			{
+				std::uint64_t key = t + threads * slot;
+				std::uint64_t expected = workers[t].last[slot];
+				if (!cache.contains(key))
+				{
+					if (expected != 0 && !evicting)
+						fail("written entry lost", key);
+				}
+				else if (expected == 0)
+					fail("erased entry came back", key);
+				else if (cache.peek(key) != expected)
+					fail("entry holds a stale value", key);
+			}
+		}
+		return failures;
+	}
+
+	template<class Cache>
+	std::size_t run(const char* name, const Options& opts, std::size_t threads)
+	{
+		threads = std::max<std::size_t>(1, std::min(threads, opts.keys));
+		std::unique_ptr<Cache> cache(new Cache(opts.capacity));
+		std::vector<Worker> workers(threads);
+		std::vector<std::thread> pool;
+		std::atomic<bool> go{ false };
+
+		for (std::size_t t = 0; t < threads; ++t)
+			pool.emplace_back([&, t] { work(*cache, opts, t, threads, go, workers[t]); });
+
+		clock_type::time_point start = clock_type::now();
+		go.store(true, std::memory_order_release);
+		for (std::thread& thread : pool)
+			thread.join();
+		double seconds = std::chrono::duration<double>(clock_type::now() - start).count();
+
+		std::vector<std::uint32_t> latency;
+		std::size_t reads = 0;
+		for (Worker& worker : workers)
+		{
+			latency.insert(latency.end(), worker.latencyNs.begin(), worker.latencyNs.end());
+			reads += worker.reads;
+		}
+
+		cache::lock_stats lock = cache->contention();
+		double acquisitions = static_cast<double>(std::max<std::size_t>(1, lock.acquisitions));
+		std::printf("%-5s %7zu %9.2f %8.0f %8.0f %8.0f %9.2f%% %10.0f %10.0f %11.1f\n",
+			name, threads,
+			latency.size() / seconds / 1e6,
+			percentile(latency, 0.50), percentile(latency, 0.99), percentile(latency, 0.999),
+			100.0 * lock.contended / acquisitions,
+			lock.wait.count() / acquisitions,
+			lock.hold.count() / acquisitions,
+			lock.max_wait.count() / 1e3);
+		std::fflush(stdout);
+
+		return verify(*cache, opts, threads, workers, reads);
+	}
+}
+
+int main(int argc, char** argv)
+{
+	Options opts;
+	if (!parse(argc, argv, opts))
+	{
+		std::fprintf(stderr, "usage: %s [--cache lru|lfu|all] [--threads 1,8,...] [--ops N] "
+			"[--keys N] [--capacity N] [--mix read:write:erase]\n", argv[0]);
+		return 2;
+	}
+
+	using Lock = cache::InstrumentedLock<std::mutex>;
+	using LRU = cache::LRU<std::uint64_t, std::uint64_t, Lock>;
+	using LFU = cache::LFU<std::uint64_t, std::uint64_t, Lock>;
+
+	std::printf("%zu ops per thread, %zu keys, capacity %zu, mix %u:%u:%u (read:write:erase)\n",
+		opts.ops, opts.keys, opts.capacity, opts.read, opts.write, opts.erase);
+	std::printf("%-5s %7s %9s %8s %8s %8s %10s %10s %10s %11s\n", "cache", "threads", "Mops/s",
+		"p50 ns", "p99 ns", "p999 ns", "contended", "wait/acq", "hold/acq", "max wait us");
+
+	std::size_t failures = 0;
+	for (std::size_t threads : opts.threads)
+	{
+		if (opts.cache == "lru" || opts.cache == "all")
+			failures += run<LRU>("LRU", opts, threads);
+		if (opts.cache == "lfu" || opts.cache == "all")
+			failures += run<LFU>("LFU", opts, threads);
+	}
+
+	if (failures != 0)
+		std::fprintf(stderr, "%zu invariant checks failed\n", failures);
+	return failures == 0 ? 0 : 1;
+}